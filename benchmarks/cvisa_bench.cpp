@@ -0,0 +1,252 @@
+// Micro-benchmarks for the command hot path.
+//
+// Every round trip runs against a SimulatedTransport with zero latency, so the
+// results measure the library's own formatting, parsing, locking and logging
+// overhead rather than the instrument or the bus.
+
+#include "core/CommandFormatter.hpp"
+#include "core/Exceptions.hpp"
+#include "core/Logger.hpp"
+#include "core/ResponseParser.hpp"
+#include "core/SCPIBase.hpp"
+#include "core/SimulatedTransport.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <future>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using cvisa::CommandType;
+    using cvisa::LogLevel;
+    using cvisa::ResponseType;
+    using cvisa::SCPICommand;
+
+    // Commands without a post-write delay, so round trips are not dominated by sleeps.
+    constexpr SCPICommand s_setVoltage() { return SCPICommand("SOUR:VOLT %f", CommandType::WRITE, ResponseType::NONE, 0, "Set voltage."); }
+    constexpr SCPICommand s_getVoltage() { return SCPICommand("SOUR:VOLT?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get voltage."); }
+    constexpr SCPICommand s_measVoltage() { return SCPICommand("MEAS:VOLT?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Measure voltage."); }
+
+    const char* const s_measurement = "+4.99870E+00\n";
+
+    // Exposes the protected command engine of SCPIBase.
+    class BenchInstrument : public cvisa::drivers::SCPIBase {
+      public:
+        using SCPIBase::executeCommand;
+        using SCPIBase::executeCommandAsync;
+        using SCPIBase::formatCommand;
+        using SCPIBase::queryAndParse;
+    };
+
+    // A connected instrument on a scripted simulator.
+    struct SimulatedSession {
+        BenchInstrument            instrument;
+        cvisa::SimulatedTransport* simulator;
+
+        SimulatedSession() {
+            std::unique_ptr<cvisa::SimulatedTransport> transport(new cvisa::SimulatedTransport());
+            transport->setResponse("MEAS:VOLT?", "+4.99870E+00");
+            simulator = transport.get();
+            instrument.setTransport(std::move(transport));
+            instrument.connect("SIM::BENCH");
+        }
+    };
+
+    // A sink that discards everything, so logging benchmarks measure the logger.
+    class NullBuffer : public std::streambuf {
+      protected:
+        int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+        std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+    };
+
+    NullBuffer   s_nullBuffer;
+    std::ostream s_nullStream(&s_nullBuffer);
+
+    // --- Formatting and Parsing ---
+
+    void BM_FormatCommand(benchmark::State& state) {
+        BenchInstrument instrument;
+        for (auto _ : state) {
+            std::string command = instrument.formatCommand(s_setVoltage().command, 5.125);
+            benchmark::DoNotOptimize(command);
+        }
+    }
+    BENCHMARK(BM_FormatCommand);
+
+    void BM_FormatCommandReused(benchmark::State& state) {
+        std::string command;
+        for (auto _ : state) {
+            cvisa::CommandFormatter::format(command, "APPL %f,%f;:OUTP %s", 6, 5.125, 0.25, "ON");
+            benchmark::DoNotOptimize(command.data());
+        }
+    }
+    BENCHMARK(BM_FormatCommandReused);
+
+    // SCPIBase::parseResponse<double>() delegates to ResponseParser::parseDouble().
+    void BM_ParseDouble(benchmark::State& state) {
+        std::string response(s_measurement);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(cvisa::ResponseParser::parseDouble(response));
+        }
+    }
+    BENCHMARK(BM_ParseDouble);
+
+    void BM_ParseDoubleArray(benchmark::State& state) {
+        std::string response;
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            response += (i == 0) ? "+1.23450E-03" : ",+1.23450E-03";
+        }
+        std::vector<double> values;
+        for (auto _ : state) {
+            cvisa::ResponseParser::parseDoubleArray(response.data(), response.data() + response.size(), values);
+            benchmark::DoNotOptimize(values.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(response.size()));
+    }
+    BENCHMARK(BM_ParseDoubleArray)->Arg(16)->Arg(1024);
+
+    // --- Round Trips ---
+
+    void BM_WriteCommand(benchmark::State& state) {
+        SimulatedSession session;
+        for (auto _ : state) {
+            session.instrument.executeCommand(s_setVoltage(), 5.125);
+        }
+    }
+    BENCHMARK(BM_WriteCommand);
+
+    // A repeated write suppressed by the setting cache.
+    void BM_WriteCommandCached(benchmark::State& state) {
+        SimulatedSession session;
+        session.instrument.enableSettingCache();
+        for (auto _ : state) {
+            session.instrument.executeCommand(s_setVoltage(), 5.125);
+        }
+    }
+    BENCHMARK(BM_WriteCommandCached);
+
+    // Range: 0 disables the automatic error check; 1, 2 and 3 enable it in the
+    // EVERY_COMMAND (a SYST:ERR? round trip), STATUS_BYTE and DEFERRED modes.
+    void BM_QueryAndParse(benchmark::State& state) {
+        SimulatedSession session;
+        if (state.range(0) != 0) {
+            session.instrument.enableAutoErrorCheck(true);
+            session.instrument.setErrorCheckMode(static_cast<cvisa::drivers::ErrorCheckMode>(state.range(0) - 1));
+        }
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(session.instrument.queryAndParse<double>(s_measVoltage()));
+        }
+    }
+    BENCHMARK(BM_QueryAndParse)->DenseRange(0, 3);
+
+    void BM_QueryAndParseWithMetrics(benchmark::State& state) {
+        SimulatedSession session;
+        session.instrument.enableMetrics();
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(session.instrument.queryAndParse<double>(s_measVoltage()));
+        }
+    }
+    BENCHMARK(BM_QueryAndParseWithMetrics);
+
+    // Range: the number of queries in the chain.
+    void BM_ExecuteCommandChain(benchmark::State& state) {
+        SimulatedSession         session;
+        std::vector<SCPICommand> commands(static_cast<size_t>(state.range(0)), s_getVoltage());
+        for (auto _ : state) {
+            std::vector<std::string> results = session.instrument.executeCommandChain(commands);
+            benchmark::DoNotOptimize(results.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_ExecuteCommandChain)->Arg(1)->Arg(4)->Arg(16);
+
+    // Range: the pipeline depth, for 32 queries with a 100 us round trip each.
+    // Depth 1 is the latency-bound `query()` loop.
+    void BM_QueryPipeline(benchmark::State& state) {
+        SimulatedSession session;
+        session.simulator->setResponseLatency(100);
+        std::vector<std::string> commands(32, "MEAS:VOLT?");
+        size_t                   depth = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            std::vector<std::string> responses = session.instrument.queryPipeline(commands, depth);
+            benchmark::DoNotOptimize(responses.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(commands.size()));
+    }
+    BENCHMARK(BM_QueryPipeline)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+
+    // Range: 0 for a read that throws a TimeoutException, 1 for `tryRead()`.
+    // Timeouts are the routine failure of optional instruments in a polling loop.
+    void BM_ReadTimeout(benchmark::State& state) {
+        SimulatedSession session;
+        session.instrument.setTimeout(0);
+        std::string response;
+        for (auto _ : state) {
+            if (state.range(0) == 0) {
+                try {
+                    session.instrument.read(response);
+                } catch (const cvisa::TimeoutException&) {
+                }
+            } else {
+                benchmark::DoNotOptimize(session.instrument.tryRead(response).code());
+            }
+        }
+    }
+    BENCHMARK(BM_ReadTimeout)->Arg(0)->Arg(1);
+
+    // --- Logging ---
+
+    // Range: the message level, logged by a session at INFO verbosity. DEBUG
+    // shows the cost of a filtered message; in Release builds INFO is compiled
+    // out as well (see CVISA_LOG_COMPILE_LEVEL).
+    void BM_Log(benchmark::State& state) {
+        LogLevel          level = static_cast<LogLevel>(state.range(0));
+        const std::string resource("SIM::BENCH");
+        cvisa::Logger::addSink(s_nullStream);
+        for (auto _ : state) {
+            CVISA_LOG(LogLevel::INFO, level, resource, "Executing command: " + resource);
+        }
+        cvisa::Logger::clearSinks();
+    }
+    BENCHMARK(BM_Log)->DenseRange(static_cast<int>(LogLevel::ERROR), static_cast<int>(LogLevel::DEBUG));
+
+    void BM_LogAsync(benchmark::State& state) {
+        LogLevel          level = static_cast<LogLevel>(state.range(0));
+        const std::string resource("SIM::BENCH");
+        cvisa::Logger::addSink(s_nullStream);
+        cvisa::Logger::enableAsync(1 << 16);
+        for (auto _ : state) {
+            CVISA_LOG(LogLevel::INFO, level, resource, "Executing command: " + resource);
+        }
+        cvisa::Logger::disableAsync();
+        cvisa::Logger::clearSinks();
+    }
+    BENCHMARK(BM_LogAsync)->DenseRange(static_cast<int>(LogLevel::ERROR), static_cast<int>(LogLevel::DEBUG));
+
+    // --- Asynchronous Submission ---
+
+    // Range: the number of queries in flight before waiting for their results.
+    void BM_SubmitThroughput(benchmark::State& state) {
+        SimulatedSession                      session;
+        std::vector<std::future<std::string>> futures(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            for (auto& future : futures) {
+                future = session.instrument.executeCommandAsync(s_measVoltage());
+            }
+            for (auto& future : futures) {
+                benchmark::DoNotOptimize(future.get());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_SubmitThroughput)->Arg(1)->Arg(64);
+
+}    // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,83 @@
+#include "core/SimulatedTransport.hpp"
+#include "drivers/Agilent66xxA.hpp"
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+int main() {
+    // This example runs the Agilent 66xxA driver against an in-process
+    // simulated instrument, so it needs neither hardware nor a VISA installation.
+    cvisa::drivers::Agilent66xxA psu;
+
+    std::cout << "--- cvisa Simulated Instrument Example ---" << std::endl;
+
+    try {
+        // --- Script the Instrument ---
+        std::unique_ptr<cvisa::SimulatedTransport> sim(new cvisa::SimulatedTransport());
+        sim->setResponse("*IDN?", "HEWLETT-PACKARD,6632A,0,A.00.01");
+        sim->setResponse("MEASURE:VOLTAGE:DC?", "+4.99870E+00", 20000);    // Measurements take 20 ms.
+        sim->setResponse("MEASURE:CURRENT:DC?", "+1.02300E-01", 20000);
+        sim->setWriteLatency(200);    // Every transfer takes 200 us.
+
+        cvisa::SimulatedTransport* instrument = sim.get();
+        psu.setTransport(std::move(sim));
+        psu.connect("SIM::PSU");
+
+        // --- Basic Operations ---
+        std::cout << "Instrument ID: " << psu.IDN_Query() << std::endl;
+        psu.RST();
+
+        // --- Output Control ---
+        // Settings are echoed back by the simulator.
+        psu.setVoltage(5.0);
+        psu.setCurrent(0.5);
+        psu.setOutput(true);
+        std::cout << "Voltage set to: " << psu.getVoltageSetting() << " V" << std::endl;
+        std::cout << "Current set to: " << psu.getCurrentSetting() << " A" << std::endl;
+        std::cout << "Output is " << (psu.isOutputEnabled() ? "ON" : "OFF") << std::endl;
+
+        std::cout << "\nMeasuring output..." << std::endl;
+        std::cout << "Measured voltage: " << psu.measureVoltage() << " V" << std::endl;
+        std::cout << "Measured current: " << psu.measureCurrent() << " A" << std::endl;
+
+        // --- Error Handling ---
+        // A scripted instrument error is reported by the automatic error check.
+        psu.enableAutoErrorCheck(true);
+        instrument->queueError(-222, "Data out of range");
+        try {
+            psu.setVoltage(100.0);
+        } catch (const cvisa::InstrumentException& e) {
+            std::cout << "\nExpected error: " << e.what() << std::endl;
+        }
+
+        // --- Status Byte Error Checking ---
+        // A pending event (here OPC) makes the check read ESR; the query keeps its own response.
+        psu.CLS();    // Clear the execution error left in ESR by the error above.
+        psu.setErrorCheckMode(cvisa::drivers::ErrorCheckMode::STATUS_BYTE);
+        psu.ESE_Set(cvisa::EventStatus::OPC);
+        psu.write("*OPC");
+        double voltage = psu.measureVoltage();
+        if (voltage != 4.9987) {
+            std::cerr << "Status byte check replaced the measurement: " << voltage << std::endl;
+            return 1;
+        }
+        std::cout << "\nMeasured voltage after an event: " << voltage << " V" << std::endl;
+        psu.setErrorCheckMode(cvisa::drivers::ErrorCheckMode::EVERY_COMMAND);
+
+        std::cout << "\nMessages written: " << instrument->messageCount() << std::endl;
+        std::cout << "Last message: " << instrument->lastMessage() << std::endl;
+
+        psu.setOutput(false);
+
+    } catch (const cvisa::VisaException& e) {
+        std::cerr << "A VISA error occurred: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "An unexpected error occurred: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "\nExample finished successfully." << std::endl;
+    return 0;
+}
@@ -51,29 +51,29 @@ int main() {
 
         // --- Soak and Window ---
         std::cout << "\nConfiguring soak time and temperature window..." << std::endl;
-        ta5000.setSoakTime(30);    // 30 seconds
-        ta5000.setWindow(2.5);     // 2.5 C
+        ta5000.setSoakTime(30);              // 30 seconds
+        ta5000.setTemperatureWindow(2.5);    // 2.5 C
         std::cout << "Soak time set to: " << ta5000.getSoakTime() << " s" << std::endl;
-        std::cout << "Window set to: " << ta5000.getWindow() << " C" << std::endl;
+        std::cout << "Window set to: " << ta5000.getTemperatureWindow() << " C" << std::endl;
 
         // --- Control Mode ---
         std::cout << "\nSetting control mode..." << std::endl;
-        ta5000.setDutControlMode(true);
-        std::cout << "Control mode is now: " << (ta5000.isDutControlModeEnabled() ? "DUT" : "Air") << std::endl;
-        ta5000.setDutControlMode(false);
-        std::cout << "Control mode is now: " << (ta5000.isDutControlModeEnabled() ? "DUT" : "Air") << std::endl;
+        ta5000.setDutControlModeOn();
+        std::cout << "Control mode is now: " << (ta5000.getDutControlMode() ? "DUT" : "Air") << std::endl;
+        ta5000.setDutControlModeOff();
+        std::cout << "Control mode is now: " << (ta5000.getDutControlMode() ? "DUT" : "Air") << std::endl;
 
         // --- Airflow Control ---
         std::cout << "\nConfiguring airflow..." << std::endl;
         ta5000.setFlowRate(15);    // 15 scfm
         std::cout << "Flow rate setting: " << ta5000.getFlowRateSetting() << " scfm" << std::endl;
-        std::cout << "Measured flow rate: " << ta5000.measureFlowRate() << " scfm" << std::endl;
+        std::cout << "Measured flow rate: " << ta5000.getFlowRateMeasured() << " scfm" << std::endl;
 
         // --- System Limits ---
         std::cout << "\nSetting temperature limits..." << std::endl;
-        ta5000.setLowerTempLimit(-55.0);
-        ta5000.setUpperTempLimit(125.0);
-        std::cout << "Limits set. Note: Getter functions for limits are not available on TA-5000." << std::endl;
+        ta5000.setLowerTemperatureLimit(-55.0);
+        ta5000.setUpperTemperatureLimit(125);
+        std::cout << "Limits set to " << ta5000.getLowerTemperatureLimit() << " C .. " << ta5000.getUpperTemperatureLimit() << " C" << std::endl;
 
         // --- Error Checking ---
         std::cout << "\nChecking for errors..." << std::endl;
@@ -4,14 +4,19 @@
 // --- Basic VISA Data Types ---
 typedef long          ViStatus;
 typedef unsigned long ViSession;
-typedef unsigned int  ViUInt32;
-typedef unsigned char ViUInt8;
-typedef short         ViInt16;
-typedef char          ViInt8;
-typedef ViSession     ViFindList;    // ViFindList is a type of session handle
+typedef unsigned int   ViUInt32;
+typedef unsigned short ViUInt16;
+typedef unsigned char  ViUInt8;
+typedef short          ViInt16;
+typedef char           ViInt8;
+typedef ViSession      ViFindList;     // ViFindList is a type of session handle
+typedef ViUInt32       ViEventType;
+typedef ViSession      ViEvent;        // Events are closed with viClose like sessions
 
 // --- VISA Completion and Error Codes ---
 #define VI_SUCCESS (0L)
+#define VI_SUCCESS_TERM_CHAR (0x3FFF0005L)
+#define VI_SUCCESS_MAX_CNT (0x3FFF0006L)
 #define VI_ERROR_TMO (-1073807339L)
 #define VI_ERROR_RSRC_NFOUND (-1073807343L)
 #define VI_ERROR_RSRC_LOCKED (-1073807342L)
@@ -24,6 +29,12 @@ typedef ViSession     ViFindList;    // ViFindList is a type of session handle
 #define VI_TRUE (1)
 #define VI_FALSE (0)
 #define VI_FIND_BUFLEN (256)
+#define VI_TMO_INFINITE (0xFFFFFFFFUL)
+
+// --- VISA Events ---
+#define VI_EVENT_SERVICE_REQ (0x3FFF200BUL)
+#define VI_QUEUE (1)
+#define VI_TRIG_PROT_DEFAULT (0)
 
 // --- VISA Attributes ---
 #define VI_ATTR_TMO_VALUE (0x3FFF001A)
@@ -45,6 +56,13 @@ ViStatus viSetAttribute(ViSession vi, int attrName, int attrValue);
 ViStatus viFindRsrc(ViSession vi, char* expr, ViFindList* findList, ViUInt32* retCount, char* desc);
 ViStatus viFindNext(ViFindList findList, char* desc);
 ViStatus viStatusDesc(ViSession vi, ViStatus status, char* desc);
+ViStatus viClear(ViSession vi);
+ViStatus viReadSTB(ViSession vi, ViUInt16* status);
+ViStatus viAssertTrigger(ViSession vi, ViUInt16 protocol);
+ViStatus viEnableEvent(ViSession vi, ViEventType eventType, ViUInt16 mechanism, ViUInt32 context);
+ViStatus viDisableEvent(ViSession vi, ViEventType eventType, ViUInt16 mechanism);
+ViStatus viDiscardEvents(ViSession vi, ViEventType eventType, ViUInt16 mechanism);
+ViStatus viWaitOnEvent(ViSession vi, ViEventType inEventType, ViUInt32 timeout, ViEventType* outEventType, ViEvent* outContext);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,149 @@
+#include "AdaptivePolicy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace cvisa {
+
+    constexpr uint64_t AdaptivePolicy::WARMUP_SAMPLES;
+
+    namespace {
+        // Consecutive timeouts that still double the timeout; later ones keep the session timeout.
+        const unsigned int s_maxBackoff = 16;
+    }    // namespace
+
+    AdaptivePolicy::AdaptivePolicy() : m_enabled(false), m_adaptiveDelays(false), m_maxRetries(1), m_minTimeout_ms(20), m_margin(3.0) {}
+
+    AdaptivePolicy::AdaptivePolicy(AdaptivePolicy&& other) noexcept
+        : m_enabled(other.m_enabled),
+          m_adaptiveDelays(other.m_adaptiveDelays),
+          m_maxRetries(other.m_maxRetries),
+          m_minTimeout_ms(other.m_minTimeout_ms),
+          m_margin(other.m_margin) {
+        std::lock_guard<std::mutex> lock(other.m_mutex);
+        m_entries = std::move(other.m_entries);
+        other.m_entries.clear();
+    }
+
+    AdaptivePolicy& AdaptivePolicy::operator=(AdaptivePolicy&& other) noexcept {
+        if (this != &other) {
+            std::unordered_map<const char*, Entry> entries;
+            {
+                std::lock_guard<std::mutex> lock(other.m_mutex);
+                entries.swap(other.m_entries);
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries.swap(entries);
+            m_enabled        = other.m_enabled;
+            m_adaptiveDelays = other.m_adaptiveDelays;
+            m_maxRetries     = other.m_maxRetries;
+            m_minTimeout_ms  = other.m_minTimeout_ms;
+            m_margin         = other.m_margin;
+        }
+        return *this;
+    }
+
+    void AdaptivePolicy::configure(unsigned int maxRetries, unsigned int minTimeout_ms, double margin) {
+        m_maxRetries    = maxRetries;
+        m_minTimeout_ms = minTimeout_ms > 0 ? minTimeout_ms : 1;
+        m_margin        = margin > 1.0 ? margin : 1.0;
+    }
+
+    AdaptivePolicy::Plan AdaptivePolicy::plan(const char* command, unsigned int delay_ms, unsigned int ceiling_ms) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry&                      entry = m_entries[command];
+        if (!entry.delayKnown) {
+            entry.delay_ms   = delay_ms;
+            entry.delayKnown = true;
+        }
+        Plan plan;
+        plan.timeout_ms = timeoutOf(entry, ceiling_ms);
+        plan.delay_ms   = m_adaptiveDelays ? std::min(entry.delay_ms, delay_ms) : delay_ms;
+        return plan;
+    }
+
+    void AdaptivePolicy::recordSuccess(const char* command, const Plan& plan, uint64_t responseNs, uint64_t readNs) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry&                      entry  = m_entries[command];
+        double                      sample = static_cast<double>(responseNs);
+        entry.response.record(responseNs);
+        if (entry.samples == 0) {
+            entry.meanNs      = sample;
+            entry.deviationNs = sample / 2.0;
+        } else {
+            // The gains of TCP's round-trip time estimator (RFC 6298).
+            double error = sample - entry.meanNs;
+            entry.meanNs += error / 8.0;
+            entry.deviationNs += (std::fabs(error) - entry.deviationNs) / 4.0;
+        }
+        ++entry.samples;
+        entry.backoff = 0;
+
+        // A read that returns within a quarter of the delay found the response
+        // already waiting, so the delay was longer than the instrument needed.
+        if (m_adaptiveDelays && plan.delay_ms > 0 && readNs * 4 < static_cast<uint64_t>(plan.delay_ms) * 1000000) {
+            entry.delay_ms = plan.delay_ms - (plan.delay_ms + 3) / 4;
+        }
+    }
+
+    void AdaptivePolicy::recordFailure(const char* command, unsigned int delay_ms, bool timedOut) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry&                      entry = m_entries[command];
+        entry.delay_ms                    = delay_ms;
+        entry.delayKnown                  = true;
+        if (timedOut) {
+            ++entry.timeouts;
+            if (entry.backoff < s_maxBackoff) ++entry.backoff;
+        }
+    }
+
+    void AdaptivePolicy::recordRetry(const char* command) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_entries[command].retries;
+    }
+
+    void AdaptivePolicy::reset() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+    }
+
+    std::vector<LatencyEstimate> AdaptivePolicy::estimates(unsigned int ceiling_ms) const {
+        std::vector<LatencyEstimate> result;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            result.reserve(m_entries.size());
+            for (const auto& item : m_entries) {
+                const Entry&    entry = item.second;
+                LatencyEstimate estimate;
+                estimate.command     = item.first;
+                estimate.samples     = entry.samples;
+                estimate.meanUs      = entry.meanNs / 1000.0;
+                estimate.deviationUs = entry.deviationNs / 1000.0;
+                estimate.p99Us       = entry.response.percentileUs(0.99);
+                estimate.timeout_ms  = timeoutOf(entry, ceiling_ms);
+                estimate.delay_ms    = entry.delay_ms;
+                estimate.timeouts    = entry.timeouts;
+                estimate.retries     = entry.retries;
+                result.push_back(estimate);
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const LatencyEstimate& a, const LatencyEstimate& b) { return a.command < b.command; });
+        return result;
+    }
+
+    unsigned int AdaptivePolicy::timeoutOf(const Entry& entry, unsigned int ceiling_ms) const {
+        unsigned int timeout_ms = ceiling_ms;
+        if (entry.samples >= WARMUP_SAMPLES) {
+            double percentileNs     = entry.response.percentileUs(0.99) * 1000.0 * m_margin;
+            double deviationBoundNs = entry.meanNs + 4.0 * entry.deviationNs;
+            double learned_ms       = std::ceil(std::max(percentileNs, deviationBoundNs) / 1e6);
+            if (learned_ms < ceiling_ms) timeout_ms = std::max(static_cast<unsigned int>(learned_ms), m_minTimeout_ms);
+        }
+        for (unsigned int i = 0; i < entry.backoff && timeout_ms < ceiling_ms; ++i) {
+            timeout_ms *= 2;
+        }
+        return std::min(timeout_ms, ceiling_ms);
+    }
+
+}    // namespace cvisa
@@ -0,0 +1,176 @@
+#ifndef CVISA_ADAPTIVE_POLICY_HPP
+#define CVISA_ADAPTIVE_POLICY_HPP
+
+#include "Metrics.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cvisa {
+
+    /**
+     * @brief The learned latency of one command template and the limits derived from it.
+     */
+    struct LatencyEstimate {
+        std::string  command;              // The command template (e.g., "MEASURE:VOLTAGE:DC?").
+        uint64_t     samples     = 0;      // Successful calls observed.
+        double       meanUs      = 0.0;    // Moving average of the response latency.
+        double       deviationUs = 0.0;    // Moving average of its deviation from the mean.
+        double       p99Us       = 0.0;    // 99th percentile of the response latency.
+        unsigned int timeout_ms  = 0;      // Timeout of the next call.
+        unsigned int delay_ms    = 0;      // Pre-read delay of the next call.
+        uint64_t     timeouts    = 0;      // Calls that timed out.
+        uint64_t     retries     = 0;      // Calls sent again after a timeout.
+    };
+
+    /**
+     * @class AdaptivePolicy
+     * @brief Per-command timeouts and pre-read delays derived from observed latency.
+     *
+     * For every command template, the policy keeps an exponentially weighted
+     * moving average of the response latency (the time from the end of the
+     * write to the end of the read) and of its mean deviation, as TCP does for
+     * round-trip times, plus a `LatencyHistogram` for its 99th percentile. Once
+     * a command has been seen `WARMUP_SAMPLES` times, its timeout becomes
+     *
+     *     max(margin * p99, mean + 4 * deviation)
+     *
+     * bounded by the minimum timeout and the session timeout. Each timeout
+     * doubles the command's next timeout until a call succeeds, so an
+     * instrument that really became slower is given the time it needs, while a
+     * dead one is detected after a few milliseconds instead of the full
+     * session timeout. Because such short timeouts routinely expire before a
+     * slow response arrives, the session clears the instrument after every
+     * timed-out query, whether or not it is sent again; otherwise the late
+     * response would be read as the answer to the next query.
+     *
+     * With adaptive delays, a command's fixed `delay_ms` is shortened while the
+     * response is already waiting when the delay ends, and restored after any
+     * failure.
+     *
+     * `plan()` and the `record` functions must be called under the session's
+     * I/O lock; `estimates()` can be called from any thread.
+     */
+    class AdaptivePolicy {
+      public:
+        /// Successful calls of a command before its timeout is adapted.
+        static constexpr uint64_t WARMUP_SAMPLES = 8;
+
+        /**
+         * @brief The timeout and delay of one call.
+         */
+        struct Plan {
+            unsigned int timeout_ms;
+            unsigned int delay_ms;
+        };
+
+        AdaptivePolicy();
+
+        AdaptivePolicy(const AdaptivePolicy&)            = delete;
+        AdaptivePolicy& operator=(const AdaptivePolicy&) = delete;
+        AdaptivePolicy(AdaptivePolicy&& other) noexcept;
+        AdaptivePolicy& operator=(AdaptivePolicy&& other) noexcept;
+
+        /**
+         * @brief Starts or stops adapting timeouts. Learned latencies are kept.
+         */
+        void setEnabled(bool enable) { m_enabled = enable; }
+
+        /// @return True if timeouts are adapted.
+        bool isEnabled() const { return m_enabled; }
+
+        /**
+         * @brief Starts or stops shortening the commands' pre-read delays.
+         */
+        void setAdaptiveDelays(bool enable) { m_adaptiveDelays = enable; }
+
+        /// @return True if pre-read delays are adapted.
+        bool hasAdaptiveDelays() const { return m_adaptiveDelays; }
+
+        /**
+         * @brief Sets the limits of the policy.
+         *
+         * @param maxRetries Times an idempotent query is sent again after a timeout.
+         * @param minTimeout_ms The shortest timeout the policy uses.
+         * @param margin The factor between the 99th percentile and the timeout.
+         */
+        void configure(unsigned int maxRetries, unsigned int minTimeout_ms, double margin);
+
+        /// @return Times an idempotent query is sent again after a timeout.
+        unsigned int maxRetries() const { return m_maxRetries; }
+
+        /**
+         * @brief Returns the timeout and delay of the next call of a command.
+         *
+         * @param command The command template; entries are keyed by this pointer.
+         * @param delay_ms The command's declared pre-read delay.
+         * @param ceiling_ms The session timeout, which the plan never exceeds.
+         */
+        Plan plan(const char* command, unsigned int delay_ms, unsigned int ceiling_ms);
+
+        /**
+         * @brief Adds a successful call.
+         *
+         * @param command The command template.
+         * @param plan The plan the call was made with.
+         * @param responseNs The time from the end of the write to the end of the read.
+         * @param readNs The time spent in the read, after the delay.
+         */
+        void recordSuccess(const char* command, const Plan& plan, uint64_t responseNs, uint64_t readNs);
+
+        /**
+         * @brief Adds a failed call. Restores the command's declared delay.
+         *
+         * @param command The command template.
+         * @param delay_ms The command's declared pre-read delay.
+         * @param timedOut True if the call timed out, which doubles the next timeout.
+         */
+        void recordFailure(const char* command, unsigned int delay_ms, bool timedOut);
+
+        /**
+         * @brief Counts a query that is sent again after a timeout.
+         */
+        void recordRetry(const char* command);
+
+        /**
+         * @brief Discards all learned latencies.
+         */
+        void reset();
+
+        /**
+         * @brief Copies the learned latencies, sorted by command template.
+         * @param ceiling_ms The session timeout, used to report the next timeouts.
+         */
+        std::vector<LatencyEstimate> estimates(unsigned int ceiling_ms) const;
+
+      private:
+        struct Entry {
+            uint64_t         samples     = 0;
+            double           meanNs      = 0.0;
+            double           deviationNs = 0.0;
+            LatencyHistogram response;
+            bool             delayKnown  = false;    // `delay_ms` was initialized from the command.
+            unsigned int     delay_ms    = 0;
+            unsigned int     backoff     = 0;        // Consecutive timeouts; each doubles the timeout.
+            uint64_t         timeouts    = 0;
+            uint64_t         retries     = 0;
+        };
+
+        unsigned int timeoutOf(const Entry& entry, unsigned int ceiling_ms) const;
+
+        bool         m_enabled;
+        bool         m_adaptiveDelays;
+        unsigned int m_maxRetries;
+        unsigned int m_minTimeout_ms;
+        double       m_margin;
+
+        mutable std::mutex                     m_mutex;      // Guards m_entries.
+        std::unordered_map<const char*, Entry> m_entries;    // Keyed by template pointer.
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_ADAPTIVE_POLICY_HPP
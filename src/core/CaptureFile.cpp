@@ -0,0 +1,411 @@
+#include "CaptureFile.hpp"
+
+#include "../utils/utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cvisa {
+
+    namespace {
+        const char     s_magic[8]      = {'C', 'V', 'I', 'S', 'A', 'C', 'A', 'P'};
+        const uint32_t s_formatVersion = 1;
+
+        // Blocks start on a page boundary, so columns are aligned for any access pattern.
+        const size_t s_headerAlignment = 4096;
+
+        // The mapping grows by doubling, but by no more than this many bytes at a time;
+        // the disk space of each step is reserved (see `reserveFileRange()`).
+        const size_t s_initialBlocks  = 4;
+        const size_t s_maxGrowthBytes = 64 * 1024 * 1024;
+
+        // The fixed part of the header; the strings follow it.
+        struct FileHeader {
+            char     magic[8];
+            uint32_t version;
+            uint32_t headerBytes;     // Bytes before the first block.
+            uint32_t channelCount;
+            uint32_t blockSamples;
+            uint64_t sampleCount;     // Updated with every sample.
+            int64_t  startTime_ns;    // Nanoseconds since the Unix epoch.
+            uint32_t textBytes;       // Bytes of NUL-terminated strings after this header.
+            uint32_t reserved;
+        };
+
+        const intptr_t s_noFile = -1;
+
+        std::runtime_error fileError(const std::string& action, const std::string& path) {
+#ifdef _WIN32
+            return std::runtime_error("Cannot " + action + " capture file " + path + " (error " + utils::to_string(GetLastError()) + ").");
+#else
+            return std::runtime_error("Cannot " + action + " capture file " + path + ": " + std::strerror(errno));
+#endif
+        }
+
+        // Schedules (`wait` = false) or performs a write-back of a mapping.
+        void flushMapping(char* data, size_t size, bool wait) {
+#ifdef _WIN32
+            FlushViewOfFile(data, size);
+            (void)wait;
+#else
+            msync(data, size, wait ? MS_SYNC : MS_ASYNC);
+#endif
+        }
+
+        void closeMapping(const char* data, size_t size, intptr_t mapping) {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(reinterpret_cast<HANDLE>(mapping));
+            (void)size;
+#else
+            if (data) munmap(const_cast<char*>(data), size);
+            (void)mapping;
+#endif
+        }
+
+        void closeFile(intptr_t file) {
+            if (file == s_noFile) return;
+#ifdef _WIN32
+            CloseHandle(reinterpret_cast<HANDLE>(file));
+#else
+            ::close(static_cast<int>(file));
+#endif
+        }
+
+#ifndef _WIN32
+        // Reserves the disk space of [offset, offset + length) and extends the file
+        // over it. Returns 0 or an errno value.
+        int reserveFileRange(int file, off_t offset, off_t length) {
+#ifdef __APPLE__
+            // macOS has no posix_fallocate(). F_PREALLOCATE reserves space after the
+            // end of the file without extending it, so ftruncate() follows. If the
+            // file system cannot preallocate, the file is extended sparsely, as
+            // without reservation, and a full disk is reported by a SIGBUS.
+            fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, length, 0};
+            if (fcntl(file, F_PREALLOCATE, &store) != 0) {
+                store.fst_flags = F_ALLOCATEALL;
+                if (fcntl(file, F_PREALLOCATE, &store) != 0 && errno == ENOSPC) return ENOSPC;
+            }
+            return ftruncate(file, offset + length) == 0 ? 0 : errno;
+#else
+            return posix_fallocate(file, offset, length);
+#endif
+        }
+#endif
+    }    // namespace
+
+    // --- CaptureWriter ---
+
+    CaptureWriter::CaptureWriter(const std::string& path, const std::string& instrument, const std::vector<CaptureChannel>& channels, size_t blockSamples,
+                                 unsigned int syncInterval_ms)
+        : m_path(path),
+          m_channelCount(channels.size()),
+          m_blockSamples(std::max<size_t>(blockSamples, 1)),
+          m_blockBytes(m_blockSamples * sizeof(double) * (channels.size() + 1)),
+          m_headerBytes(0),
+          m_file(s_noFile),
+          m_mapping(0),
+          m_data(nullptr),
+          m_mappedBlocks(0),
+          m_sampleCount(0),
+          m_start(std::chrono::steady_clock::now()),
+          m_syncInterval(syncInterval_ms),
+          m_lastSync(m_start) {
+        if (channels.empty()) throw std::invalid_argument("CaptureWriter: a capture needs at least one channel.");
+
+        std::string text(instrument.c_str(), instrument.size() + 1);
+        for (const auto& channel : channels) {
+            text.append(channel.name.c_str(), channel.name.size() + 1);
+            text.append(channel.command.c_str(), channel.command.size() + 1);
+        }
+        m_headerBytes = (sizeof(FileHeader) + text.size() + s_headerAlignment - 1) / s_headerAlignment * s_headerAlignment;
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw fileError("create", path);
+        m_file = reinterpret_cast<intptr_t>(file);
+#else
+        int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (file < 0) throw fileError("create", path);
+        m_file = file;
+#endif
+        try {
+            map(s_initialBlocks);
+        } catch (...) {
+            closeFile(m_file);
+            throw;
+        }
+
+        FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, s_magic, sizeof(s_magic));
+        header.version      = s_formatVersion;
+        header.headerBytes  = static_cast<uint32_t>(m_headerBytes);
+        header.channelCount = static_cast<uint32_t>(m_channelCount);
+        header.blockSamples = static_cast<uint32_t>(m_blockSamples);
+        header.sampleCount  = 0;
+        header.startTime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        header.textBytes    = static_cast<uint32_t>(text.size());
+        std::memcpy(m_data, &header, sizeof(header));
+        std::memcpy(m_data + sizeof(header), text.data(), text.size());
+    }
+
+    CaptureWriter::~CaptureWriter() {
+        try {
+            close();
+        } catch (...) {
+            // Destructors must not throw; the samples are in the page cache regardless.
+        }
+    }
+
+    void CaptureWriter::append(const double* values) { append(std::chrono::steady_clock::now(), values); }
+
+    void CaptureWriter::append(std::chrono::steady_clock::time_point time, const double* values) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_data) throw std::runtime_error("CaptureWriter: capture file " + m_path + " is closed.");
+
+        size_t blockIndex = static_cast<size_t>(m_sampleCount / m_blockSamples);
+        size_t slot       = static_cast<size_t>(m_sampleCount % m_blockSamples);
+        if (blockIndex >= m_mappedBlocks) {
+            size_t growth = std::min(m_mappedBlocks, std::max<size_t>(s_maxGrowthBytes / m_blockBytes, 1));
+            map(m_mappedBlocks + growth);
+        }
+
+        char*   block  = m_data + m_headerBytes + blockIndex * m_blockBytes;
+        int64_t offset = std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_start).count();
+        std::memcpy(block + slot * sizeof(int64_t), &offset, sizeof(offset));
+        for (size_t channel = 0; channel < m_channelCount; ++channel) {
+            std::memcpy(block + ((channel + 1) * m_blockSamples + slot) * sizeof(double), &values[channel], sizeof(double));
+        }
+        ++m_sampleCount;
+        std::memcpy(m_data + offsetof(FileHeader, sampleCount), &m_sampleCount, sizeof(m_sampleCount));
+
+        if (m_syncInterval.count() > 0) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (now - m_lastSync >= m_syncInterval) {
+                flushMapping(m_data, m_headerBytes + m_mappedBlocks * m_blockBytes, false);
+                m_lastSync = now;
+            }
+        }
+    }
+
+    void CaptureWriter::sync() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_data) return;
+        flushMapping(m_data, m_headerBytes + m_mappedBlocks * m_blockBytes, true);
+#ifdef _WIN32
+        FlushFileBuffers(reinterpret_cast<HANDLE>(m_file));
+#endif
+        m_lastSync = std::chrono::steady_clock::now();
+    }
+
+    void CaptureWriter::close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_file == s_noFile) return;
+        if (m_data) {
+            flushMapping(m_data, m_headerBytes + m_mappedBlocks * m_blockBytes, true);
+            unmap();
+        }
+
+        // Trim the unused blocks of the last growth step.
+        size_t    usedBlocks = static_cast<size_t>((m_sampleCount + m_blockSamples - 1) / m_blockSamples);
+        long long size       = static_cast<long long>(m_headerBytes + usedBlocks * m_blockBytes);
+        bool      trimmed;
+#ifdef _WIN32
+        LARGE_INTEGER end;
+        end.QuadPart = size;
+        HANDLE file  = reinterpret_cast<HANDLE>(m_file);
+        trimmed      = SetFilePointerEx(file, end, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+#else
+        trimmed = ftruncate(static_cast<int>(m_file), static_cast<off_t>(size)) == 0;
+#endif
+        std::runtime_error error = fileError("trim", m_path);
+        closeFile(m_file);
+        m_file = s_noFile;
+        if (!trimmed) throw error;
+    }
+
+    uint64_t CaptureWriter::sampleCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_sampleCount;
+    }
+
+    void CaptureWriter::map(size_t blocks) {
+        // The new mapping is created before the old one is released, so a failure
+        // leaves the capture writable at its previous size.
+        size_t size = m_headerBytes + blocks * m_blockBytes;
+#ifdef _WIN32
+        // Creating a mapping larger than the file extends the file.
+        DWORD  high    = static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32);
+        DWORD  low     = static_cast<DWORD>(static_cast<unsigned long long>(size) & 0xFFFFFFFFu);
+        HANDLE mapping = CreateFileMappingA(reinterpret_cast<HANDLE>(m_file), nullptr, PAGE_READWRITE, high, low, nullptr);
+        if (!mapping) throw fileError("grow", m_path);
+        void* data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+        if (!data) {
+            std::runtime_error error = fileError("map", m_path);
+            CloseHandle(mapping);
+            throw error;
+        }
+        unmap();
+        m_mapping = reinterpret_cast<intptr_t>(mapping);
+#else
+        // Reserve the disk space of the new range: with a sparse file, a full disk
+        // would only show as a SIGBUS on a later store into the mapping.
+        size_t mapped = m_data ? m_headerBytes + m_mappedBlocks * m_blockBytes : 0;
+        int    result = reserveFileRange(static_cast<int>(m_file), static_cast<off_t>(mapped), static_cast<off_t>(size - mapped));
+        if (result != 0) {
+            errno = result;    // posix_fallocate() returns the error instead of setting errno.
+            throw fileError("grow", m_path);
+        }
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, static_cast<int>(m_file), 0);
+        if (data == MAP_FAILED) throw fileError("map", m_path);
+        unmap();
+#endif
+        m_data         = static_cast<char*>(data);
+        m_mappedBlocks = blocks;
+    }
+
+    void CaptureWriter::unmap() {
+        closeMapping(m_data, m_headerBytes + m_mappedBlocks * m_blockBytes, m_mapping);
+        m_data         = nullptr;
+        m_mapping      = 0;
+        m_mappedBlocks = 0;
+    }
+
+    // --- CaptureReader ---
+
+    CaptureReader::CaptureReader(const std::string& path)
+        : m_file(s_noFile), m_mapping(0), m_data(nullptr), m_size(0), m_blockSamples(0), m_blockBytes(0), m_headerBytes(0), m_blockCount(0), m_sampleCount(0) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw fileError("open", path);
+        m_file = reinterpret_cast<intptr_t>(file);
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            std::runtime_error error = fileError("open", path);
+            closeFile(m_file);
+            throw error;
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) throw fileError("open", path);
+        m_file = file;
+        struct stat status;
+        if (fstat(file, &status) != 0) {
+            std::runtime_error error = fileError("open", path);
+            closeFile(m_file);
+            throw error;
+        }
+        m_size = static_cast<size_t>(status.st_size);
+#endif
+        if (m_size < sizeof(FileHeader)) {
+            closeFile(m_file);
+            throw std::runtime_error("Not a capture file: " + path);
+        }
+
+#ifdef _WIN32
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void*  data    = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!data) {
+            std::runtime_error error = fileError("map", path);
+            if (mapping) CloseHandle(mapping);
+            closeFile(m_file);
+            throw error;
+        }
+        m_mapping = reinterpret_cast<intptr_t>(mapping);
+#else
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0);
+        if (data == MAP_FAILED) {
+            std::runtime_error error = fileError("map", path);
+            closeFile(m_file);
+            throw error;
+        }
+#endif
+        m_data = static_cast<const char*>(data);
+
+        FileHeader header;
+        std::memcpy(&header, m_data, sizeof(header));
+        bool valid = std::memcmp(header.magic, s_magic, sizeof(s_magic)) == 0 && header.version == s_formatVersion && header.channelCount > 0 &&
+                     header.blockSamples > 0 && header.headerBytes <= m_size && sizeof(FileHeader) + header.textBytes <= header.headerBytes;
+
+        // The strings: the identification, then a name and a command per channel.
+        const char* text    = m_data + sizeof(FileHeader);
+        const char* textEnd = text + (valid ? header.textBytes : 0);
+        auto        next    = [&](std::string& value) {
+            const char* end = static_cast<const char*>(std::memchr(text, '\0', static_cast<size_t>(textEnd - text)));
+            if (!end) return false;
+            value.assign(text, end);
+            text = end + 1;
+            return true;
+        };
+        valid = valid && next(m_info.instrument);
+        m_info.channels.resize(valid ? header.channelCount : 0);
+        for (auto& channel : m_info.channels) {
+            valid = valid && next(channel.name) && next(channel.command);
+        }
+        if (!valid) {
+            closeMapping(m_data, m_size, m_mapping);
+            closeFile(m_file);
+            throw std::runtime_error("Not a valid capture file: " + path);
+        }
+
+        m_info.startTime_ns = header.startTime_ns;
+        m_blockSamples      = header.blockSamples;
+        m_blockBytes        = m_blockSamples * sizeof(double) * (m_info.channels.size() + 1);
+        m_headerBytes       = header.headerBytes;
+
+        // A file that is still being written may hold fewer complete samples than its count claims.
+        uint64_t capacity = static_cast<uint64_t>((m_size - m_headerBytes) / m_blockBytes) * m_blockSamples;
+        m_sampleCount     = std::min(header.sampleCount, capacity);
+        m_blockCount      = static_cast<size_t>((m_sampleCount + m_blockSamples - 1) / m_blockSamples);
+    }
+
+    CaptureReader::~CaptureReader() {
+        closeMapping(m_data, m_size, m_mapping);
+        closeFile(m_file);
+    }
+
+    size_t CaptureReader::samplesInBlock(size_t index) const {
+        if (index >= m_blockCount) return 0;
+        if (index + 1 < m_blockCount) return m_blockSamples;
+        return static_cast<size_t>(m_sampleCount - static_cast<uint64_t>(index) * m_blockSamples);
+    }
+
+    const int64_t* CaptureReader::times(size_t index) const {
+        if (index >= m_blockCount) throw std::out_of_range("CaptureReader: block index out of range.");
+        return reinterpret_cast<const int64_t*>(block(index));
+    }
+
+    const double* CaptureReader::column(size_t index, size_t channel) const {
+        if (index >= m_blockCount) throw std::out_of_range("CaptureReader: block index out of range.");
+        if (channel >= m_info.channels.size()) throw std::out_of_range("CaptureReader: channel index out of range.");
+        return reinterpret_cast<const double*>(block(index)) + (channel + 1) * m_blockSamples;
+    }
+
+    int64_t CaptureReader::time(uint64_t sample) const {
+        if (sample >= m_sampleCount) throw std::out_of_range("CaptureReader: sample index out of range.");
+        return times(static_cast<size_t>(sample / m_blockSamples))[sample % m_blockSamples];
+    }
+
+    double CaptureReader::value(uint64_t sample, size_t channel) const {
+        if (sample >= m_sampleCount) throw std::out_of_range("CaptureReader: sample index out of range.");
+        return column(static_cast<size_t>(sample / m_blockSamples), channel)[sample % m_blockSamples];
+    }
+
+}    // namespace cvisa
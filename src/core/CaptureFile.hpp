@@ -0,0 +1,246 @@
+#ifndef CVISA_CAPTURE_FILE_HPP
+#define CVISA_CAPTURE_FILE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cvisa {
+
+    /**
+     * @brief Describes one channel of a capture file.
+     */
+    struct CaptureChannel {
+        std::string name;       // A short label (e.g., "voltage").
+        std::string command;    // The query that produced the values (e.g., "MEAS:VOLT?").
+    };
+
+    /**
+     * @brief The descriptive header of a capture file.
+     */
+    struct CaptureInfo {
+        std::string                 instrument;      // The instrument's identification (`*IDN?`).
+        std::vector<CaptureChannel> channels;        // One entry per value column.
+        int64_t                     startTime_ns;    // Wall-clock start time, nanoseconds since the Unix epoch.
+    };
+
+    /**
+     * @class CaptureWriter
+     * @brief Appends timestamped samples to a memory-mapped capture file.
+     *
+     * A capture file holds fixed-width samples: a timestamp and one `double`
+     * per channel. Samples are stored in blocks of `blockSamples`, and inside
+     * a block every channel is a contiguous column, so `CaptureReader` can
+     * hand out whole columns without copying.
+     *
+     * `append()` copies a sample into the mapped file under a mutex and never
+     * waits for the disk: the file is grown in large steps, and the kernel
+     * writes dirty pages back in the background. The steps double in size up
+     * to 64 MiB, and the disk space of each step is reserved when the file
+     * grows (`posix_fallocate()`, or `F_PREALLOCATE` on macOS), so a full disk
+     * makes that `append()` throw instead of faulting on a later store. On a
+     * file system that cannot preallocate, macOS extends the file sparsely. Every `syncInterval_ms`,
+     * `append()` additionally schedules a non-blocking write-back
+     * (`msync(MS_ASYNC)`); `sync()` waits for it. The sample count
+     * in the header is updated with every sample, so a file stays readable up
+     * to its last sample after a crash.
+     *
+     * The layout is native-endian:
+     * - A header page: the magic "CVISACAP", the format version, the header
+     *   size, the channel count, the block size, the sample count, the start
+     *   time and the identification, channel names and commands as
+     *   NUL-terminated strings.
+     * - Blocks of `blockSamples` samples: an `int64_t` column of nanoseconds
+     *   since the start time, then one `double` column per channel.
+     *
+     * @code
+     * std::vector<cvisa::CaptureChannel> channels = {{"voltage", "MEAS:VOLT?"}, {"current", "MEAS:CURR?"}};
+     * cvisa::CaptureWriter capture("overnight.cvcap", psu.IDN_Query(), channels);
+     * double sample[2] = {psu.measureVoltage(), psu.measureCurrent()};
+     * capture.append(sample);
+     * @endcode
+     */
+    class CaptureWriter {
+      public:
+        /**
+         * @brief Creates (or truncates) a capture file.
+         *
+         * @param path The file to write.
+         * @param instrument The instrument's identification string.
+         * @param channels The channels of every sample (at least one).
+         * @param blockSamples The samples per block (at least 1). Larger blocks
+         * give longer contiguous columns.
+         * @param syncInterval_ms The interval of background write-backs; 0 leaves
+         * write-back entirely to the operating system.
+         * @throws std::invalid_argument if `channels` is empty.
+         * @throws std::runtime_error if the file cannot be created or mapped.
+         */
+        CaptureWriter(const std::string& path, const std::string& instrument, const std::vector<CaptureChannel>& channels, size_t blockSamples = 4096,
+                      unsigned int syncInterval_ms = 1000);
+
+        /**
+         * @brief Destructor. Closes the file if it is open.
+         */
+        ~CaptureWriter();
+
+        CaptureWriter(const CaptureWriter&)            = delete;
+        CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+        /**
+         * @brief Appends a sample taken now.
+         * @param values One value per channel.
+         * @throws std::runtime_error if the file cannot be grown, or is closed.
+         */
+        void append(const double* values);
+
+        /**
+         * @brief Appends a sample taken at `time`.
+         *
+         * Steady-clock times are converted to offsets from the capture's start,
+         * so samples from `ThermalAirTelemetry` or other timestamped sources keep
+         * their acquisition time.
+         *
+         * @param time When the sample was taken.
+         * @param values One value per channel.
+         * @throws std::runtime_error if the file cannot be grown, or is closed.
+         */
+        void append(std::chrono::steady_clock::time_point time, const double* values);
+
+        /**
+         * @brief Waits until all appended samples are written to the disk.
+         */
+        void sync();
+
+        /**
+         * @brief Writes all samples, trims the file to its last block and closes it.
+         */
+        void close();
+
+        /// @return The number of channels per sample.
+        size_t channelCount() const { return m_channelCount; }
+
+        /// @return The number of samples appended.
+        uint64_t sampleCount() const;
+
+        /// @return The file's path.
+        const std::string& path() const { return m_path; }
+
+      private:
+        // Maps `blocks` blocks, growing the file. Requires `m_mutex`.
+        void map(size_t blocks);
+        void unmap();
+
+        mutable std::mutex m_mutex;
+        std::string        m_path;
+        size_t             m_channelCount;
+        size_t             m_blockSamples;
+        size_t             m_blockBytes;     // Bytes per block.
+        size_t             m_headerBytes;    // Bytes before the first block.
+
+        intptr_t m_file;       // File descriptor, or HANDLE on Windows.
+        intptr_t m_mapping;    // File mapping HANDLE on Windows.
+        char*    m_data;       // The mapped file.
+        size_t   m_mappedBlocks;
+        uint64_t m_sampleCount;
+
+        std::chrono::steady_clock::time_point m_start;
+        std::chrono::milliseconds             m_syncInterval;
+        std::chrono::steady_clock::time_point m_lastSync;
+    };
+
+    /**
+     * @class CaptureReader
+     * @brief Reads a capture file in place through a read-only memory mapping.
+     *
+     * Columns are returned as pointers into the mapping, so reloading a capture
+     * costs no parsing and no copies. A file that is still being written can be
+     * opened; the reader sees the samples written before it was opened.
+     *
+     * @code
+     * cvisa::CaptureReader capture("overnight.cvcap");
+     * for (size_t block = 0; block < capture.blockCount(); ++block) {
+     *     const double* volts = capture.column(block, 0);
+     *     size_t        count = capture.samplesInBlock(block);
+     *     // ...
+     * }
+     * @endcode
+     */
+    class CaptureReader {
+      public:
+        /**
+         * @brief Opens and maps a capture file.
+         * @throws std::runtime_error if the file cannot be mapped or is not a capture file.
+         */
+        explicit CaptureReader(const std::string& path);
+
+        /**
+         * @brief Destructor. Unmaps the file.
+         */
+        ~CaptureReader();
+
+        CaptureReader(const CaptureReader&)            = delete;
+        CaptureReader& operator=(const CaptureReader&) = delete;
+
+        /// @return The identification, channels and start time.
+        const CaptureInfo& info() const { return m_info; }
+
+        /// @return The number of channels per sample.
+        size_t channelCount() const { return m_info.channels.size(); }
+
+        /// @return The number of samples.
+        uint64_t sampleCount() const { return m_sampleCount; }
+
+        /// @return The number of blocks holding samples.
+        size_t blockCount() const { return m_blockCount; }
+
+        /// @return The capacity of a block, in samples.
+        size_t blockSamples() const { return m_blockSamples; }
+
+        /// @return The number of samples in `block`; only the last block may be partial.
+        size_t samplesInBlock(size_t block) const;
+
+        /**
+         * @brief Returns the timestamps of a block, in nanoseconds since the start time.
+         * @throws std::out_of_range if `block` is invalid.
+         */
+        const int64_t* times(size_t block) const;
+
+        /**
+         * @brief Returns one channel of a block.
+         * @throws std::out_of_range if `block` or `channel` is invalid.
+         */
+        const double* column(size_t block, size_t channel) const;
+
+        /**
+         * @brief Returns the timestamp of a sample, in nanoseconds since the start time.
+         * @throws std::out_of_range if `sample` is invalid.
+         */
+        int64_t time(uint64_t sample) const;
+
+        /**
+         * @brief Returns one value of a sample.
+         * @throws std::out_of_range if `sample` or `channel` is invalid.
+         */
+        double value(uint64_t sample, size_t channel) const;
+
+      private:
+        const char* block(size_t index) const { return m_data + m_headerBytes + index * m_blockBytes; }
+
+        intptr_t    m_file;
+        intptr_t    m_mapping;
+        const char* m_data;
+        size_t      m_size;
+        CaptureInfo m_info;
+        size_t      m_blockSamples;
+        size_t      m_blockBytes;
+        size_t      m_headerBytes;
+        size_t      m_blockCount;
+        uint64_t    m_sampleCount;
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_CAPTURE_FILE_HPP
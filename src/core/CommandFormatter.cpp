@@ -0,0 +1,329 @@
+#include "CommandFormatter.hpp"
+
+#include "Exceptions.hpp"
+
+#include <cctype>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace cvisa {
+
+    namespace {
+
+        // Largest precision handled by the integer fast path of `appendFixed`.
+        const int s_maxFastPrecision = 15;
+
+        const unsigned long long s_powersOfTen[] = {1ULL,
+                                                    10ULL,
+                                                    100ULL,
+                                                    1000ULL,
+                                                    10000ULL,
+                                                    100000ULL,
+                                                    1000000ULL,
+                                                    10000000ULL,
+                                                    100000000ULL,
+                                                    1000000000ULL,
+                                                    10000000000ULL,
+                                                    100000000000ULL,
+                                                    1000000000000ULL,
+                                                    10000000000000ULL,
+                                                    100000000000000ULL,
+                                                    1000000000000000ULL};
+
+        // A parsed conversion specifier.
+        struct Spec {
+            bool leftAlign;
+            bool zeroPad;
+            bool plusSign;
+            bool spaceSign;
+            int  width;
+            int  precision;    // -1 if not given.
+            char conversion;
+        };
+
+        // Writes `value` in reverse digit order into the end of `buffer` and returns the first digit.
+        char* formatDigits(char* end, unsigned long long value, unsigned base, bool upper) {
+            const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+            do {
+                *--end = digits[value % base];
+                value /= base;
+            } while (value != 0);
+            return end;
+        }
+
+        // Replaces a locale-specific decimal separator written by `snprintf` with '.'.
+        void normalizeDecimalPoint(char* text) {
+            const char* point = std::localeconv()->decimal_point;
+            if (point == nullptr || (point[0] == '.' && point[1] == '\0')) {
+                return;
+            }
+            char* found = std::strstr(text, point);
+            if (found != nullptr) {
+                size_t pointLength = std::strlen(point);
+                *found             = '.';
+                std::memmove(found + 1, found + pointLength, std::strlen(found + pointLength) + 1);
+            }
+        }
+
+        // Appends `value` using `snprintf` for conversions the fast paths do not cover.
+        void appendWithPrintf(std::string& out, double value, char conversion, int precision) {
+            char format[] = {'%', '.', '*', conversion, '\0'};
+            char buffer[512];
+            int  length = std::snprintf(buffer, sizeof(buffer), format, precision, value);
+            if (length < 0 || static_cast<size_t>(length) >= sizeof(buffer)) {
+                throw CommandException("Error during command formatting: value out of range.");
+            }
+            normalizeDecimalPoint(buffer);
+            out.append(buffer);
+        }
+
+        bool parseSpec(const char*& cursor, Spec& spec) {
+            spec = Spec{false, false, false, false, 0, -1, '\0'};
+            for (;; ++cursor) {
+                if (*cursor == '-') {
+                    spec.leftAlign = true;
+                } else if (*cursor == '0') {
+                    spec.zeroPad = true;
+                } else if (*cursor == '+') {
+                    spec.plusSign = true;
+                } else if (*cursor == ' ') {
+                    spec.spaceSign = true;
+                } else if (*cursor != '#') {
+                    break;
+                }
+            }
+            while (*cursor >= '0' && *cursor <= '9') {
+                spec.width = spec.width * 10 + (*cursor++ - '0');
+            }
+            if (*cursor == '.') {
+                ++cursor;
+                spec.precision = 0;
+                while (*cursor >= '0' && *cursor <= '9') {
+                    spec.precision = spec.precision * 10 + (*cursor++ - '0');
+                }
+            }
+            while (*cursor == 'l' || *cursor == 'h' || *cursor == 'z' || *cursor == 'j' || *cursor == 't' || *cursor == 'L') {
+                ++cursor;
+            }
+            spec.conversion = *cursor;
+            if (spec.conversion == '\0') {
+                return false;
+            }
+            ++cursor;
+            return true;
+        }
+
+        // Pads the text appended since `start` to the field width of `spec`.
+        void applyWidth(std::string& out, size_t start, const Spec& spec, bool numeric) {
+            size_t length = out.size() - start;
+            if (spec.width <= 0 || length >= static_cast<size_t>(spec.width)) {
+                return;
+            }
+            size_t padding = static_cast<size_t>(spec.width) - length;
+            if (spec.leftAlign) {
+                out.append(padding, ' ');
+            } else if (spec.zeroPad && numeric && std::isdigit(static_cast<unsigned char>(out.back()))) {
+                size_t digitsStart = start;
+                if (out[digitsStart] == '-' || out[digitsStart] == '+' || out[digitsStart] == ' ') {
+                    ++digitsStart;
+                }
+                out.insert(digitsStart, padding, '0');
+            } else {
+                out.insert(start, padding, ' ');
+            }
+        }
+
+        void appendSign(std::string& out, bool negative, const Spec& spec) {
+            if (negative) {
+                out.push_back('-');
+            } else if (spec.plusSign) {
+                out.push_back('+');
+            } else if (spec.spaceSign) {
+                out.push_back(' ');
+            }
+        }
+
+        void appendIntegerArgument(std::string& out, const Spec& spec, const format_detail::Argument& arg) {
+            bool               negative  = arg.isSigned && arg.integer < 0;
+            unsigned long long magnitude = arg.isSigned ? (negative ? 0ULL - static_cast<unsigned long long>(arg.integer) : static_cast<unsigned long long>(arg.integer))
+                                                        : arg.uinteger;
+            char               buffer[24];
+            char*              end = buffer + sizeof(buffer);
+            char*              first;
+
+            switch (spec.conversion) {
+                case 'c':
+                    out.push_back(static_cast<char>(arg.isSigned ? arg.integer : static_cast<long long>(arg.uinteger)));
+                    return;
+                case 'x':
+                case 'X':
+                case 'o':
+                    // Like printf, hex and octal print the two's complement bit pattern of negative values.
+                    magnitude = arg.isSigned ? static_cast<unsigned long long>(arg.integer) : arg.uinteger;
+                    first     = formatDigits(end, magnitude, spec.conversion == 'o' ? 8 : 16, spec.conversion == 'X');
+                    break;
+                case 'u':
+                    magnitude = arg.isSigned ? static_cast<unsigned long long>(arg.integer) : arg.uinteger;
+                    first     = formatDigits(end, magnitude, 10, false);
+                    break;
+                default:
+                    appendSign(out, negative, spec);
+                    first = formatDigits(end, magnitude, 10, false);
+                    break;
+            }
+            out.append(first, end);
+        }
+
+        void appendFloatingArgument(std::string& out, const Spec& spec, double value, int precision) {
+            if (spec.conversion == 'f' || spec.conversion == 'F') {
+                if (!std::signbit(value) || std::isnan(value)) {
+                    appendSign(out, false, spec);
+                }
+                CommandFormatter::appendFixed(out, value, precision);
+                return;
+            }
+            if (std::isfinite(value) && !std::signbit(value)) {
+                appendSign(out, false, spec);
+            }
+            if (!std::isfinite(value)) {
+                CommandFormatter::appendFixed(out, value, 0);
+                return;
+            }
+            appendWithPrintf(out, value, spec.conversion, precision);
+        }
+
+        // Copies literal text from the template up to the next specifier, handling "%%".
+        // Returns false if the end of the template is reached first.
+        bool copyLiteral(format_detail::State& state) {
+            const char* cursor = state.cursor;
+            for (;;) {
+                const char* percent = std::strchr(cursor, '%');
+                if (percent == nullptr) {
+                    state.out.append(cursor);
+                    state.cursor = cursor + std::strlen(cursor);
+                    return false;
+                }
+                state.out.append(cursor, percent);
+                if (percent[1] != '%') {
+                    state.cursor = percent + 1;
+                    return true;
+                }
+                state.out.push_back('%');
+                cursor = percent + 2;
+            }
+        }
+
+    }    // namespace
+
+    namespace format_detail {
+
+        Argument makeArgument(const char* value) {
+            Argument arg = {ArgKind::STRING, false, 0, 0, 0.0, value != nullptr ? value : "", value != nullptr ? std::strlen(value) : 0};
+            return arg;
+        }
+
+        Argument makeArgument(const std::string& value) {
+            Argument arg = {ArgKind::STRING, false, 0, 0, 0.0, value.data(), value.size()};
+            return arg;
+        }
+
+        void formatArgument(State& state, const Argument& arg) {
+            Spec spec;
+            if (!copyLiteral(state) || !parseSpec(state.cursor, spec)) {
+                throw CommandException("Error during command formatting: too many arguments for the command template.");
+            }
+            if (!accepts(spec.conversion, arg.kind)) {
+                throw CommandException(std::string("Error during command formatting: argument does not match specifier '%") + spec.conversion + "'.");
+            }
+
+            size_t start = state.out.size();
+            switch (arg.kind) {
+                case ArgKind::INTEGER:
+                    if (spec.conversion == 'd' || spec.conversion == 'i' || spec.conversion == 'u' || spec.conversion == 'x' || spec.conversion == 'X'
+                        || spec.conversion == 'o' || spec.conversion == 'c') {
+                        appendIntegerArgument(state.out, spec, arg);
+                    } else {
+                        double value = arg.isSigned ? static_cast<double>(arg.integer) : static_cast<double>(arg.uinteger);
+                        appendFloatingArgument(state.out, spec, value, spec.precision >= 0 ? spec.precision : state.defaultPrecision);
+                    }
+                    break;
+                case ArgKind::FLOATING:
+                    appendFloatingArgument(state.out, spec, arg.floating, spec.precision >= 0 ? spec.precision : state.defaultPrecision);
+                    break;
+                default: {
+                    size_t length = arg.length;
+                    if (spec.precision >= 0 && static_cast<size_t>(spec.precision) < length) {
+                        length = static_cast<size_t>(spec.precision);
+                    }
+                    state.out.append(arg.text, length);
+                    break;
+                }
+            }
+            applyWidth(state.out, start, spec, arg.kind != ArgKind::STRING && spec.conversion != 'c');
+        }
+
+        void finish(State& state) {
+            if (copyLiteral(state)) {
+                throw CommandException("Error during command formatting: missing argument for the command template.");
+            }
+        }
+
+    }    // namespace format_detail
+
+    void CommandFormatter::appendInteger(std::string& out, long long value) {
+        char  buffer[24];
+        char* end   = buffer + sizeof(buffer);
+        char* first = formatDigits(end, value < 0 ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value), 10, false);
+        if (value < 0) {
+            *--first = '-';
+        }
+        out.append(first, end);
+    }
+
+    void CommandFormatter::appendUnsigned(std::string& out, unsigned long long value) {
+        char  buffer[24];
+        char* end = buffer + sizeof(buffer);
+        out.append(formatDigits(end, value, 10, false), end);
+    }
+
+    void CommandFormatter::appendFixed(std::string& out, double value, int precision) {
+        if (std::isnan(value)) {
+            out.append("NAN");
+            return;
+        }
+        if (std::isinf(value)) {
+            out.append(value < 0 ? "NINF" : "INF");
+            return;
+        }
+        if (precision < 0) {
+            precision = 0;
+        }
+
+        // Fast path: scale to an integer number of units of the last decimal and print its digits.
+        double magnitude = std::fabs(value);
+        if (precision <= s_maxFastPrecision && magnitude < 9.0e18 / static_cast<double>(s_powersOfTen[precision])) {
+            unsigned long long scale  = s_powersOfTen[precision];
+            unsigned long long scaled = static_cast<unsigned long long>(magnitude * static_cast<double>(scale) + 0.5);
+            // Scaling can lose precision for large values; fall back when the result cannot be exact.
+            if (scaled < (1ULL << 53)) {
+                if (std::signbit(value) && scaled != 0) {
+                    out.push_back('-');
+                }
+                appendUnsigned(out, scaled / scale);
+                if (precision > 0) {
+                    char  buffer[24];
+                    char* end   = buffer + sizeof(buffer);
+                    char* first = formatDigits(end, scaled % scale, 10, false);
+                    out.push_back('.');
+                    out.append(static_cast<size_t>(precision) - static_cast<size_t>(end - first), '0');
+                    out.append(first, end);
+                }
+                return;
+            }
+        }
+        appendWithPrintf(out, value, 'f', precision);
+    }
+
+}    // namespace cvisa
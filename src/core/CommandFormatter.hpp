@@ -0,0 +1,215 @@
+#ifndef CVISA_COMMAND_FORMATTER_HPP
+#define CVISA_COMMAND_FORMATTER_HPP
+
+#include "SCPICommand.hpp"
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+namespace cvisa {
+
+    namespace format_detail {
+
+        // The kinds of arguments accepted by the formatter.
+        enum class ArgKind { INTEGER, FLOATING, STRING, INVALID };
+
+        template <typename T>
+        struct kind_of {
+            static constexpr ArgKind value = std::is_integral<T>::value         ? ArgKind::INTEGER
+                                             : std::is_floating_point<T>::value ? ArgKind::FLOATING
+                                             : std::is_enum<T>::value           ? ArgKind::INTEGER
+                                                                                : ArgKind::INVALID;
+        };
+        template <>
+        struct kind_of<const char*> {
+            static constexpr ArgKind value = ArgKind::STRING;
+        };
+        template <>
+        struct kind_of<char*> {
+            static constexpr ArgKind value = ArgKind::STRING;
+        };
+        template <>
+        struct kind_of<std::string> {
+            static constexpr ArgKind value = ArgKind::STRING;
+        };
+
+        constexpr bool isSpecModifier(char c) {
+            return c == '-' || c == '+' || c == ' ' || c == '#' || c == '.' || (c >= '0' && c <= '9') || c == 'l' || c == 'h' || c == 'z' || c == 'j' || c == 't'
+                   || c == 'L';
+        }
+
+        // Returns a pointer to the conversion character of the specifier starting at `p` (just after '%').
+        constexpr const char* conversionOf(const char* p) { return isSpecModifier(*p) ? conversionOf(p + 1) : p; }
+
+        // Returns a pointer to the conversion character of the next specifier, or nullptr if there is none.
+        constexpr const char* nextConversion(const char* p) {
+            return *p == '\0' ? nullptr : *p != '%' ? nextConversion(p + 1) : p[1] == '%' ? nextConversion(p + 2) : conversionOf(p + 1);
+        }
+
+        constexpr bool accepts(char conversion, ArgKind kind) {
+            return (conversion == 'd' || conversion == 'i' || conversion == 'u' || conversion == 'x' || conversion == 'X' || conversion == 'o' || conversion == 'c')
+                       ? kind == ArgKind::INTEGER
+                   : (conversion == 'f' || conversion == 'F' || conversion == 'e' || conversion == 'E' || conversion == 'g' || conversion == 'G')
+                       ? (kind == ArgKind::FLOATING || kind == ArgKind::INTEGER)
+                   : conversion == 's' ? kind == ArgKind::STRING
+                                       : false;
+        }
+
+        template <typename... Args>
+        struct checker;
+
+        template <>
+        struct checker<> {
+            static constexpr bool check(const char* p) { return nextConversion(p) == nullptr; }
+        };
+
+        template <typename T, typename... Rest>
+        struct checker<T, Rest...> {
+            static constexpr bool check(const char* p) { return checkAt(nextConversion(p)); }
+            static constexpr bool checkAt(const char* conversion) {
+                return conversion != nullptr && accepts(*conversion, kind_of<T>::value) && checker<Rest...>::check(conversion + 1);
+            }
+        };
+
+        // A type-erased formatting argument.
+        struct Argument {
+            ArgKind            kind;
+            bool               isSigned;
+            long long          integer;
+            unsigned long long uinteger;
+            double             floating;
+            const char*        text;
+            size_t             length;
+        };
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, Argument>::type makeArgument(const T& value) {
+            Argument arg = {ArgKind::INTEGER, true, static_cast<long long>(value), 0, 0.0, nullptr, 0};
+            return arg;
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, Argument>::type makeArgument(const T& value) {
+            Argument arg = {ArgKind::INTEGER, false, 0, static_cast<unsigned long long>(value), 0.0, nullptr, 0};
+            return arg;
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_enum<T>::value, Argument>::type makeArgument(const T& value) {
+            Argument arg = {ArgKind::INTEGER, true, static_cast<long long>(value), 0, 0.0, nullptr, 0};
+            return arg;
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_floating_point<T>::value, Argument>::type makeArgument(const T& value) {
+            Argument arg = {ArgKind::FLOATING, true, 0, 0, static_cast<double>(value), nullptr, 0};
+            return arg;
+        }
+
+        Argument makeArgument(const char* value);
+        Argument makeArgument(const std::string& value);
+
+        // State of one formatting pass: the output and the unconsumed part of the template.
+        struct State {
+            std::string& out;
+            const char*  cursor;
+            int          defaultPrecision;
+        };
+
+        // Copies literal text up to the next specifier and formats `arg` into it.
+        // Throws CommandException if the template has no specifier left or the kinds do not match.
+        void formatArgument(State& state, const Argument& arg);
+
+        // Copies the remaining literal text. Throws CommandException if a specifier is left unused.
+        void finish(State& state);
+
+        inline void formatAll(State& state) { finish(state); }
+
+        template <typename T, typename... Rest>
+        void formatAll(State& state, const T& value, const Rest&... rest) {
+            formatArgument(state, makeArgument(value));
+            formatAll(state, rest...);
+        }
+
+    }    // namespace format_detail
+
+    /**
+     * @brief Checks at compile time whether a command template accepts the given argument types.
+     *
+     * Integer arguments match `%d`, `%i`, `%u`, `%x`, `%o` and `%c`; integer or
+     * floating-point arguments match `%f`, `%e` and `%g`; `const char*` and
+     * `std::string` match `%s`. The number of specifiers must equal the number
+     * of arguments. Because `SCPICommand` definitions are `constexpr`, drivers
+     * validate their templates with a `static_assert`:
+     *
+     * @code
+     * static_assert(commandAccepts<double>(Commands::SET_VOLTAGE()), "SET_VOLTAGE expects one double.");
+     * @endcode
+     *
+     * @tparam Args The argument types the command will be executed with.
+     * @param command The command definition to check.
+     * @return True if the template and the argument types match.
+     */
+    template <typename... Args>
+    constexpr bool commandAccepts(const SCPICommand& command) {
+        return format_detail::checker<typename std::decay<Args>::type...>::check(command.command);
+    }
+
+    /**
+     * @class CommandFormatter
+     * @brief Allocation-free, locale-independent formatting of SCPI command templates.
+     *
+     * The formatter understands the printf-style specifiers used by command
+     * templates (`%d`, `%i`, `%u`, `%x`, `%X`, `%o`, `%c`, `%f`, `%e`, `%g`,
+     * `%s`, `%%`, with optional flags, width and precision), but converts
+     * values with its own integer and fixed-point routines instead of
+     * `snprintf`. Output is appended to a caller-owned string whose capacity
+     * is reused, so formatting a command in a loop does not allocate. The
+     * decimal separator is always '.', regardless of the C locale.
+     *
+     * Unlike printf varargs, mismatched arguments are rejected: a `CommandException`
+     * is thrown if the number or kind of arguments does not match the template.
+     */
+    class CommandFormatter {
+      public:
+        /**
+         * @brief Formats a command template into `out`.
+         *
+         * @tparam Args The argument types (arithmetic, `const char*` or `std::string`).
+         * @param out The destination string. Its previous contents are replaced.
+         * @param format The command template (e.g., "VOLT %f").
+         * @param defaultPrecision The number of decimals used for `%f`, `%e` and `%g`
+         * when the template does not give one (printf uses 6).
+         * @param args The arguments to format.
+         * @throws CommandException if the arguments do not match the template.
+         */
+        template <typename... Args>
+        static void format(std::string& out, const char* format, int defaultPrecision, const Args&... args) {
+            out.clear();
+            format_detail::State state = {out, format, defaultPrecision};
+            format_detail::formatAll(state, args...);
+        }
+
+        /**
+         * @brief Appends a signed integer in decimal notation.
+         */
+        static void appendInteger(std::string& out, long long value);
+
+        /**
+         * @brief Appends an unsigned integer in decimal notation.
+         */
+        static void appendUnsigned(std::string& out, unsigned long long value);
+
+        /**
+         * @brief Appends a floating-point value in fixed-point notation.
+         *
+         * Values are rounded half away from zero to `precision` decimals.
+         * Non-finite values are written as the SCPI keywords `NAN`, `INF` and `NINF`.
+         */
+        static void appendFixed(std::string& out, double value, int precision);
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_COMMAND_FORMATTER_HPP
@@ -0,0 +1,80 @@
+#include "CommandQueue.hpp"
+
+#include <utility>
+
+namespace cvisa {
+
+    CommandQueue::CommandQueue() : m_stopping(false), m_joining(false) {}
+
+    CommandQueue::~CommandQueue() { stop(); }
+
+    void CommandQueue::enqueue(std::function<void()> job) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_worker.joinable() || m_joining) {
+            if (m_workerId == std::this_thread::get_id()) {
+                // Submitted from inside a task: the worker runs it before it can exit.
+                m_jobs.push_back(std::move(job));
+                return;
+            }
+            m_joined.wait(lock, [this]() { return !m_joining; });
+            if (m_stopping && m_worker.joinable()) join(lock);    // Stopped from inside a task and not joined yet.
+        }
+        m_jobs.push_back(std::move(job));
+        if (!m_worker.joinable()) {
+            m_worker   = std::thread(&CommandQueue::run, this);
+            m_workerId = m_worker.get_id();
+        }
+        m_wakeup.notify_one();
+    }
+
+    void CommandQueue::stop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_joined.wait(lock, [this]() { return !m_joining; });
+        if (!m_worker.joinable()) return;
+        m_stopping = true;
+        if (m_workerId == std::this_thread::get_id()) {
+            // Stopped from inside a task: the worker exits once the queue drains and is joined later.
+            m_wakeup.notify_one();
+            return;
+        }
+        join(lock);
+    }
+
+    void CommandQueue::join(std::unique_lock<std::mutex>& lock) {
+        m_stopping         = true;
+        m_joining          = true;
+        std::thread worker = std::move(m_worker);
+        lock.unlock();
+        m_wakeup.notify_one();
+        worker.join();
+        lock.lock();
+        m_workerId = std::thread::id();
+        m_stopping = false;
+        m_joining  = false;
+        m_joined.notify_all();
+    }
+
+    size_t CommandQueue::pending() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_jobs.size();
+    }
+
+    void CommandQueue::run() {
+        std::deque<std::function<void()>> batch;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeup.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+                if (m_jobs.empty()) return;    // Stopping and fully drained.
+                batch.swap(m_jobs);
+            }
+            // Everything queued so far is taken in one go, so busy periods cost one
+            // lock round trip per batch rather than per request.
+            while (!batch.empty()) {
+                batch.front()();
+                batch.pop_front();
+            }
+        }
+    }
+
+}    // namespace cvisa
@@ -0,0 +1,92 @@
+#ifndef CVISA_COMMAND_QUEUE_HPP
+#define CVISA_COMMAND_QUEUE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace cvisa {
+
+    /**
+     * @class CommandQueue
+     * @brief A single worker thread that executes submitted tasks in FIFO order.
+     *
+     * Each `VISACom` session owns one queue. Asynchronous requests are appended
+     * to the queue and executed one after another on the same worker thread,
+     * so requests from many caller threads never interleave on the bus and no
+     * thread is created per call. The worker is started lazily on the first
+     * submission.
+     */
+    class CommandQueue {
+      public:
+        CommandQueue();
+
+        /**
+         * @brief Destructor. Runs all pending tasks, then joins the worker.
+         *
+         * Must not run on the worker thread, i.e. from inside a task.
+         */
+        ~CommandQueue();
+
+        CommandQueue(const CommandQueue&)            = delete;
+        CommandQueue& operator=(const CommandQueue&) = delete;
+
+        /**
+         * @brief Appends a task to the queue.
+         *
+         * Tasks run in submission order. Exceptions thrown by a task are
+         * stored in the returned future.
+         *
+         * @tparam F A callable taking no arguments.
+         * @param task The task to run on the worker thread.
+         * @return A future holding the task's result.
+         */
+        template <typename F>
+        std::future<typename std::result_of<F()>::type> submit(F task) {
+            typedef typename std::result_of<F()>::type Result;
+            std::shared_ptr<std::packaged_task<Result()>> job = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+            std::future<Result>                           result = job->get_future();
+            enqueue([job]() { (*job)(); });
+            return result;
+        }
+
+        /**
+         * @brief Runs all pending tasks and stops the worker thread.
+         *
+         * The queue can be used again afterwards; the next submission starts a
+         * new worker. Submissions from other threads wait while the worker is
+         * being joined. Called from inside a task, it only asks the worker to
+         * exit once the queue drains; the next `stop()`, submission or the
+         * destructor joins it.
+         */
+        void stop();
+
+        /**
+         * @brief Returns the number of tasks waiting to be executed.
+         */
+        size_t pending() const;
+
+      private:
+        void enqueue(std::function<void()> job);
+        // Joins the stopping worker with `lock` released. Requires a joinable worker other than the caller.
+        void join(std::unique_lock<std::mutex>& lock);
+        void run();
+
+        mutable std::mutex                m_mutex;
+        std::condition_variable           m_wakeup;
+        std::condition_variable           m_joined;      // Signalled when a join finishes.
+        std::deque<std::function<void()>> m_jobs;
+        std::thread                       m_worker;
+        std::thread::id                   m_workerId;    // Kept while the worker is joined outside the lock.
+        bool                              m_stopping;    // The worker exits once the queue drains.
+        bool                              m_joining;     // A thread is joining the worker.
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_COMMAND_QUEUE_HPP
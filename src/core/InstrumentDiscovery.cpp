@@ -0,0 +1,170 @@
+#include "InstrumentDiscovery.hpp"
+
+#include "Exceptions.hpp"
+#include "ResponseParser.hpp"
+#include "VISACom.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+namespace cvisa {
+
+    namespace {
+        // The first line of a cache file; entries follow as "resource<TAB>identification".
+        const char* const s_cacheHeader = "# cvisa instrument cache";
+    }    // namespace
+
+    InstrumentDiscovery::InstrumentDiscovery() : m_probeTimeout_ms(500), m_parallelism(16) {
+        m_queries.push_back("GPIB?*INSTR");
+        m_queries.push_back("USB?*INSTR");
+        m_queries.push_back("TCPIP?*INSTR");
+        m_queries.push_back("TCPIP?*SOCKET");
+    }
+
+    void InstrumentDiscovery::setQueries(const std::vector<std::string>& queries) { m_queries = queries; }
+
+    std::vector<std::string> InstrumentDiscovery::enumerate(bool refresh) const {
+        // Every interface is enumerated on its own thread, so a slow bus does not delay the others.
+        std::vector<std::future<std::vector<std::string>>> lookups;
+        lookups.reserve(m_queries.size());
+        for (const auto& query : m_queries) {
+            lookups.push_back(std::async(std::launch::async, [query, refresh]() { return VISACom::findResources(query, refresh); }));
+        }
+
+        std::vector<std::string> resources;
+        for (auto& lookup : lookups) {
+            try {
+                std::vector<std::string> found = lookup.get();
+                resources.insert(resources.end(), found.begin(), found.end());
+            } catch (const VisaException&) {
+                // The interface is not present, or VISA support is not built in.
+            }
+        }
+        std::sort(resources.begin(), resources.end());
+        resources.erase(std::unique(resources.begin(), resources.end()), resources.end());
+        return resources;
+    }
+
+    std::map<std::string, std::string> InstrumentDiscovery::identify(const std::vector<std::string>& resources) {
+        std::map<std::string, std::string> instruments;
+        std::vector<std::string>           unresponsive;
+        std::exception_ptr                 firstError;    // The first failure that is not an unresponsive instrument.
+        std::mutex                         resultMutex;
+        std::atomic<size_t>                next(0);
+
+        auto worker = [&]() {
+            for (size_t index = next++; index < resources.size(); index = next++) {
+                const std::string& resourceName = resources[index];
+                std::string        identity;
+                // An exception escaping a probe thread would terminate the process.
+                try {
+                    identity = probe(resourceName);
+                } catch (const VisaException&) {
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    if (!firstError) firstError = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(resultMutex);
+                if (identity.empty()) {
+                    unresponsive.push_back(resourceName);
+                } else {
+                    instruments.insert(std::make_pair(identity, resourceName));
+                }
+            }
+        };
+
+        std::vector<std::thread> probes;
+        size_t                   count = std::min(m_parallelism, resources.size());
+        probes.reserve(count);
+        for (size_t i = 0; i < count; ++i) probes.push_back(std::thread(worker));
+        for (auto& probe : probes) probe.join();
+
+        std::sort(unresponsive.begin(), unresponsive.end());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_unresponsive.swap(unresponsive);
+        }
+        if (firstError) std::rethrow_exception(firstError);
+        return instruments;
+    }
+
+    std::map<std::string, std::string> InstrumentDiscovery::discover(bool refresh) {
+        std::map<std::string, std::string> instruments;
+        // An empty cache is more likely a rack that was powered off than an empty rack.
+        if (!refresh && loadCache(instruments) && !instruments.empty()) {
+            return instruments;
+        }
+        instruments = identify(enumerate(refresh));
+        saveCache(instruments);
+        return instruments;
+    }
+
+    std::vector<std::string> InstrumentDiscovery::unresponsive() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_unresponsive;
+    }
+
+    std::string InstrumentDiscovery::probe(const std::string& resourceName) const {
+        VISACom session;
+        if (m_transportFactory) {
+            std::unique_ptr<Transport> transport = m_transportFactory(resourceName);
+            if (transport) session.setTransport(std::move(transport));
+        }
+        session.setTimeout(m_probeTimeout_ms);
+        session.connect(resourceName);
+        std::string identity;
+        try {
+            identity = ResponseParser::trimmed(session.query("*IDN?"));
+            // A pooled session must not keep the probe timeout for the driver that takes it over.
+            session.getTransport()->resetConfiguration();
+        } catch (...) {
+            // Close rather than park a session that may still deliver a late response.
+            session.getTransport()->close();
+            throw;
+        }
+        return identity;
+    }
+
+    // --- Cache File ---
+
+    bool InstrumentDiscovery::loadCache(std::map<std::string, std::string>& instruments) const {
+        if (m_cachePath.empty()) return false;
+        std::ifstream file(m_cachePath.c_str());
+        std::string   line;
+        if (!file || !std::getline(file, line) || line != s_cacheHeader) return false;
+
+        instruments.clear();
+        while (std::getline(file, line)) {
+            size_t tab = line.find('\t');
+            if (tab == std::string::npos || tab == 0 || tab + 1 == line.size()) continue;
+            instruments[line.substr(tab + 1)] = line.substr(0, tab);
+        }
+        return true;
+    }
+
+    void InstrumentDiscovery::saveCache(const std::map<std::string, std::string>& instruments) const {
+        if (m_cachePath.empty()) return;
+
+        // Write a temporary file and rename it, so a crash never leaves a truncated cache.
+        std::string temporary = m_cachePath + ".tmp";
+        {
+            std::ofstream file(temporary.c_str(), std::ios::trunc);
+            file << s_cacheHeader << '\n';
+            for (const auto& instrument : instruments) {
+                file << instrument.second << '\t' << instrument.first << '\n';
+            }
+            if (!file.flush()) throw std::runtime_error("Cannot write instrument cache " + temporary);
+        }
+        std::remove(m_cachePath.c_str());
+        if (std::rename(temporary.c_str(), m_cachePath.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace instrument cache " + m_cachePath);
+        }
+    }
+
+}    // namespace cvisa
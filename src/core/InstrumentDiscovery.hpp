@@ -0,0 +1,142 @@
+#ifndef CVISA_INSTRUMENT_DISCOVERY_HPP
+#define CVISA_INSTRUMENT_DISCOVERY_HPP
+
+#include "Transport.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cvisa {
+
+    /**
+     * @class InstrumentDiscovery
+     * @brief Finds and identifies the instruments of a rack in parallel.
+     *
+     * Bringing up a rack one instrument at a time costs a full I/O timeout for
+     * every address that does not answer. `discover()` instead enumerates all
+     * interface types concurrently (one `VISACom::findResources()` per
+     * query), opens every resource on a pool of probe threads, and asks each
+     * one for `*IDN?` with a short probe timeout. The result maps each
+     * identification string to its resource.
+     *
+     * With a cache file, the result is persisted, and a warm restart returns
+     * the cached map without touching the bus. Pass `refresh = true` after
+     * recabling, or when connecting to a cached resource fails.
+     *
+     * @code
+     * cvisa::InstrumentDiscovery discovery;
+     * discovery.setCacheFile("rack.cache");
+     * std::map<std::string, std::string> rack = discovery.discover();
+     * for (const auto& instrument : rack) {
+     *     std::cout << instrument.first << " at " << instrument.second << std::endl;
+     * }
+     * @endcode
+     *
+     * Combine it with `VISACom::setSessionPoolSize()` to keep the probe
+     * sessions open for the drivers that connect afterwards. A probe session
+     * is parked with the transport's default timeout; one whose `*IDN?`
+     * failed or timed out is closed instead.
+     */
+    class InstrumentDiscovery {
+      public:
+        /**
+         * @brief Creates the transport for a probe. Null uses `connect()`'s default.
+         */
+        typedef std::function<std::unique_ptr<Transport>(const std::string& resourceName)> TransportFactory;
+
+        /**
+         * @brief Creates a discovery for GPIB, USB and TCPIP instruments.
+         */
+        InstrumentDiscovery();
+
+        /**
+         * @brief Sets the VISA resource expressions that are enumerated concurrently.
+         *
+         * Defaults to "GPIB?*INSTR", "USB?*INSTR", "TCPIP?*INSTR" and
+         * "TCPIP?*SOCKET". Serial ports are not probed by default, since a
+         * wrong baud rate looks like a silent instrument.
+         */
+        void setQueries(const std::vector<std::string>& queries);
+
+        /**
+         * @brief Sets the I/O timeout of a probe (default 500 ms).
+         */
+        void setProbeTimeout(unsigned int timeout_ms) { m_probeTimeout_ms = timeout_ms; }
+
+        /**
+         * @brief Sets the number of concurrent probes (default 16, at least 1).
+         */
+        void setParallelism(size_t probes) { m_parallelism = probes > 0 ? probes : 1; }
+
+        /**
+         * @brief Persists discovery results in `path`. An empty path disables the cache.
+         */
+        void setCacheFile(const std::string& path) { m_cachePath = path; }
+
+        /**
+         * @brief Makes probes use transports from `factory`, e.g. `SimulatedTransport`s.
+         */
+        void setTransportFactory(TransportFactory factory) { m_transportFactory = factory; }
+
+        /**
+         * @brief Enumerates the resources of all queries concurrently.
+         *
+         * A query whose interface is not present (or fails to enumerate) contributes no resources.
+         *
+         * @param refresh If true, bypasses `ResourceManager`'s discovery cache.
+         * @return The resources, sorted and without duplicates.
+         */
+        std::vector<std::string> enumerate(bool refresh = false) const;
+
+        /**
+         * @brief Opens the resources in parallel and reads their identification.
+         *
+         * Resources that cannot be opened or do not answer `*IDN?` within the
+         * probe timeout are listed by `unresponsive()`. So are resources whose
+         * probe fails with another exception (e.g., from the transport factory);
+         * the first such exception is rethrown once every probe has finished.
+         *
+         * @param resources The resources to probe.
+         * @return A map from identification string to resource.
+         */
+        std::map<std::string, std::string> identify(const std::vector<std::string>& resources);
+
+        /**
+         * @brief Returns the cached map, or enumerates and identifies the rack.
+         *
+         * @param refresh If true, ignores the cache file and rewrites it.
+         * @return A map from identification string to resource.
+         * @throws std::runtime_error if the cache file cannot be written.
+         */
+        std::map<std::string, std::string> discover(bool refresh = false);
+
+        /**
+         * @brief Returns the resources that did not answer during the last `identify()`.
+         */
+        std::vector<std::string> unresponsive() const;
+
+      private:
+        bool loadCache(std::map<std::string, std::string>& instruments) const;
+        void saveCache(const std::map<std::string, std::string>& instruments) const;
+
+        // Opens one resource and returns its trimmed `*IDN?` response. Closes the session if the query fails.
+        std::string probe(const std::string& resourceName) const;
+
+        std::vector<std::string> m_queries;
+        unsigned int             m_probeTimeout_ms;
+        size_t                   m_parallelism;
+        std::string              m_cachePath;
+        TransportFactory         m_transportFactory;
+
+        mutable std::mutex       m_mutex;
+        std::vector<std::string> m_unresponsive;
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_INSTRUMENT_DISCOVERY_HPP
@@ -0,0 +1,136 @@
+#include "InstrumentGroup.hpp"
+
+#include <algorithm>
+
+namespace cvisa {
+
+    // --- GroupReport ---
+
+    bool GroupReport::succeeded() const {
+        for (const auto& member : members) {
+            if (member.error) return false;
+        }
+        return true;
+    }
+
+    std::chrono::microseconds GroupReport::maxLatency() const {
+        std::chrono::microseconds latency(0);
+        for (const auto& member : members) latency = std::max(latency, member.latency);
+        return latency;
+    }
+
+    std::chrono::microseconds GroupReport::skew() const {
+        if (members.empty()) return std::chrono::microseconds(0);
+        std::chrono::microseconds first = members.front().latency;
+        std::chrono::microseconds last  = first;
+        for (const auto& member : members) {
+            first = std::min(first, member.latency);
+            last  = std::max(last, member.latency);
+        }
+        return last - first;
+    }
+
+    void GroupReport::rethrowFirstError() const {
+        for (const auto& member : members) {
+            if (member.error) std::rethrow_exception(member.error);
+        }
+    }
+
+    // --- InstrumentGroup ---
+
+    InstrumentGroup::InstrumentGroup() : m_generation(0), m_pending(0), m_stopping(false), m_task(nullptr), m_report(nullptr), m_armed(0), m_released(0) {}
+
+    InstrumentGroup::~InstrumentGroup() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeup.notify_all();
+        for (auto& lane : m_lanes) lane->thread.join();
+    }
+
+    size_t InstrumentGroup::add(drivers::SCPIBase& instrument) {
+        std::lock_guard<std::mutex> runLock(m_runMutex);
+        std::unique_ptr<Lane>       lane(new Lane());
+        lane->instrument = &instrument;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t                      index = m_lanes.size();
+        lane->thread                      = std::thread(&InstrumentGroup::runLane, this, index, m_generation);
+        m_lanes.push_back(std::move(lane));
+        return index;
+    }
+
+    size_t InstrumentGroup::size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lanes.size();
+    }
+
+    drivers::SCPIBase& InstrumentGroup::at(size_t index) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (index >= m_lanes.size()) throw std::out_of_range("InstrumentGroup: member index out of range.");
+        return *m_lanes[index]->instrument;
+    }
+
+    GroupReport InstrumentGroup::trigger() {
+        std::lock_guard<std::mutex> lock(m_runMutex);
+        return run([this](size_t index) { m_lanes[index]->instrument->assertTrigger(); });
+    }
+
+    GroupReport InstrumentGroup::run(const std::function<void(size_t index)>& task) {
+        GroupReport report;
+        size_t      count = m_lanes.size();
+        report.members.resize(count);
+        if (count == 0) return report;
+
+        unsigned int generation;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task    = &task;
+            m_report  = &report;
+            m_pending = count;
+            m_armed.store(0);
+            generation = ++m_generation;
+        }
+        m_wakeup.notify_all();
+
+        // Release only once every lane is awake, so no member pays for another's
+        // wake-up latency.
+        while (m_armed.load(std::memory_order_acquire) < count) std::this_thread::yield();
+        m_releaseTime = std::chrono::steady_clock::now();
+        m_released.store(generation, std::memory_order_release);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_pending == 0; });
+        m_task   = nullptr;
+        m_report = nullptr;
+        return report;
+    }
+
+    void InstrumentGroup::runLane(size_t index, unsigned int generation) {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeup.wait(lock, [this, generation]() { return m_stopping || m_generation != generation; });
+                if (m_stopping) return;
+                generation = m_generation;
+            }
+
+            m_armed.fetch_add(1, std::memory_order_acq_rel);
+            while (m_released.load(std::memory_order_acquire) != generation) std::this_thread::yield();
+
+            GroupMemberReport& member = m_report->members[index];
+            member.start              = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_releaseTime);
+            try {
+                (*m_task)(index);
+            } catch (...) {
+                member.error = std::current_exception();
+            }
+            member.latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_releaseTime);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0) m_done.notify_all();
+        }
+    }
+
+}    // namespace cvisa
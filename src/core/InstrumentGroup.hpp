@@ -0,0 +1,172 @@
+#ifndef CVISA_INSTRUMENT_GROUP_HPP
+#define CVISA_INSTRUMENT_GROUP_HPP
+
+#include "SCPIBase.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace cvisa {
+
+    /**
+     * @brief The outcome of a group operation on one member.
+     *
+     * Times are measured from the moment all members were released.
+     */
+    struct GroupMemberReport {
+        std::chrono::microseconds start;      // Until the member's task started.
+        std::chrono::microseconds latency;    // Until the member's task finished.
+        std::exception_ptr        error;      // The task's exception, if it threw.
+    };
+
+    /**
+     * @brief The outcome of a group operation, one entry per member in member order.
+     */
+    struct GroupReport {
+        std::vector<GroupMemberReport> members;
+
+        /// @return True if no member's task threw.
+        bool succeeded() const;
+
+        /// @return The latency of the slowest member.
+        std::chrono::microseconds maxLatency() const;
+
+        /// @return The spread between the first and the last member to finish.
+        std::chrono::microseconds skew() const;
+
+        /**
+         * @brief Rethrows the exception of the first member that failed, if any.
+         */
+        void rethrowFirstError() const;
+    };
+
+    /**
+     * @class InstrumentGroup
+     * @brief Applies the same operation to several instruments at the same moment.
+     *
+     * Every member has a dedicated thread. A group operation first wakes all of
+     * them, waits until each one is ready to run, and then releases them
+     * together, so the operation starts on every member within microseconds
+     * instead of one after the other. Each call waits for all members and
+     * reports every member's start time, latency and error.
+     *
+     * The usual pattern stages a value on all members in parallel and then
+     * applies it with a trigger, which keeps the skew down to the trigger's own
+     * latency:
+     *
+     * @code
+     * cvisa::InstrumentGroup group;
+     * for (auto& psu : supplies) group.add(psu);
+     *
+     * group.broadcast<Agilent66xxA>([](Agilent66xxA& psu) {
+     *     psu.setTriggerSourceBus();
+     *     psu.setTriggeredVoltage(12.0);
+     *     psu.initiate();
+     * }).rethrowFirstError();
+     * cvisa::GroupReport report = group.trigger();    // GPIB GET to every member.
+     * @endcode
+     *
+     * The group does not own its members, which must outlive it. Members stay
+     * usable from other threads; their session locks serialize the traffic.
+     * Group operations are serialized, and `add()` waits for a running one.
+     */
+    class InstrumentGroup {
+      public:
+        InstrumentGroup();
+
+        /**
+         * @brief Destructor. Joins the member threads.
+         */
+        ~InstrumentGroup();
+
+        InstrumentGroup(const InstrumentGroup&)            = delete;
+        InstrumentGroup& operator=(const InstrumentGroup&) = delete;
+
+        /**
+         * @brief Adds a member.
+         * @param instrument The driver to add. Must outlive the group.
+         * @return The index of the new member.
+         */
+        size_t add(drivers::SCPIBase& instrument);
+
+        /**
+         * @brief Returns the number of members.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Returns the member at `index`.
+         * @throws std::out_of_range if `index` is invalid.
+         */
+        drivers::SCPIBase& at(size_t index);
+
+        /**
+         * @brief Runs `task` on every member at the same moment and waits for all of them.
+         *
+         * A failing member does not stop the others; its exception is reported
+         * in its `GroupMemberReport`.
+         *
+         * @tparam Driver The type the members are accessed as. Defaults to `SCPIBase`.
+         * @tparam F A callable taking a `Driver&`.
+         * @param task The task to run on each member.
+         * @return The per-member report.
+         * @throws std::invalid_argument if a member is not a `Driver`.
+         */
+        template <typename Driver = drivers::SCPIBase, typename F>
+        GroupReport broadcast(F task) {
+            std::lock_guard<std::mutex> lock(m_runMutex);
+            std::vector<Driver*>        drivers;
+            drivers.reserve(m_lanes.size());
+            for (const auto& lane : m_lanes) {
+                Driver* driver = dynamic_cast<Driver*>(lane->instrument);
+                if (!driver) throw std::invalid_argument("InstrumentGroup: member instrument is not of the requested driver type.");
+                drivers.push_back(driver);
+            }
+            return run([&drivers, &task](size_t index) { task(*drivers[index]); });
+        }
+
+        /**
+         * @brief Sends a bus trigger (`VISACom::assertTrigger()`) to every member at the same moment.
+         * @return The per-member report.
+         */
+        GroupReport trigger();
+
+      private:
+        struct Lane {
+            drivers::SCPIBase* instrument;
+            std::thread        thread;
+        };
+
+        // Releases all lanes on `task` and waits for them. Requires `m_runMutex`.
+        GroupReport run(const std::function<void(size_t index)>& task);
+        void        runLane(size_t index, unsigned int generation);
+
+        std::mutex                         m_runMutex;    // Serializes group operations and `add()`.
+        mutable std::mutex                 m_mutex;
+        std::condition_variable            m_wakeup;
+        std::condition_variable            m_done;
+        std::vector<std::unique_ptr<Lane>> m_lanes;
+        unsigned int                       m_generation;    // Incremented to wake the lanes for an operation.
+        size_t                             m_pending;       // Lanes still running the current operation.
+        bool                               m_stopping;
+
+        // The current operation; set before the lanes are woken.
+        const std::function<void(size_t)>*    m_task;
+        GroupReport*                          m_report;
+        std::atomic<size_t>                   m_armed;       // Lanes waiting for the release.
+        std::atomic<unsigned int>             m_released;    // The generation that may run.
+        std::chrono::steady_clock::time_point m_releaseTime;
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_INSTRUMENT_GROUP_HPP
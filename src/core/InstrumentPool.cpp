@@ -0,0 +1,91 @@
+#include "InstrumentPool.hpp"
+
+#include <utility>
+
+namespace cvisa {
+
+    InstrumentPool::InstrumentPool(size_t workerCount) : m_outstanding(0), m_stopping(false) {
+        if (workerCount == 0) workerCount = 1;
+        m_workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i) {
+            m_workers.push_back(std::thread(&InstrumentPool::run, this));
+        }
+    }
+
+    InstrumentPool::~InstrumentPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeup.notify_all();
+        for (auto& worker : m_workers) worker.join();
+    }
+
+    size_t InstrumentPool::add(std::unique_ptr<drivers::SCPIBase> instrument) {
+        if (!instrument) throw std::invalid_argument("InstrumentPool: cannot add a null instrument.");
+        std::unique_ptr<Member> member(new Member());
+        member->instrument = std::move(instrument);
+        member->scheduled  = false;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_members.push_back(std::move(member));
+        return m_members.size() - 1;
+    }
+
+    size_t InstrumentPool::size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_members.size();
+    }
+
+    drivers::SCPIBase& InstrumentPool::at(size_t index) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (index >= m_members.size()) throw std::out_of_range("InstrumentPool: member index out of range.");
+        return *m_members[index]->instrument;
+    }
+
+    void InstrumentPool::wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this]() { return m_outstanding == 0; });
+    }
+
+    void InstrumentPool::enqueue(size_t index, std::function<void()> job) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (index >= m_members.size()) throw std::out_of_range("InstrumentPool: member index out of range.");
+        Member& member = *m_members[index];
+        member.tasks.push_back(std::move(job));
+        ++m_outstanding;
+        if (!member.scheduled) {
+            member.scheduled = true;
+            m_ready.push_back(&member);
+            m_wakeup.notify_one();
+        }
+    }
+
+    void InstrumentPool::run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wakeup.wait(lock, [this]() { return m_stopping || !m_ready.empty(); });
+            if (m_ready.empty()) return;    // Stopping and fully drained.
+
+            // A member stays off the ready list while one of its tasks runs, which is
+            // what keeps each instrument's tasks ordered and non-overlapping.
+            Member* member = m_ready.front();
+            m_ready.pop_front();
+            std::function<void()> job = std::move(member->tasks.front());
+            member->tasks.pop_front();
+
+            lock.unlock();
+            job();
+            lock.lock();
+
+            // Round-robin: one task per turn, so a busy instrument cannot starve the others.
+            if (member->tasks.empty()) {
+                member->scheduled = false;
+            } else {
+                m_ready.push_back(member);
+                m_wakeup.notify_one();
+            }
+            if (--m_outstanding == 0) m_idle.notify_all();
+        }
+    }
+
+}    // namespace cvisa
@@ -0,0 +1,204 @@
+#ifndef CVISA_INSTRUMENT_POOL_HPP
+#define CVISA_INSTRUMENT_POOL_HPP
+
+#include "SCPIBase.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cvisa {
+
+    /**
+     * @class InstrumentPool
+     * @brief Owns a set of instrument drivers and services them in parallel.
+     *
+     * The pool runs a small, fixed number of worker threads. Every member
+     * instrument has its own task queue (a "strand"): tasks submitted to the
+     * same instrument execute strictly in submission order and never
+     * concurrently, while tasks for different instruments are spread over the
+     * workers and run at the same time. This lets a single process drive many
+     * instruments on different GPIB boards or LAN hosts without servicing them
+     * one after the other.
+     *
+     * @code
+     * cvisa::InstrumentPool pool(4);
+     * pool.emplace<cvisa::drivers::Agilent66xxA>("GPIB0::5::INSTR");
+     * pool.emplace<cvisa::drivers::Agilent66xxA>("GPIB1::5::INSTR");
+     *
+     * auto futures  = pool.forEach<cvisa::drivers::Agilent66xxA>([](cvisa::drivers::Agilent66xxA& psu) { return psu.measureVoltage(); });
+     * auto voltages = cvisa::InstrumentPool::collect(futures);
+     * @endcode
+     */
+    class InstrumentPool {
+      public:
+        /**
+         * @brief Constructs a pool with the given number of worker threads.
+         * @param workerCount The number of worker threads (at least one).
+         */
+        explicit InstrumentPool(size_t workerCount = 4);
+
+        /**
+         * @brief Destructor. Runs all pending tasks, joins the workers and then
+         * destroys the member instruments.
+         */
+        ~InstrumentPool();
+
+        InstrumentPool(const InstrumentPool&)            = delete;
+        InstrumentPool& operator=(const InstrumentPool&) = delete;
+
+        /**
+         * @brief Adds an instrument to the pool, taking ownership of it.
+         * @param instrument The driver to add.
+         * @return The index of the new member.
+         */
+        size_t add(std::unique_ptr<drivers::SCPIBase> instrument);
+
+        /**
+         * @brief Constructs a driver in place and adds it to the pool.
+         * @tparam Driver The driver type (e.g., `drivers::Agilent66xxA`).
+         * @param args The driver's constructor arguments.
+         * @return A reference to the new driver, owned by the pool.
+         */
+        template <typename Driver, typename... Args>
+        Driver& emplace(Args&&... args) {
+            Driver* driver = new Driver(std::forward<Args>(args)...);
+            add(std::unique_ptr<drivers::SCPIBase>(driver));
+            return *driver;
+        }
+
+        /**
+         * @brief Returns the number of member instruments.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Returns the member instrument at `index`.
+         *
+         * Calling the instrument directly bypasses its strand; prefer
+         * `submit()` while tasks may be pending.
+         */
+        drivers::SCPIBase& at(size_t index);
+
+        /**
+         * @brief Returns the indices of all members whose type is `Driver`.
+         */
+        template <typename Driver>
+        std::vector<size_t> indicesOf() const {
+            std::vector<size_t>         indices;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < m_members.size(); ++i) {
+                if (dynamic_cast<Driver*>(m_members[i]->instrument.get())) indices.push_back(i);
+            }
+            return indices;
+        }
+
+        /**
+         * @brief Queues a task on one member's strand.
+         *
+         * @tparam Driver The type the member is accessed as. Defaults to `SCPIBase`.
+         * @tparam F A callable taking a `Driver&`.
+         * @param index The member index.
+         * @param task The task to run.
+         * @return A future holding the task's result or exception.
+         * @throws std::out_of_range if `index` is invalid.
+         * @throws std::invalid_argument if the member is not a `Driver`.
+         */
+        template <typename Driver = drivers::SCPIBase, typename F>
+        std::future<typename std::result_of<F(Driver&)>::type> submit(size_t index, F task) {
+            typedef typename std::result_of<F(Driver&)>::type Result;
+            Driver* driver = dynamic_cast<Driver*>(&at(index));
+            if (!driver) throw std::invalid_argument("InstrumentPool: member instrument is not of the requested driver type.");
+            std::shared_ptr<std::packaged_task<Result()>> job    = std::make_shared<std::packaged_task<Result()>>(std::bind(std::move(task), std::ref(*driver)));
+            std::future<Result>                           result = job->get_future();
+            enqueue(index, [job]() { (*job)(); });
+            return result;
+        }
+
+        /**
+         * @brief Queues the same task on every member of type `Driver`.
+         *
+         * The returned futures are ordered like `indicesOf<Driver>()`.
+         *
+         * @tparam Driver The driver type the task applies to.
+         * @tparam F A callable taking a `Driver&`.
+         * @param task The task to run on each matching member.
+         * @return One future per matching member.
+         */
+        template <typename Driver, typename F>
+        std::vector<std::future<typename std::result_of<F(Driver&)>::type>> forEach(F task) {
+            return forEach<Driver>(indicesOf<Driver>(), task);
+        }
+
+        /**
+         * @brief Queues the same task on a selection of members.
+         * @param indices The members to run the task on.
+         * @param task The task to run on each member.
+         * @return One future per index, in the same order.
+         */
+        template <typename Driver, typename F>
+        std::vector<std::future<typename std::result_of<F(Driver&)>::type>> forEach(const std::vector<size_t>& indices, F task) {
+            std::vector<std::future<typename std::result_of<F(Driver&)>::type>> results;
+            results.reserve(indices.size());
+            for (size_t index : indices) results.push_back(submit<Driver>(index, task));
+            return results;
+        }
+
+        /**
+         * @brief Waits for a set of futures and returns their values in order.
+         *
+         * If a task failed, its exception is rethrown once every future has completed.
+         */
+        template <typename T>
+        static std::vector<T> collect(std::vector<std::future<T>>& futures) {
+            std::vector<T>     values;
+            std::exception_ptr failure;
+            values.reserve(futures.size());
+            for (auto& future : futures) {
+                try {
+                    values.push_back(future.get());
+                } catch (...) {
+                    if (!failure) failure = std::current_exception();
+                    values.push_back(T());
+                }
+            }
+            if (failure) std::rethrow_exception(failure);
+            return values;
+        }
+
+        /**
+         * @brief Blocks until every queued task has finished.
+         */
+        void wait();
+
+      private:
+        struct Member {
+            std::unique_ptr<drivers::SCPIBase> instrument;
+            std::deque<std::function<void()>>  tasks;
+            bool                               scheduled;    // Queued as ready or currently executing.
+        };
+
+        void enqueue(size_t index, std::function<void()> job);
+        void run();
+
+        mutable std::mutex                   m_mutex;
+        std::condition_variable              m_wakeup;
+        std::condition_variable              m_idle;
+        std::vector<std::unique_ptr<Member>> m_members;
+        std::deque<Member*>                  m_ready;
+        std::vector<std::thread>             m_workers;
+        size_t                               m_outstanding;    // Tasks queued or executing.
+        bool                                 m_stopping;
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_INSTRUMENT_POOL_HPP
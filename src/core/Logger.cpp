@@ -0,0 +1,395 @@
+#include "Logger.hpp"
+
+#include "../utils/utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cvisa {
+
+    namespace {
+
+        // Record payload limits. Together with the header, a record is about 512 bytes.
+        const size_t s_maxResourceLength = 64;
+        const size_t s_maxMessageLength  = 424;
+
+        // Upper bound on records formatted per batch, so sinks are flushed regularly under load.
+        const size_t s_maxBatchRecords = 256;
+
+        // Idle consumer wake-up interval; bounds the latency of a missed notification.
+        const std::chrono::milliseconds s_idleWait(50);
+
+        const char* levelToString(LogLevel level) {
+            switch (level) {
+                case LogLevel::ERROR:
+                    return "ERROR  ";
+                case LogLevel::WARNING:
+                    return "WARNING";
+                case LogLevel::INFO:
+                    return "INFO   ";
+                case LogLevel::DEBUG:
+                    return "DEBUG  ";
+                default:
+                    return "UNKNOWN";
+            }
+        }
+
+        // Formats log lines ("[HH:MM:SS.mmm] [LEVEL  ] [resource] message"), converting
+        // the time to local time at most once per second.
+        class LineFormatter {
+          public:
+            LineFormatter() : m_second(static_cast<std::time_t>(-1)) { m_stamp[0] = '\0'; }
+
+            void append(std::string& out, std::chrono::system_clock::time_point time, LogLevel level, const char* resource, size_t resourceLength,
+                        const char* message, size_t messageLength, bool truncated) {
+                std::time_t second = std::chrono::system_clock::to_time_t(time);
+                if (second != m_second) {
+                    std::tm local;
+#ifdef _WIN32
+                    localtime_s(&local, &second);
+#else
+                    localtime_r(&second, &local);
+#endif
+                    std::snprintf(m_stamp, sizeof(m_stamp), "%02d:%02d:%02d", local.tm_hour, local.tm_min, local.tm_sec);
+                    m_second = second;
+                }
+                long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+                char      millis[4] = {static_cast<char>('0' + ms / 100), static_cast<char>('0' + ms / 10 % 10), static_cast<char>('0' + ms % 10), '\0'};
+
+                out.push_back('[');
+                out.append(m_stamp);
+                out.push_back('.');
+                out.append(millis, 3);
+                out.append("] [");
+                out.append(levelToString(level));
+                out.append("] [");
+                if (resourceLength == 0) {
+                    out.append("cvisa");
+                } else {
+                    out.append(resource, resourceLength);
+                }
+                out.append("] ");
+                out.append(message, messageLength);
+                if (truncated) {
+                    out.append("...");
+                }
+                out.push_back('\n');
+            }
+
+          private:
+            std::time_t m_second;       // The second `m_stamp` was formatted for.
+            char        m_stamp[16];    // "HH:MM:SS" of `m_second`.
+        };
+
+        // A fixed-size log record; messages are copied in, never allocated.
+        struct Record {
+            std::chrono::system_clock::time_point time;
+            LogLevel                              level;
+            bool                                  truncated;
+            uint16_t                              resourceLength;
+            uint16_t                              messageLength;
+            char                                  resource[s_maxResourceLength];
+            char                                  message[s_maxMessageLength];
+        };
+
+        class AsyncBackend;
+
+        struct LoggerState {
+            std::mutex                    sinkMutex;    // Guards `sinks` and the streams themselves.
+            std::vector<std::ostream*>    sinks;
+            std::atomic<size_t>           sinkCount{0};
+            std::mutex                    controlMutex;    // Serializes enabling, disabling and flushing.
+            std::unique_ptr<AsyncBackend> backend;         // Owner of the asynchronous backend.
+            std::atomic<AsyncBackend*>    async{nullptr};    // Fast-path view of `backend`.
+            std::atomic<unsigned>         activeProducers{0};
+            std::atomic<uint64_t>         dropped{0};
+
+            ~LoggerState();
+        };
+
+        // Function-local static: safe to use from other static initializers and defined exactly once.
+        LoggerState& state() {
+            static LoggerState s_state;
+            return s_state;
+        }
+
+        void writeToSinks(const std::string& text) {
+            LoggerState&                s = state();
+            std::lock_guard<std::mutex> lock(s.sinkMutex);
+            for (auto* stream : s.sinks) {
+                stream->write(text.data(), static_cast<std::streamsize>(text.size()));
+                stream->flush();
+            }
+        }
+
+        /**
+         * Bounded multi-producer, single-consumer ring of `Record`s (after D. Vyukov's
+         * bounded queue). Each cell carries a sequence number: producers claim a
+         * slot with one CAS on the enqueue position and publish it by advancing
+         * the cell's sequence; the consumer thread owns the dequeue position.
+         */
+        class AsyncBackend {
+          public:
+            explicit AsyncBackend(size_t capacity)
+                : m_capacity(roundUpToPowerOfTwo(capacity)),
+                  m_mask(m_capacity - 1),
+                  m_cells(new Cell[m_capacity]),
+                  m_enqueuePos(0),
+                  m_dequeuePos(0),
+                  m_processed(0),
+                  m_stop(false),
+                  m_sleeping(false) {
+                for (size_t i = 0; i < m_capacity; ++i) {
+                    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+                m_thread = std::thread(&AsyncBackend::run, this);
+            }
+
+            // Writes all published records, then stops the consumer.
+            ~AsyncBackend() {
+                {
+                    std::lock_guard<std::mutex> lock(m_wakeMutex);
+                    m_stop = true;
+                }
+                m_wake.notify_one();
+                m_thread.join();
+            }
+
+            AsyncBackend(const AsyncBackend&)            = delete;
+            AsyncBackend& operator=(const AsyncBackend&) = delete;
+
+            // Copies a message into the ring. Returns false if the ring is full.
+            bool push(LogLevel level, const std::string& resourceName, const std::string& message) {
+                size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+                Cell*  cell;
+                for (;;) {
+                    cell            = &m_cells[pos & m_mask];
+                    size_t   seq    = cell->sequence.load(std::memory_order_acquire);
+                    intptr_t diff   = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                    if (diff == 0) {
+                        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    } else if (diff < 0) {
+                        return false;
+                    } else {
+                        pos = m_enqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+
+                Record& record        = cell->record;
+                record.time           = std::chrono::system_clock::now();
+                record.level          = level;
+                record.resourceLength = static_cast<uint16_t>(std::min(resourceName.size(), s_maxResourceLength));
+                record.messageLength  = static_cast<uint16_t>(std::min(message.size(), s_maxMessageLength));
+                record.truncated      = message.size() > s_maxMessageLength;
+                std::memcpy(record.resource, resourceName.data(), record.resourceLength);
+                std::memcpy(record.message, message.data(), record.messageLength);
+                cell->sequence.store(pos + 1, std::memory_order_release);
+
+                if (m_sleeping.load(std::memory_order_acquire)) {
+                    m_wake.notify_one();
+                }
+                return true;
+            }
+
+            // Blocks until every record enqueued before the call has been written.
+            void flush() {
+                size_t                       target = m_enqueuePos.load(std::memory_order_acquire);
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.notify_one();
+                m_flushed.wait(lock, [this, target]() { return m_processed >= target; });
+            }
+
+          private:
+            struct Cell {
+                std::atomic<size_t> sequence;
+                Record              record;
+            };
+
+            static size_t roundUpToPowerOfTwo(size_t value) {
+                size_t result = 2;
+                while (result < value) {
+                    result <<= 1;
+                }
+                return result;
+            }
+
+            bool hasPending() const { return m_cells[m_dequeuePos & m_mask].sequence.load(std::memory_order_acquire) == m_dequeuePos + 1; }
+
+            // Formats the next record into `out`. Returns false if the ring is empty.
+            bool pop(std::string& out, LineFormatter& formatter) {
+                Cell& cell = m_cells[m_dequeuePos & m_mask];
+                if (cell.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+                    return false;
+                }
+                const Record& r = cell.record;
+                formatter.append(out, r.time, r.level, r.resource, r.resourceLength, r.message, r.messageLength, r.truncated);
+                cell.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+                ++m_dequeuePos;
+                return true;
+            }
+
+            void run() {
+                std::string   batch;
+                LineFormatter formatter;
+                uint64_t      reportedDrops = state().dropped.load(std::memory_order_relaxed);
+                batch.reserve(s_maxBatchRecords * 128);
+
+                for (;;) {
+                    size_t count = 0;
+                    while (count < s_maxBatchRecords && pop(batch, formatter)) {
+                        ++count;
+                    }
+
+                    uint64_t drops = state().dropped.load(std::memory_order_relaxed);
+                    if (drops != reportedDrops) {
+                        std::string notice = utils::to_string(drops - reportedDrops) + " log records dropped (ring buffer full).";
+                        formatter.append(batch, std::chrono::system_clock::now(), LogLevel::WARNING, "", 0, notice.data(), notice.size(), false);
+                        reportedDrops = drops;
+                    }
+                    if (!batch.empty()) {
+                        writeToSinks(batch);
+                        batch.clear();
+                    }
+
+                    std::unique_lock<std::mutex> lock(m_wakeMutex);
+                    m_processed = m_dequeuePos;
+                    m_flushed.notify_all();
+                    if (count > 0) {
+                        continue;
+                    }
+                    if (m_stop) {
+                        if (!hasPending()) {
+                            return;
+                        }
+                        continue;
+                    }
+                    m_sleeping.store(true, std::memory_order_release);
+                    m_wake.wait_for(lock, s_idleWait, [this]() { return m_stop || hasPending(); });
+                    m_sleeping.store(false, std::memory_order_relaxed);
+                }
+            }
+
+            const size_t            m_capacity;
+            const size_t            m_mask;
+            std::unique_ptr<Cell[]> m_cells;
+            std::atomic<size_t>     m_enqueuePos;    // Next slot claimed by a producer.
+            size_t                  m_dequeuePos;    // Next slot read by the consumer (consumer thread only).
+            size_t                  m_processed;     // Records written to the sinks (guarded by `m_wakeMutex`).
+
+            std::mutex              m_wakeMutex;
+            std::condition_variable m_wake;       // Wakes the idle consumer.
+            std::condition_variable m_flushed;    // Signals progress to `flush()`.
+            bool                    m_stop;       // Guarded by `m_wakeMutex`.
+            std::atomic<bool>       m_sleeping;   // The consumer is waiting for records.
+            std::thread             m_thread;
+        };
+
+        LoggerState::~LoggerState() {
+            // Write pending records while the sinks are still registered.
+            async.store(nullptr);
+            backend.reset();
+        }
+
+    }    // namespace
+
+    void Logger::setOutputStream(std::ostream* stream) {
+        clearSinks();
+        if (stream) {
+            addSink(*stream);
+        }
+    }
+
+    void Logger::addSink(std::ostream& stream) {
+        LoggerState&                s = state();
+        std::lock_guard<std::mutex> lock(s.sinkMutex);
+        s.sinks.push_back(&stream);
+        s.sinkCount.store(s.sinks.size());
+    }
+
+    void Logger::clearSinks() {
+        flush();
+        LoggerState&                s = state();
+        std::lock_guard<std::mutex> lock(s.sinkMutex);
+        s.sinks.clear();
+        s.sinkCount.store(0);
+    }
+
+    void Logger::enableAsync(size_t capacity) {
+        LoggerState&                s = state();
+        std::lock_guard<std::mutex> lock(s.controlMutex);
+        if (s.backend) {
+            return;
+        }
+        s.backend.reset(new AsyncBackend(capacity));
+        s.async.store(s.backend.get());
+    }
+
+    void Logger::disableAsync() {
+        LoggerState&                s = state();
+        std::lock_guard<std::mutex> lock(s.controlMutex);
+        if (!s.backend) {
+            return;
+        }
+        // Unpublish the backend, then wait for producers that may still be using it.
+        s.async.store(nullptr);
+        while (s.activeProducers.load() != 0) {
+            std::this_thread::yield();
+        }
+        s.backend.reset();
+    }
+
+    bool Logger::hasSinks() { return state().sinkCount.load(std::memory_order_relaxed) != 0; }
+
+    bool Logger::isAsync() { return state().async.load() != nullptr; }
+
+    void Logger::flush() {
+        LoggerState&                s = state();
+        std::lock_guard<std::mutex> lock(s.controlMutex);
+        if (s.backend) {
+            s.backend->flush();
+            return;
+        }
+        std::lock_guard<std::mutex> sinkLock(s.sinkMutex);
+        for (auto* stream : s.sinks) {
+            stream->flush();
+        }
+    }
+
+    uint64_t Logger::droppedRecords() { return state().dropped.load(std::memory_order_relaxed); }
+
+    void Logger::write(LogLevel level, const std::string& resourceName, const std::string& message) {
+        LoggerState& s = state();
+        if (s.sinkCount.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+
+        s.activeProducers.fetch_add(1);
+        AsyncBackend* backend = s.async.load();
+        if (backend != nullptr) {
+            if (!backend->push(level, resourceName, message)) {
+                s.dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            s.activeProducers.fetch_sub(1);
+            return;
+        }
+        s.activeProducers.fetch_sub(1);
+
+        std::string   line;
+        LineFormatter formatter;
+        line.reserve(resourceName.size() + message.size() + 32);
+        formatter.append(line, std::chrono::system_clock::now(), level, resourceName.data(), resourceName.size(), message.data(), message.size(), false);
+        writeToSinks(line);
+    }
+
+}    // namespace cvisa
@@ -1,13 +1,39 @@
 #ifndef CVISA_LOGGER_HPP
 #define CVISA_LOGGER_HPP
 
-#include <algorithm>
-#include <chrono>
-#include <iomanip>
-#include <iostream>
-#include <sstream>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
 #include <string>
-#include <vector>
+
+// Numeric log levels for `CVISA_LOG_COMPILE_LEVEL` (they match `LogLevel`).
+#define CVISA_LOG_LEVEL_NONE 0
+#define CVISA_LOG_LEVEL_ERROR 1
+#define CVISA_LOG_LEVEL_WARNING 2
+#define CVISA_LOG_LEVEL_INFO 3
+#define CVISA_LOG_LEVEL_DEBUG 4
+
+// The most verbose level compiled into the library. `CVISA_LOG` statements for
+// more verbose levels are removed by the compiler. The CMake build sets
+// CVISA_LOG_LEVEL_WARNING for Release and MinSizeRel builds.
+#ifndef CVISA_LOG_COMPILE_LEVEL
+#define CVISA_LOG_COMPILE_LEVEL CVISA_LOG_LEVEL_DEBUG
+#endif
+
+/**
+ * @brief Logs a message, evaluating the message expression only if it will be written.
+ *
+ * Prefer this over calling `Logger::log()` directly: in
+ * `CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Read " + n + " bytes")`
+ * the concatenation only runs if DEBUG is compiled in, enabled for the
+ * instance and at least one sink is registered.
+ */
+#define CVISA_LOG(activeLevel, messageLevel, resourceName, message)                      \
+    do {                                                                                 \
+        if (::cvisa::Logger::isEnabled((activeLevel), (messageLevel))) {                 \
+            ::cvisa::Logger::log((activeLevel), (messageLevel), (resourceName), (message)); \
+        }                                                                                \
+    } while (0)
 
 namespace cvisa {
 
@@ -20,30 +46,43 @@ namespace cvisa {
         DEBUG       // Debug-level messages and everything else
     };
 
+    /**
+     * @class Logger
+     * @brief Process-wide logger with synchronous and asynchronous modes.
+     *
+     * By default, `log()` formats the message and writes it to every sink on
+     * the calling thread. Sinks are guarded by a mutex, so concurrent sessions
+     * never interleave partial lines.
+     *
+     * In asynchronous mode (`enableAsync()`), `log()` only copies the message
+     * into a pre-allocated record of a bounded, lock-free ring buffer. A
+     * background thread formats the records and writes them to the sinks in
+     * batches, flushing once per batch. If the ring is full, the record is
+     * dropped rather than blocking the caller, and the drop is counted
+     * (`droppedRecords()`) and reported in the log. Messages longer than a
+     * record are truncated.
+     */
     class Logger {
       public:
         /**
          * @brief Sets the output stream, clearing all other sinks.
          * @param stream A pointer to the desired output stream (e.g., &std::cout,
-         * &myfile). Defaults to &std::cerr.
+         * &myfile). Pass nullptr to disable output.
          */
-        static void setOutputStream(std::ostream* stream) {
-            clearSinks();
-            if (stream) {
-                addSink(*stream);
-            }
-        }
+        static void setOutputStream(std::ostream* stream);
 
         /**
          * @brief Adds an output stream to the list of logging sinks.
-         * @param stream A reference to the output stream.
+         * @param stream A reference to the output stream. It must outlive its registration.
          */
-        static void addSink(std::ostream& stream) { s_outputStreams.push_back(&stream); }
+        static void addSink(std::ostream& stream);
 
         /**
          * @brief Clears all registered logging sinks.
+         *
+         * In asynchronous mode, pending records are written first.
          */
-        static void clearSinks() { s_outputStreams.clear(); }
+        static void clearSinks();
 
         /**
          * @brief Logs a formatted message if the level is appropriate.
@@ -53,58 +92,60 @@ namespace cvisa {
          * @param message The message to log.
          */
         static void log(LogLevel activeLevel, LogLevel messageLevel, const std::string& resourceName, const std::string& message) {
-            if (!s_outputStreams.empty() && activeLevel >= messageLevel && messageLevel != LogLevel::NONE) {
-                std::stringstream full_message;
-                full_message << "[" << getCurrentTimestamp() << "] " << "[" << levelToString(messageLevel) << "] " << "["
-                             << (resourceName.empty() ? "cvisa" : resourceName) << "] " << message;
-
-                for (auto* stream : s_outputStreams) {
-                    if (stream) {
-                        (*stream) << full_message.str() << std::endl;
-                    }
-                }
+            if (activeLevel >= messageLevel && messageLevel != LogLevel::NONE) {
+                write(messageLevel, resourceName, message);
             }
         }
 
-      private:
-        // The streams where log messages will be written.
-        static std::vector<std::ostream*> s_outputStreams;
-
         /**
-         * @brief Converts a LogLevel enum to its string representation.
+         * @brief Returns true if a message of `messageLevel` would be written.
+         *
+         * Checks the compile-time level, the instance's verbosity and whether any
+         * sink is registered, so callers can skip building the message.
          */
-        static std::string levelToString(LogLevel level) {
-            switch (level) {
-                case LogLevel::ERROR:
-                    return "ERROR  ";
-                case LogLevel::WARNING:
-                    return "WARNING";
-                case LogLevel::INFO:
-                    return "INFO   ";
-                case LogLevel::DEBUG:
-                    return "DEBUG  ";
-                default:
-                    return "UNKNOWN";
-            }
+        static bool isEnabled(LogLevel activeLevel, LogLevel messageLevel) {
+            return static_cast<int>(messageLevel) <= CVISA_LOG_COMPILE_LEVEL && activeLevel >= messageLevel && messageLevel != LogLevel::NONE && hasSinks();
         }
 
         /**
-         * @brief Gets the current time as a formatted string (HH:MM:SS.ms).
+         * @brief Returns true if at least one sink is registered.
          */
-        static std::string getCurrentTimestamp() {
-            auto now       = std::chrono::system_clock::now();
-            auto in_time_t = std::chrono::system_clock::to_time_t(now);
-            auto ms        = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-
-            std::stringstream ss;
-            ss << std::put_time(std::localtime(&in_time_t), "%X");
-            ss << '.' << std::setw(3) << std::setfill('0') << ms.count();
-            return ss.str();
-        }
-    };
+        static bool hasSinks();
 
-    // Initialize the static output stream vector.
-    std::vector<std::ostream*> Logger::s_outputStreams;
+        /**
+         * @brief Switches to asynchronous logging.
+         *
+         * Has no effect if asynchronous logging is already enabled.
+         *
+         * @param capacity The number of records in the ring buffer, rounded up to a
+         * power of two. This bounds the memory used (about 512 bytes per record).
+         */
+        static void enableAsync(size_t capacity = 1024);
+
+        /**
+         * @brief Writes all pending records and returns to synchronous logging.
+         */
+        static void disableAsync();
+
+        /**
+         * @brief Returns true if asynchronous logging is enabled.
+         */
+        static bool isAsync();
+
+        /**
+         * @brief Blocks until every record logged so far has been written and the sinks are flushed.
+         */
+        static void flush();
+
+        /**
+         * @brief Returns the number of records dropped because the ring buffer was full.
+         */
+        static uint64_t droppedRecords();
+
+      private:
+        // Formats and writes (synchronous mode) or enqueues (asynchronous mode) one message.
+        static void write(LogLevel level, const std::string& resourceName, const std::string& message);
+    };
 
 }    // namespace cvisa
 
@@ -0,0 +1,367 @@
+#include "Metrics.hpp"
+
+#include "CommandFormatter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <utility>
+
+namespace cvisa {
+
+    constexpr size_t LatencyHistogram::BUCKETS;
+
+    const char* const SessionMetrics::WRITE = "(write)";
+    const char* const SessionMetrics::READ  = "(read)";
+    const char* const SessionMetrics::QUERY = "(query)";
+    const char* const SessionMetrics::BATCH    = "(batch)";
+    const char* const SessionMetrics::PIPELINE = "(pipeline)";
+
+    namespace {
+        size_t bucketOf(uint64_t ns) {
+            uint64_t us     = ns / 1000;
+            size_t   bucket = 0;
+            while (us != 0 && bucket < LatencyHistogram::BUCKETS - 1) {
+                us >>= 1;
+                ++bucket;
+            }
+            return bucket;
+        }
+
+        void appendJsonString(std::string& out, const std::string& value) {
+            static const char s_hex[] = "0123456789abcdef";
+            out += '"';
+            for (size_t i = 0; i < value.size(); ++i) {
+                unsigned char c = static_cast<unsigned char>(value[i]);
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += static_cast<char>(c);
+                } else if (c < 0x20) {
+                    out += "\\u00";
+                    out += s_hex[c >> 4];
+                    out += s_hex[c & 0x0F];
+                } else {
+                    out += static_cast<char>(c);
+                }
+            }
+            out += '"';
+        }
+
+        // Prometheus label values escape backslash, double quote and newline.
+        void appendLabelValue(std::string& out, const std::string& value) {
+            for (size_t i = 0; i < value.size(); ++i) {
+                char c = value[i];
+                if (c == '\\' || c == '"') {
+                    out += '\\';
+                    out += c;
+                } else if (c == '\n') {
+                    out += "\\n";
+                } else {
+                    out += c;
+                }
+            }
+        }
+
+        void appendHistogramJson(std::string& out, const char* name, const LatencyHistogram& histogram) {
+            out += '"';
+            out += name;
+            out += "\":{\"count\":";
+            CommandFormatter::appendUnsigned(out, histogram.count());
+            out += ",\"mean_us\":";
+            CommandFormatter::appendFixed(out, histogram.meanUs(), 3);
+            out += ",\"p50_us\":";
+            CommandFormatter::appendFixed(out, histogram.percentileUs(0.5), 3);
+            out += ",\"p99_us\":";
+            CommandFormatter::appendFixed(out, histogram.percentileUs(0.99), 3);
+            out += ",\"max_us\":";
+            CommandFormatter::appendFixed(out, static_cast<double>(histogram.maxNs()) / 1000.0, 3);
+            out += ",\"buckets\":[";
+            for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+                if (i > 0) out += ',';
+                CommandFormatter::appendUnsigned(out, histogram.bucketCount(i));
+            }
+            out += "]}";
+        }
+
+        struct PrometheusWriter {
+            std::string&       out;
+            const std::string& prefix;
+            const std::string& resource;
+
+            void labels(const std::string& command) {
+                out += "{resource=\"";
+                appendLabelValue(out, resource);
+                out += "\",command=\"";
+                appendLabelValue(out, command);
+                out += '"';
+            }
+
+            void header(const char* name, const char* type, const char* help) {
+                out += "# HELP " + prefix + name + ' ' + help + '\n';
+                out += "# TYPE " + prefix + name + ' ' + type + '\n';
+            }
+
+            void counter(const char* name, const std::string& command, uint64_t value) {
+                out += prefix;
+                out += name;
+                labels(command);
+                out += "} ";
+                CommandFormatter::appendUnsigned(out, value);
+                out += '\n';
+            }
+
+            void histogram(const char* name, const std::string& command, const LatencyHistogram& histogram) {
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+                    cumulative += histogram.bucketCount(i);
+                    out += prefix;
+                    out += name;
+                    out += "_bucket";
+                    labels(command);
+                    out += ",le=\"";
+                    if (i + 1 < LatencyHistogram::BUCKETS) {
+                        CommandFormatter::appendFixed(out, LatencyHistogram::bucketUpperBoundUs(i) / 1e6, 6);
+                    } else {
+                        out += "+Inf";
+                    }
+                    out += "\"} ";
+                    CommandFormatter::appendUnsigned(out, cumulative);
+                    out += '\n';
+                }
+                out += prefix;
+                out += name;
+                out += "_sum";
+                labels(command);
+                out += "} ";
+                CommandFormatter::appendFixed(out, static_cast<double>(histogram.totalNs()) / 1e9, 9);
+                out += '\n';
+                out += prefix;
+                out += name;
+                out += "_count";
+                labels(command);
+                out += "} ";
+                CommandFormatter::appendUnsigned(out, histogram.count());
+                out += '\n';
+            }
+        };
+    }    // namespace
+
+    // --- LatencyHistogram ---
+
+    LatencyHistogram::LatencyHistogram() : m_count(0), m_totalNs(0), m_maxNs(0) { std::memset(m_buckets, 0, sizeof(m_buckets)); }
+
+    void LatencyHistogram::record(uint64_t ns) {
+        ++m_buckets[bucketOf(ns)];
+        ++m_count;
+        m_totalNs += ns;
+        if (ns > m_maxNs) m_maxNs = ns;
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            m_buckets[i] += other.m_buckets[i];
+        }
+        m_count += other.m_count;
+        m_totalNs += other.m_totalNs;
+        m_maxNs = std::max(m_maxNs, other.m_maxNs);
+    }
+
+    double LatencyHistogram::meanUs() const { return m_count == 0 ? 0.0 : static_cast<double>(m_totalNs) / static_cast<double>(m_count) / 1000.0; }
+
+    double LatencyHistogram::percentileUs(double q) const {
+        if (m_count == 0) return 0.0;
+        q = std::min(std::max(q, 0.0), 1.0);
+
+        uint64_t rank  = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(m_count) + 0.5));
+        uint64_t seen  = 0;
+        double   maxUs = static_cast<double>(m_maxNs) / 1000.0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += m_buckets[i];
+            if (seen >= rank) {
+                return std::min(bucketUpperBoundUs(i), maxUs);
+            }
+        }
+        return maxUs;
+    }
+
+    double LatencyHistogram::bucketUpperBoundUs(size_t bucket) {
+        if (bucket + 1 >= BUCKETS) return std::numeric_limits<double>::infinity();
+        return static_cast<double>(uint64_t(1) << bucket);
+    }
+
+    // --- CommandStats / MetricsSnapshot ---
+
+    void CommandStats::merge(const CommandStats& other) {
+        calls += other.calls;
+        errors += other.errors;
+        bytesWritten += other.bytesWritten;
+        bytesRead += other.bytesRead;
+        write.merge(other.write);
+        wait.merge(other.wait);
+        read.merge(other.read);
+    }
+
+    CommandStats MetricsSnapshot::total() const {
+        CommandStats sum;
+        sum.command = "(total)";
+        for (size_t i = 0; i < commands.size(); ++i) {
+            sum.merge(commands[i]);
+        }
+        return sum;
+    }
+
+    std::string MetricsSnapshot::toJson() const {
+        std::string out;
+        out += "{\"resource\":";
+        appendJsonString(out, resource);
+        out += ",\"commands\":[";
+        for (size_t i = 0; i < commands.size(); ++i) {
+            const CommandStats& stats = commands[i];
+            if (i > 0) out += ',';
+            out += "{\"command\":";
+            appendJsonString(out, stats.command);
+            out += ",\"calls\":";
+            CommandFormatter::appendUnsigned(out, stats.calls);
+            out += ",\"errors\":";
+            CommandFormatter::appendUnsigned(out, stats.errors);
+            out += ",\"bytes_written\":";
+            CommandFormatter::appendUnsigned(out, stats.bytesWritten);
+            out += ",\"bytes_read\":";
+            CommandFormatter::appendUnsigned(out, stats.bytesRead);
+            out += ',';
+            appendHistogramJson(out, "write", stats.write);
+            out += ',';
+            appendHistogramJson(out, "wait", stats.wait);
+            out += ',';
+            appendHistogramJson(out, "read", stats.read);
+            out += '}';
+        }
+        out += "]}";
+        return out;
+    }
+
+    std::string MetricsSnapshot::toPrometheus(const std::string& prefix) const {
+        std::string      out;
+        PrometheusWriter writer = {out, prefix, resource};
+
+        writer.header("_command_calls_total", "counter", "Commands executed.");
+        for (const auto& stats : commands) writer.counter("_command_calls_total", stats.command, stats.calls);
+        writer.header("_command_errors_total", "counter", "Commands that failed with an exception.");
+        for (const auto& stats : commands) writer.counter("_command_errors_total", stats.command, stats.errors);
+        writer.header("_command_bytes_written_total", "counter", "Bytes written to the instrument.");
+        for (const auto& stats : commands) writer.counter("_command_bytes_written_total", stats.command, stats.bytesWritten);
+        writer.header("_command_bytes_read_total", "counter", "Bytes read from the instrument.");
+        for (const auto& stats : commands) writer.counter("_command_bytes_read_total", stats.command, stats.bytesRead);
+        writer.header("_command_write_seconds", "histogram", "Time spent writing commands.");
+        for (const auto& stats : commands) writer.histogram("_command_write_seconds", stats.command, stats.write);
+        writer.header("_command_wait_seconds", "histogram", "Time spent waiting between write and read.");
+        for (const auto& stats : commands) writer.histogram("_command_wait_seconds", stats.command, stats.wait);
+        writer.header("_command_read_seconds", "histogram", "Time spent reading responses.");
+        for (const auto& stats : commands) writer.histogram("_command_read_seconds", stats.command, stats.read);
+        return out;
+    }
+
+    // --- SessionMetrics ---
+
+    SessionMetrics::SessionMetrics() : m_enabled(false) { std::memset(&m_pending, 0, sizeof(m_pending)); }
+
+    SessionMetrics::SessionMetrics(SessionMetrics&& other) noexcept : m_enabled(other.isEnabled()) {
+        std::memset(&m_pending, 0, sizeof(m_pending));
+        std::lock_guard<std::mutex> lock(other.m_mutex);
+        m_commands = std::move(other.m_commands);
+        other.m_commands.clear();
+    }
+
+    SessionMetrics& SessionMetrics::operator=(SessionMetrics&& other) noexcept {
+        if (this != &other) {
+            std::unordered_map<const char*, CommandStats> commands;
+            {
+                std::lock_guard<std::mutex> lock(other.m_mutex);
+                commands.swap(other.m_commands);
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_commands.swap(commands);
+            m_enabled.store(other.isEnabled(), std::memory_order_relaxed);
+            std::memset(&m_pending, 0, sizeof(m_pending));
+        }
+        return *this;
+    }
+
+    bool SessionMetrics::beginCommand(const char* command) {
+        if (!isEnabled() || m_pending.command != nullptr) {
+            return false;
+        }
+        std::memset(&m_pending, 0, sizeof(m_pending));
+        m_pending.command = command;
+        return true;
+    }
+
+    void SessionMetrics::endCommand(bool failed) {
+        if (m_pending.command == nullptr) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            CommandStats&               stats = m_commands[m_pending.command];
+            ++stats.calls;
+            if (failed) ++stats.errors;
+            stats.bytesWritten += m_pending.bytesWritten;
+            stats.bytesRead += m_pending.bytesRead;
+            if (m_pending.wrote) stats.write.record(m_pending.writeNs);
+            if (m_pending.waited) stats.wait.record(m_pending.waitNs);
+            if (m_pending.readSome) stats.read.record(m_pending.readNs);
+        }
+        m_pending.command = nullptr;
+    }
+
+    void SessionMetrics::recordWrite(uint64_t ns, size_t bytes) {
+        if (m_pending.command == nullptr) return;
+        m_pending.writeNs += ns;
+        m_pending.bytesWritten += bytes;
+        m_pending.wrote = true;
+    }
+
+    void SessionMetrics::recordWait(uint64_t ns) {
+        if (m_pending.command == nullptr) return;
+        m_pending.waitNs += ns;
+        m_pending.waited = true;
+    }
+
+    void SessionMetrics::recordRead(uint64_t ns, size_t bytes) {
+        if (m_pending.command == nullptr) return;
+        m_pending.readNs += ns;
+        m_pending.bytesRead += bytes;
+        m_pending.readSome = true;
+    }
+
+    void SessionMetrics::reset() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_commands.clear();
+    }
+
+    MetricsSnapshot SessionMetrics::snapshot(const std::string& resource) const {
+        std::map<std::string, CommandStats> merged;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& entry : m_commands) {
+                merged[entry.first].merge(entry.second);
+            }
+        }
+
+        MetricsSnapshot snapshot;
+        snapshot.resource = resource;
+        snapshot.commands.reserve(merged.size());
+        for (auto& entry : merged) {
+            entry.second.command = entry.first;
+            snapshot.commands.push_back(std::move(entry.second));
+        }
+        return snapshot;
+    }
+
+    uint64_t SessionMetrics::now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+}    // namespace cvisa
@@ -0,0 +1,283 @@
+#ifndef CVISA_METRICS_HPP
+#define CVISA_METRICS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cvisa {
+
+    /**
+     * @class LatencyHistogram
+     * @brief A fixed-size histogram of durations with power-of-two microsecond buckets.
+     *
+     * Bucket 0 counts durations below 1 µs, bucket `i` counts durations in
+     * [2^(i-1), 2^i) µs and the last bucket everything above. Recording is a
+     * handful of integer operations and never allocates.
+     */
+    class LatencyHistogram {
+      public:
+        static constexpr size_t BUCKETS = 32;
+
+        LatencyHistogram();
+
+        /**
+         * @brief Adds one duration.
+         * @param ns The duration in nanoseconds.
+         */
+        void record(uint64_t ns);
+
+        /**
+         * @brief Adds all samples of another histogram.
+         */
+        void merge(const LatencyHistogram& other);
+
+        uint64_t count() const { return m_count; }
+        uint64_t totalNs() const { return m_totalNs; }
+        uint64_t maxNs() const { return m_maxNs; }
+        uint64_t bucketCount(size_t bucket) const { return m_buckets[bucket]; }
+
+        /**
+         * @brief Returns the mean duration in microseconds, or 0 if empty.
+         */
+        double meanUs() const;
+
+        /**
+         * @brief Estimates a quantile in microseconds.
+         *
+         * Returns the upper bound of the bucket holding the quantile, capped at
+         * the largest recorded duration, so the estimate is never low by more
+         * than a factor of two.
+         *
+         * @param q The quantile in [0, 1] (e.g., 0.99).
+         * @return The estimate, or 0 if the histogram is empty.
+         */
+        double percentileUs(double q) const;
+
+        /**
+         * @brief Returns the exclusive upper bound of a bucket in microseconds.
+         *
+         * The last bucket is unbounded; this returns infinity for it.
+         */
+        static double bucketUpperBoundUs(size_t bucket);
+
+      private:
+        uint64_t m_buckets[BUCKETS];
+        uint64_t m_count;
+        uint64_t m_totalNs;
+        uint64_t m_maxNs;
+    };
+
+    /**
+     * @brief Accumulated statistics of one command template.
+     *
+     * Latencies are recorded once per call: the write, wait and read phases of
+     * a query each add one sample, summed over the VISA calls they made.
+     */
+    struct CommandStats {
+        std::string      command;               // The command template (e.g., "VOLT %f") or an I/O category.
+        uint64_t         calls        = 0;
+        uint64_t         errors       = 0;      // Calls that ended with an exception.
+        uint64_t         bytesWritten = 0;
+        uint64_t         bytesRead    = 0;
+        LatencyHistogram write;                 // Time spent in viWrite.
+        LatencyHistogram wait;                  // Time between write and read (delay or SRQ wait).
+        LatencyHistogram read;                  // Time spent in viRead.
+
+        /**
+         * @brief Adds the counters and histograms of another entry.
+         */
+        void merge(const CommandStats& other);
+    };
+
+    /**
+     * @brief A point-in-time copy of a session's metrics.
+     */
+    struct MetricsSnapshot {
+        std::string               resource;    // The session's VISA resource name.
+        std::vector<CommandStats> commands;    // One entry per command template, sorted by template.
+
+        /**
+         * @brief Returns the sum over all commands.
+         */
+        CommandStats total() const;
+
+        /**
+         * @brief Returns the snapshot as a JSON object.
+         *
+         * Each histogram is reported with its count, mean, p50, p99 and maximum
+         * in microseconds and the raw bucket counts.
+         */
+        std::string toJson() const;
+
+        /**
+         * @brief Returns the snapshot in the Prometheus text exposition format.
+         *
+         * Counters are named `<prefix>_command_calls_total`, etc., and latencies
+         * are exported as `<prefix>_command_{write,wait,read}_seconds` histograms,
+         * labelled with `resource` and `command`.
+         *
+         * @param prefix The metric name prefix.
+         */
+        std::string toPrometheus(const std::string& prefix = "cvisa") const;
+    };
+
+    /**
+     * @class SessionMetrics
+     * @brief Per-command call counts, byte counts and latency histograms of one session.
+     *
+     * `VISACom` and `SCPIBase` open a scope for each operation with
+     * `beginCommand()`, report the time spent in each I/O phase and close the
+     * scope with `endCommand()`. Nested scopes are folded into the outermost
+     * one, so a driver query is accounted to its command template rather than
+     * to the `write()` and `read()` calls it makes. Raw I/O outside a driver
+     * command is accounted to the `WRITE`, `READ` and `QUERY` categories,
+     * compound messages to `BATCH` and query pipelines to `PIPELINE`.
+     *
+     * Scopes and records must be issued under the session's I/O lock; the
+     * accumulated statistics have their own lock, taken once per operation, so
+     * `snapshot()` can be called from any thread without waiting for I/O.
+     * Collection is disabled by default and then costs one atomic load per
+     * operation.
+     */
+    class SessionMetrics {
+      public:
+        // Categories for I/O that is not issued by a driver command.
+        static const char* const WRITE;
+        static const char* const READ;
+        static const char* const QUERY;
+        static const char* const BATCH;       // Batches and command chains.
+        static const char* const PIPELINE;    // VISACom::queryPipeline().
+
+        SessionMetrics();
+
+        SessionMetrics(const SessionMetrics&)            = delete;
+        SessionMetrics& operator=(const SessionMetrics&) = delete;
+        SessionMetrics(SessionMetrics&& other) noexcept;
+        SessionMetrics& operator=(SessionMetrics&& other) noexcept;
+
+        /**
+         * @brief Starts or stops collecting. Accumulated statistics are kept.
+         */
+        void setEnabled(bool enable) { m_enabled.store(enable, std::memory_order_relaxed); }
+
+        /**
+         * @brief Returns true if metrics are being collected.
+         */
+        bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Opens the scope of one operation.
+         *
+         * @param command The command template. Must point to storage that
+         * outlives the session, such as an `SCPICommand` string literal;
+         * entries are keyed by this pointer.
+         * @return True if a scope was opened, false if collection is disabled
+         * or a scope is already open.
+         */
+        bool beginCommand(const char* command);
+
+        /**
+         * @brief Closes the scope opened by a successful `beginCommand()`.
+         * @param failed True if the operation ended with an exception.
+         */
+        void endCommand(bool failed);
+
+        /**
+         * @brief Reports time spent writing inside the open scope.
+         */
+        void recordWrite(uint64_t ns, size_t bytes);
+
+        /**
+         * @brief Reports time spent waiting for a response inside the open scope.
+         */
+        void recordWait(uint64_t ns);
+
+        /**
+         * @brief Reports time spent reading inside the open scope.
+         */
+        void recordRead(uint64_t ns, size_t bytes);
+
+        /**
+         * @brief Returns true if a scope is open, i.e. I/O should be timed.
+         */
+        bool isRecording() const { return m_pending.command != nullptr; }
+
+        /**
+         * @brief Discards all accumulated statistics.
+         */
+        void reset();
+
+        /**
+         * @brief Copies the accumulated statistics.
+         *
+         * Entries of identical templates defined in different places are merged.
+         *
+         * @param resource The resource name stored in the snapshot.
+         */
+        MetricsSnapshot snapshot(const std::string& resource) const;
+
+        /**
+         * @brief Returns a monotonic timestamp in nanoseconds.
+         */
+        static uint64_t now();
+
+      private:
+        // The operation in progress; guarded by the session's I/O lock.
+        struct Pending {
+            const char* command;
+            uint64_t    writeNs;
+            uint64_t    waitNs;
+            uint64_t    readNs;
+            uint64_t    bytesWritten;
+            uint64_t    bytesRead;
+            bool        wrote;
+            bool        waited;
+            bool        readSome;
+        };
+
+        std::atomic<bool>                              m_enabled;
+        Pending                                        m_pending;
+        mutable std::mutex                             m_mutex;       // Guards m_commands.
+        std::unordered_map<const char*, CommandStats> m_commands;    // Keyed by template pointer.
+    };
+
+    /**
+     * @class MetricsScope
+     * @brief Opens a `SessionMetrics` scope and closes it on every exit path.
+     *
+     * The operation counts as failed unless `complete()` is called.
+     */
+    class MetricsScope {
+      public:
+        MetricsScope(SessionMetrics& metrics, const char* command) : m_metrics(metrics), m_open(metrics.beginCommand(command)) {}
+
+        ~MetricsScope() {
+            if (m_open) m_metrics.endCommand(true);
+        }
+
+        MetricsScope(const MetricsScope&)            = delete;
+        MetricsScope& operator=(const MetricsScope&) = delete;
+
+        /**
+         * @brief Closes the scope as a successful operation.
+         */
+        void complete() {
+            if (m_open) {
+                m_metrics.endCommand(false);
+                m_open = false;
+            }
+        }
+
+      private:
+        SessionMetrics& m_metrics;
+        bool            m_open;
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_METRICS_HPP
@@ -0,0 +1,81 @@
+#include "ResourceManager.hpp"
+
+#include "Exceptions.hpp"
+
+#include <map>
+#include <mutex>
+#include <visa.h>
+
+namespace cvisa {
+
+    namespace {
+        std::mutex                     s_managerMutex;
+        std::weak_ptr<ResourceManager> s_manager;
+
+        std::mutex                                      s_cacheMutex;
+        std::map<std::string, std::vector<std::string>> s_resourceCache;
+    }    // namespace
+
+    std::shared_ptr<ResourceManager> ResourceManager::acquire() {
+        std::lock_guard<std::mutex>      lock(s_managerMutex);
+        std::shared_ptr<ResourceManager> manager = s_manager.lock();
+        if (!manager) {
+            ViSession handle = VI_NULL;
+            if (viOpenDefaultRM(&handle) < VI_SUCCESS) {
+                throw ConnectionException("Failed to open VISA Default Resource Manager.");
+            }
+            manager   = std::shared_ptr<ResourceManager>(new ResourceManager(handle));
+            s_manager = manager;
+        }
+        return manager;
+    }
+
+    ResourceManager::~ResourceManager() {
+        if (m_handle != VI_NULL) viClose(m_handle);
+    }
+
+    std::vector<std::string> ResourceManager::findResources(const std::string& query, bool refresh) {
+        if (!refresh) {
+            std::lock_guard<std::mutex> lock(s_cacheMutex);
+            auto                        cached = s_resourceCache.find(query);
+            if (cached != s_resourceCache.end()) return cached->second;
+        }
+
+        std::shared_ptr<ResourceManager> manager   = acquire();
+        std::vector<std::string>         resources = enumerate(manager->handle(), query);
+
+        std::lock_guard<std::mutex> lock(s_cacheMutex);
+        s_resourceCache[query] = resources;
+        return resources;
+    }
+
+    void ResourceManager::invalidateResourceCache() {
+        std::lock_guard<std::mutex> lock(s_cacheMutex);
+        s_resourceCache.clear();
+    }
+
+    std::vector<std::string> ResourceManager::enumerate(ViSession rmSession, const std::string& query) {
+        ViFindList               findList;
+        ViUInt32                 returnCount = 0;
+        char                     instrumentDescription[VI_FIND_BUFLEN];
+        std::vector<std::string> resources;
+
+        ViStatus status = viFindRsrc(rmSession, const_cast<char*>(query.c_str()), &findList, &returnCount, instrumentDescription);
+        if (status < VI_SUCCESS) {
+            if (status == VI_ERROR_RSRC_NFOUND) return {};
+            throw VisaException("Failed to find VISA resources.");
+        }
+
+        resources.reserve(returnCount);
+        resources.emplace_back(instrumentDescription);
+        for (ViUInt32 i = 1; i < returnCount; ++i) {
+            status = viFindNext(findList, instrumentDescription);
+            if (status < VI_SUCCESS) break;
+            resources.emplace_back(instrumentDescription);
+        }
+
+        viClose(findList);
+        return resources;
+    }
+
+}    // namespace cvisa
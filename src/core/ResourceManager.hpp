@@ -0,0 +1,81 @@
+#ifndef CVISA_RESOURCE_MANAGER_HPP
+#define CVISA_RESOURCE_MANAGER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Forward-declare VISA types to avoid including visa.h in a public header.
+using ViSession = unsigned long;
+
+namespace cvisa {
+
+    /**
+     * @class ResourceManager
+     * @brief A reference-counted handle to the process-wide VISA default
+     * resource manager.
+     *
+     * Opening a default resource manager is comparatively expensive, and some
+     * vendor stacks start helper threads for every one of them. All `VISACom`
+     * sessions therefore share a single resource manager: the first call to
+     * `acquire()` opens it, and it is closed when the last reference is
+     * released.
+     *
+     * The class also keeps a cache of resource discovery results, so that
+     * bringing up a large rig does not enumerate the buses once per
+     * instrument.
+     */
+    class ResourceManager {
+      public:
+        /**
+         * @brief Returns a reference to the shared default resource manager,
+         * opening it if no reference is currently alive.
+         * @return A shared handle. The resource manager stays open while any
+         * copy of it exists.
+         * @throws ConnectionException if the resource manager cannot be opened.
+         */
+        static std::shared_ptr<ResourceManager> acquire();
+
+        /**
+         * @brief Destructor. Closes the VISA resource manager session.
+         */
+        ~ResourceManager();
+
+        ResourceManager(const ResourceManager&)            = delete;
+        ResourceManager& operator=(const ResourceManager&) = delete;
+
+        /**
+         * @brief Returns the raw VISA session of the resource manager.
+         */
+        ViSession handle() const { return m_handle; }
+
+        /**
+         * @brief Finds VISA resources matching a query, using cached results.
+         *
+         * The first lookup for a given query enumerates the buses; later
+         * lookups return the cached list until `refresh` is requested or the
+         * cache is invalidated.
+         *
+         * @param query The VISA resource expression (e.g., "?*INSTR", "GPIB?*INSTR").
+         * @param refresh If true, the buses are enumerated again and the cache is updated.
+         * @return The matching resource strings.
+         * @throws VisaException if the resources cannot be enumerated.
+         */
+        static std::vector<std::string> findResources(const std::string& query = "?*INSTR", bool refresh = false);
+
+        /**
+         * @brief Discards all cached discovery results.
+         */
+        static void invalidateResourceCache();
+
+      private:
+        explicit ResourceManager(ViSession handle) : m_handle(handle) {}
+
+        static std::vector<std::string> enumerate(ViSession rmSession, const std::string& query);
+
+        ViSession m_handle;
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_RESOURCE_MANAGER_HPP
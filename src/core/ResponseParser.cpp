@@ -0,0 +1,305 @@
+#include "ResponseParser.hpp"
+
+#include "Exceptions.hpp"
+#include "../utils/utils.hpp"
+
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+namespace cvisa {
+
+    constexpr double ResponseParser::OVERFLOW_VALUE;
+    constexpr double ResponseParser::NAN_VALUE;
+
+    namespace {
+
+        // Powers of ten that are exactly representable as doubles.
+        const double s_exactPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                             1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        // Mantissas up to 2^53 convert to double without rounding.
+        const uint64_t s_maxExactMantissa = 1ULL << 53;
+
+        // Significant digits collected before the remainder is only counted.
+        const int s_maxMantissaDigits = 19;
+
+        using utils::isDigit;
+        using utils::isSpace;
+        using utils::toUpper;
+
+        // Case-insensitive match of `keyword` at `cursor`, advancing past it on success.
+        bool matchKeyword(const char*& cursor, const char* end, const char* keyword) {
+            const char* p = cursor;
+            for (; *keyword != '\0'; ++keyword, ++p) {
+                if (p == end || toUpper(*p) != *keyword) {
+                    return false;
+                }
+            }
+            cursor = p;
+            return true;
+        }
+
+        // Correctly rounded conversion of a number token for inputs outside the exact fast path.
+        // strtod expects the locale's decimal separator, so the token is adapted to it first.
+        double convertSlow(const char* begin, const char* end) {
+            const char* point = std::localeconv()->decimal_point;
+            std::string token;
+            token.reserve(static_cast<size_t>(end - begin) + 4);
+            for (const char* p = begin; p != end; ++p) {
+                if (*p == '.' && point != nullptr && point[0] != '\0') {
+                    token.append(point);
+                } else {
+                    token.push_back(*p);
+                }
+            }
+            return std::strtod(token.c_str(), nullptr);
+        }
+
+        [[noreturn]] void throwParseError(const char* what, const char* begin, const char* end) {
+            throw CommandException(std::string("Failed to parse ") + what + " from instrument response: \"" + std::string(begin, end) + "\"");
+        }
+
+    }    // namespace
+
+    void ResponseParser::trim(const char*& begin, const char*& end) {
+        while (begin != end && isSpace(*begin)) {
+            ++begin;
+        }
+        while (end != begin && isSpace(*(end - 1))) {
+            --end;
+        }
+    }
+
+    bool ResponseParser::parseNumber(const char*& cursor, const char* end, double& value) {
+        const char* p        = cursor;
+        bool        negative = false;
+        if (p != end && (*p == '+' || *p == '-')) {
+            negative = *p == '-';
+            ++p;
+        }
+
+        if (matchKeyword(p, end, "NINF")) {
+            value  = negative ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+            cursor = p;
+            return true;
+        }
+        if (matchKeyword(p, end, "INF")) {
+            value  = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+            cursor = p;
+            return true;
+        }
+        if (matchKeyword(p, end, "NAN")) {
+            value  = std::numeric_limits<double>::quiet_NaN();
+            cursor = p;
+            return true;
+        }
+
+        uint64_t mantissa  = 0;
+        int      digits    = 0;        // Significant digits stored in `mantissa`.
+        int      exponent  = 0;        // Decimal exponent applied to `mantissa`.
+        bool     truncated = false;    // Non-zero digits were dropped.
+        bool     anyDigit  = false;
+
+        for (; p != end && isDigit(*p); ++p) {
+            anyDigit = true;
+            if (digits < s_maxMantissaDigits) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                digits += mantissa != 0 ? 1 : 0;
+            } else {
+                ++exponent;
+                truncated = truncated || *p != '0';
+            }
+        }
+        if (p != end && *p == '.') {
+            for (++p; p != end && isDigit(*p); ++p) {
+                anyDigit = true;
+                if (digits < s_maxMantissaDigits) {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                    digits += mantissa != 0 ? 1 : 0;
+                    --exponent;
+                } else {
+                    truncated = truncated || *p != '0';
+                }
+            }
+        }
+        if (!anyDigit) {
+            return false;
+        }
+
+        // The exponent is only consumed if it is complete ("1E" leaves the 'E' unparsed).
+        if (p != end && (*p == 'e' || *p == 'E')) {
+            const char* q           = p + 1;
+            bool        negativeExp = false;
+            if (q != end && (*q == '+' || *q == '-')) {
+                negativeExp = *q == '-';
+                ++q;
+            }
+            if (q != end && isDigit(*q)) {
+                int explicitExponent = 0;
+                for (; q != end && isDigit(*q); ++q) {
+                    if (explicitExponent < 100000) {
+                        explicitExponent = explicitExponent * 10 + (*q - '0');
+                    }
+                }
+                exponent += negativeExp ? -explicitExponent : explicitExponent;
+                p = q;
+            }
+        }
+
+        double result;
+        if (mantissa == 0) {
+            result = 0.0;
+        } else if (!truncated && mantissa <= s_maxExactMantissa && exponent >= -22 && exponent <= 22) {
+            // Clinger's fast path: both operands are exact, so one IEEE operation rounds correctly.
+            double m = static_cast<double>(mantissa);
+            result   = exponent < 0 ? m / s_exactPowersOfTen[-exponent] : m * s_exactPowersOfTen[exponent];
+        } else {
+            result = std::fabs(convertSlow(cursor, p));
+        }
+
+        if (result == NAN_VALUE) {
+            value = std::numeric_limits<double>::quiet_NaN();
+        } else if (result == OVERFLOW_VALUE) {
+            value = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        } else {
+            value = negative ? -result : result;
+        }
+        cursor = p;
+        return true;
+    }
+
+    bool ResponseParser::tryParseDouble(const char* begin, const char* end, double& value) {
+        trim(begin, end);
+        const char* cursor = begin;
+        return parseNumber(cursor, end, value) && cursor == end;
+    }
+
+    bool ResponseParser::tryParseInteger(const char* begin, const char* end, long long& value) {
+        trim(begin, end);
+
+        // NR1 fast path.
+        const char* p        = begin;
+        bool        negative = false;
+        if (p != end && (*p == '+' || *p == '-')) {
+            negative = *p == '-';
+            ++p;
+        }
+        const char*        digitsBegin = p;
+        unsigned long long magnitude   = 0;
+        bool               overflow    = false;
+        for (; p != end && isDigit(*p); ++p) {
+            unsigned digit = static_cast<unsigned>(*p - '0');
+            if (magnitude > (std::numeric_limits<unsigned long long>::max() - digit) / 10) {
+                overflow = true;
+            }
+            magnitude = magnitude * 10 + digit;
+        }
+        if (p == end && p != digitsBegin) {
+            unsigned long long limit = negative ? static_cast<unsigned long long>(std::numeric_limits<long long>::max()) + 1
+                                                : static_cast<unsigned long long>(std::numeric_limits<long long>::max());
+            if (overflow || magnitude > limit) {
+                return false;
+            }
+            value = negative ? static_cast<long long>(0ULL - magnitude) : static_cast<long long>(magnitude);
+            return true;
+        }
+
+        // NR2/NR3 representation of an integer.
+        const char* cursor = begin;
+        double      number;
+        if (!parseNumber(cursor, end, number) || cursor != end || !std::isfinite(number) || number != std::floor(number) || number < -9.2233720368547758e18
+            || number >= 9.2233720368547758e18) {
+            return false;
+        }
+        value = static_cast<long long>(number);
+        return true;
+    }
+
+    bool ResponseParser::tryParseBool(const char* begin, const char* end, bool& value) {
+        trim(begin, end);
+        const char* cursor = begin;
+        if (matchKeyword(cursor, end, "ON") && cursor == end) {
+            value = true;
+            return true;
+        }
+        cursor = begin;
+        if (matchKeyword(cursor, end, "OFF") && cursor == end) {
+            value = false;
+            return true;
+        }
+        cursor = begin;
+        double number;
+        if (!parseNumber(cursor, end, number) || cursor != end || std::isnan(number)) {
+            return false;
+        }
+        value = std::fabs(number) >= 0.5;
+        return true;
+    }
+
+    double ResponseParser::parseDouble(const char* begin, const char* end) {
+        double value;
+        if (!tryParseDouble(begin, end, value)) {
+            trim(begin, end);
+            throwParseError("double", begin, end);
+        }
+        return value;
+    }
+
+    long long ResponseParser::parseInteger(const char* begin, const char* end) {
+        long long value;
+        if (!tryParseInteger(begin, end, value)) {
+            trim(begin, end);
+            throwParseError("int", begin, end);
+        }
+        return value;
+    }
+
+    bool ResponseParser::parseBool(const char* begin, const char* end) {
+        bool value;
+        if (!tryParseBool(begin, end, value)) {
+            trim(begin, end);
+            throwParseError("bool", begin, end);
+        }
+        return value;
+    }
+
+    size_t ResponseParser::parseDoubleArray(const char* begin, const char* end, std::vector<double>& values, char separator) {
+        values.clear();
+        trim(begin, end);
+        if (begin == end) {
+            return 0;
+        }
+        const char* fieldBegin = begin;
+        for (;;) {
+            const char* fieldEnd = fieldBegin;
+            while (fieldEnd != end && *fieldEnd != separator) {
+                ++fieldEnd;
+            }
+            const char* first = fieldBegin;
+            const char* last  = fieldEnd;
+            trim(first, last);
+            const char* cursor = first;
+            double      value;
+            if (!parseNumber(cursor, last, value) || cursor != last) {
+                throwParseError("number list", begin, end);
+            }
+            values.push_back(value);
+            if (fieldEnd == end) {
+                break;
+            }
+            fieldBegin = fieldEnd + 1;
+        }
+        return values.size();
+    }
+
+    std::string ResponseParser::trimmed(const std::string& response) {
+        const char* begin = response.data();
+        const char* end   = begin + response.size();
+        trim(begin, end);
+        return std::string(begin, end);
+    }
+
+}    // namespace cvisa
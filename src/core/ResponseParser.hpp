@@ -0,0 +1,117 @@
+#ifndef CVISA_RESPONSE_PARSER_HPP
+#define CVISA_RESPONSE_PARSER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace cvisa {
+
+    /**
+     * @class ResponseParser
+     * @brief Locale-independent parsing of SCPI response data.
+     *
+     * All functions work on a `[begin, end)` character range, typically a view
+     * of a session's receive buffer, so nothing is copied. Leading and trailing
+     * whitespace (including the read terminator) is ignored.
+     *
+     * Numbers are accepted in the IEEE 488.2 NR1 (`+12`), NR2 (`-1.50`) and NR3
+     * (`1.2E-3`) formats. The SCPI sentinel values are mapped to IEEE values:
+     * `9.9E37` is +infinity, `-9.9E37` is -infinity and `9.91E37` is NaN. The
+     * keywords `INF`, `NINF` and `NAN` are also accepted. Conversion does not
+     * depend on the C locale; common values are converted exactly without
+     * calling `strtod`.
+     *
+     * Functions that return a value throw `CommandException` if the input is
+     * not a complete, valid token.
+     */
+    class ResponseParser {
+      public:
+        static constexpr double OVERFLOW_VALUE = 9.9e37;     // SCPI representation of +infinity.
+        static constexpr double NAN_VALUE      = 9.91e37;    // SCPI representation of "not a number".
+
+        /**
+         * @brief Narrows `[begin, end)` to exclude leading and trailing whitespace.
+         */
+        static void trim(const char*& begin, const char*& end);
+
+        /**
+         * @brief Parses a number from the start of `[cursor, end)`.
+         *
+         * Unlike the other functions, this does not require the whole range to
+         * be consumed: on success `cursor` points just past the number.
+         *
+         * @param cursor The start of the input. Advanced past the number on success.
+         * @param end The end of the input.
+         * @param value Receives the parsed value.
+         * @return True if a number was parsed, false otherwise (`cursor` is unchanged).
+         */
+        static bool parseNumber(const char*& cursor, const char* end, double& value);
+
+        /**
+         * @brief Parses an NR1, NR2 or NR3 number.
+         * @throws CommandException if the range is not a single number.
+         */
+        static double parseDouble(const char* begin, const char* end);
+
+        /**
+         * @brief Parses an integer.
+         *
+         * NR1 values are parsed directly. NR2 and NR3 values are accepted if they
+         * represent an integer (e.g., `+1.00000E+00`), as some instruments answer
+         * integer queries in floating-point form.
+         *
+         * @throws CommandException if the range is not an integer or is out of range.
+         */
+        static long long parseInteger(const char* begin, const char* end);
+
+        /**
+         * @brief Parses a SCPI boolean.
+         *
+         * Accepts `ON` and `OFF` in any case, or a number, which is true if it rounds
+         * to a non-zero value (`1`, `0`, `+1.0E+00`, ...).
+         *
+         * @throws CommandException for anything else.
+         */
+        static bool parseBool(const char* begin, const char* end);
+
+        /**
+         * @brief Non-throwing versions of `parseDouble()`, `parseInteger()` and `parseBool()`.
+         * @return True if the range holds a single value of the type. On false, `value` is unspecified.
+         */
+        static bool tryParseDouble(const char* begin, const char* end, double& value);
+        static bool tryParseInteger(const char* begin, const char* end, long long& value);
+        static bool tryParseBool(const char* begin, const char* end, bool& value);
+
+        /**
+         * @brief Parses a list of numbers separated by `separator` (e.g., "1.2,3.4,5.6").
+         *
+         * `values` is cleared but keeps its capacity, so parsing into the same vector
+         * repeatedly does not allocate. An empty range produces an empty list.
+         *
+         * @param begin The start of the input.
+         * @param end The end of the input.
+         * @param values Receives the parsed numbers.
+         * @param separator The character between elements.
+         * @return The number of elements parsed.
+         * @throws CommandException if any element is not a number.
+         */
+        static size_t parseDoubleArray(const char* begin, const char* end, std::vector<double>& values, char separator = ',');
+
+        // --- std::string convenience overloads ---
+        static double    parseDouble(const std::string& response) { return parseDouble(response.data(), response.data() + response.size()); }
+        static long long parseInteger(const std::string& response) { return parseInteger(response.data(), response.data() + response.size()); }
+        static bool      parseBool(const std::string& response) { return parseBool(response.data(), response.data() + response.size()); }
+        static size_t    parseDoubleArray(const std::string& response, std::vector<double>& values, char separator = ',') {
+            return parseDoubleArray(response.data(), response.data() + response.size(), values, separator);
+        }
+
+        /**
+         * @brief Returns a copy of `response` without leading and trailing whitespace.
+         */
+        static std::string trimmed(const std::string& response);
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_RESPONSE_PARSER_HPP
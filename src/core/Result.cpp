@@ -0,0 +1,74 @@
+#include "Result.hpp"
+
+#include "Exceptions.hpp"
+#include "../utils/utils.hpp"
+
+namespace cvisa {
+
+    IoStatus IoStatus::fromException(const VisaException& error) {
+        StatusCode code = StatusCode::VISA;
+        if (dynamic_cast<const TimeoutException*>(&error) != nullptr) {
+            code = StatusCode::TIMEOUT;
+        } else if (dynamic_cast<const ConnectionException*>(&error) != nullptr) {
+            code = StatusCode::CONNECTION;
+        } else if (dynamic_cast<const CommandException*>(&error) != nullptr) {
+            code = StatusCode::COMMAND;
+        } else if (dynamic_cast<const InstrumentException*>(&error) != nullptr) {
+            code = StatusCode::INSTRUMENT;
+        }
+        return fromMessage(code, error.what());
+    }
+
+    IoStatus IoStatus::fromMessage(StatusCode code, const std::string& message) {
+        IoStatus status(code, nullptr);
+        status.m_message = message;
+        return status;
+    }
+
+    std::string IoStatus::description() const {
+        if (!m_message.empty()) return m_message;
+        if (m_describe != nullptr) return m_describe(m_operation, m_nativeStatus);
+
+        std::string text = m_operation != nullptr ? std::string(m_operation) + ": " : std::string();
+        switch (m_code) {
+            case StatusCode::OK:
+                return "Success";
+            case StatusCode::TIMEOUT:
+                text += "Timed out";
+                break;
+            case StatusCode::CONNECTION:
+                text += "Not connected";
+                break;
+            case StatusCode::COMMAND:
+                text += "Command failed";
+                break;
+            case StatusCode::INSTRUMENT:
+                text += "Instrument error";
+                break;
+            case StatusCode::VISA:
+                text += "VISA error";
+                break;
+        }
+        if (m_nativeStatus != 0) text += " (Status: " + utils::to_string(m_nativeStatus) + ")";
+        return text;
+    }
+
+    void IoStatus::throwIfError() const {
+        switch (m_code) {
+            case StatusCode::OK:
+                return;
+            case StatusCode::TIMEOUT:
+                throw TimeoutException(description());
+            case StatusCode::CONNECTION:
+                throw ConnectionException(description());
+            case StatusCode::COMMAND:
+                throw CommandException(description());
+            case StatusCode::INSTRUMENT:
+                throw InstrumentException(description());
+            case StatusCode::VISA:
+                break;
+        }
+        throw VisaException(description());
+    }
+
+}    // namespace cvisa
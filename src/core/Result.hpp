@@ -0,0 +1,176 @@
+#ifndef CVISA_RESULT_HPP
+#define CVISA_RESULT_HPP
+
+#include <string>
+#include <utility>
+
+namespace cvisa {
+
+    class VisaException;
+
+    /**
+     * @brief The outcome classes of a non-throwing operation.
+     *
+     * Each error code corresponds to the exception the throwing API uses for
+     * the same failure.
+     */
+    enum class StatusCode {
+        OK,            // The operation succeeded.
+        TIMEOUT,       // `TimeoutException`: the instrument did not answer in time.
+        CONNECTION,    // `ConnectionException`: the link is closed or was lost.
+        COMMAND,       // `CommandException`: an I/O error, or a response that does not parse.
+        INSTRUMENT,    // `InstrumentException`: the instrument reported an error.
+        VISA           // `VisaException`: any other failure.
+    };
+
+    /**
+     * @class IoStatus
+     * @brief The status of a non-throwing operation, with a lazily built description.
+     *
+     * A failure is recorded as a status code, the name of the failed operation
+     * and, if the transport reported one, its native status (a `ViStatus` or a
+     * socket error). Nothing is formatted until `description()` is called, so a
+     * routine timeout costs no string building and no call to `viStatusDesc`.
+     *
+     * @code
+     * std::string     response;
+     * cvisa::IoStatus status = instrument.tryQuery("MEAS:VOLT?", response);
+     * if (status.code() == cvisa::StatusCode::TIMEOUT) {
+     *     // The optional instrument is absent; try again next cycle.
+     * } else if (!status) {
+     *     std::cerr << status.description() << std::endl;
+     * }
+     * @endcode
+     */
+    class IoStatus {
+      public:
+        /**
+         * @brief Formats the description of a native status (e.g., with `viStatusDesc`).
+         */
+        typedef std::string (*Describer)(const char* operation, long nativeStatus);
+
+        /**
+         * @brief Creates a successful status.
+         */
+        IoStatus() : m_code(StatusCode::OK), m_operation(nullptr), m_nativeStatus(0), m_describe(nullptr) {}
+
+        /**
+         * @brief Creates a failed status.
+         *
+         * @param code The class of the failure.
+         * @param operation The failed operation (e.g., "viRead"). Must have static storage duration.
+         * @param nativeStatus The status reported by the transport, or 0.
+         * @param describe Formats `nativeStatus` on demand; null uses a generic text.
+         */
+        IoStatus(StatusCode code, const char* operation, long nativeStatus = 0, Describer describe = nullptr)
+            : m_code(code), m_operation(operation), m_nativeStatus(nativeStatus), m_describe(describe) {}
+
+        /**
+         * @brief Creates a failed status from an exception of the throwing API.
+         *
+         * The exception's message becomes the description.
+         */
+        static IoStatus fromException(const VisaException& error);
+
+        /**
+         * @brief Creates a failed status with a ready-made description.
+         */
+        static IoStatus fromMessage(StatusCode code, const std::string& message);
+
+        /// @return True if the operation succeeded.
+        bool ok() const { return m_code == StatusCode::OK; }
+
+        /// @return True if the operation succeeded.
+        explicit operator bool() const { return ok(); }
+
+        /// @return The class of the failure, or `StatusCode::OK`.
+        StatusCode code() const { return m_code; }
+
+        /// @return The failed operation, or null.
+        const char* operation() const { return m_operation; }
+
+        /// @return The status reported by the transport, or 0 if there is none.
+        long nativeStatus() const { return m_nativeStatus; }
+
+        /**
+         * @brief Builds the description of the failure.
+         * @return The same text that the throwing API puts into its exception.
+         */
+        std::string description() const;
+
+        /**
+         * @brief Throws the exception the throwing API would have thrown. Does nothing on success.
+         */
+        void throwIfError() const;
+
+      private:
+        StatusCode  m_code;
+        const char* m_operation;
+        long        m_nativeStatus;
+        Describer   m_describe;
+        std::string m_message;    // Set by `fromException()`; empty otherwise.
+    };
+
+    /**
+     * @class Result
+     * @brief A value or the `IoStatus` of the failure that prevented it.
+     *
+     * Returned by the non-throwing query API (`SCPIBase::tryQuery()`,
+     * `SCPIBase::tryQueryAndParse()`), so callers can handle routine failures
+     * without exception unwinding:
+     *
+     * @code
+     * cvisa::Result<double> volts = psu.tryQueryAndParse<double>(Agilent66xxA::Commands::MEAS_VOLTAGE());
+     * if (volts) {
+     *     log(volts.value());
+     * } else if (volts.status().code() != cvisa::StatusCode::TIMEOUT) {
+     *     volts.status().throwIfError();
+     * }
+     * @endcode
+     *
+     * @tparam T The value type. Must be default-constructible.
+     */
+    template <typename T>
+    class Result {
+      public:
+        /**
+         * @brief Creates a successful result.
+         */
+        Result(T value) : m_value(std::move(value)) {}
+
+        /**
+         * @brief Creates a failed result.
+         */
+        Result(IoStatus status) : m_value(), m_status(std::move(status)) {}
+
+        /// @return True if the result holds a value.
+        bool ok() const { return m_status.ok(); }
+
+        /// @return True if the result holds a value.
+        explicit operator bool() const { return ok(); }
+
+        /**
+         * @brief Returns the value.
+         * @throws The exception of the failure (see `IoStatus::throwIfError()`) if there is no value.
+         */
+        const T& value() const {
+            m_status.throwIfError();
+            return m_value;
+        }
+
+        /**
+         * @brief Returns the value, or `fallback` if the operation failed.
+         */
+        T valueOr(T fallback) const { return ok() ? m_value : fallback; }
+
+        /// @return The status of the operation.
+        const IoStatus& status() const { return m_status; }
+
+      private:
+        T        m_value;
+        IoStatus m_status;
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_RESULT_HPP
@@ -1,125 +1,494 @@
 #include "SCPIBase.hpp"
 
 #include "Exceptions.hpp"
+#include "../utils/utils.hpp"
 
-#include <algorithm>    // For std::find_if_not
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <string>
-
-namespace {
-    // Helper to trim leading/trailing whitespace
-    std::string trim(const std::string& s) {
-        auto start = s.find_first_not_of(" \t\n\r\f\v");
-        if (start == std::string::npos) return "";
-        auto end = s.find_last_not_of(" \t\n\r\f\v");
-        return s.substr(start, (end - start + 1));
-    }
-}    // namespace
+#include <thread>
 
 namespace cvisa {
     namespace drivers {
 
+        namespace {
+            // Longest interval between *ESR? polls when SRQ events are unavailable.
+            const unsigned int s_maxOperationCompletePoll_ms = 50;
+
+            // The error queue query; also the metrics key of automatic error checks.
+            const char* const s_errorQuery = "SYST:ERR?";
+
+            // Most entries drained per check; guards against an instrument that never reports "0".
+            const size_t s_maxErrorQueueEntries = 32;
+
+            // Common commands that leave the settings alone; every other one empties the setting cache.
+            bool keepsSettings(const std::string& header) { return header == "*CLS" || header == "*ESE" || header == "*SRE" || header == "*OPC" || header == "*WAI"; }
+        }    // namespace
+
         // --- Common SCPI Command Implementations ---
 
-        std::string SCPIBase::IDN_Query() { return trim(executeCommand(SCPICommons::IDN_Query())); }
+        static_assert(commandAccepts<uint8_t>(SCPICommons::ESE_Set()), "ESE_Set does not match its argument type.");
+        static_assert(commandAccepts<uint8_t>(SCPICommons::SRE_Set()), "SRE_Set does not match its argument type.");
+
+        std::string SCPIBase::IDN_Query() {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            executeCommandInto(m_response, SCPICommons::IDN_Query());
+            return ResponseParser::trimmed(m_response);
+        }
 
         void SCPIBase::RST() { executeCommand(SCPICommons::RST()); }
 
-        void SCPIBase::CLS() { executeCommand(SCPICommons::CLS()); }
+        void SCPIBase::CLS() {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            executeCommand(SCPICommons::CLS());
+            m_pendingEventStatus = 0;
+        }
 
         void SCPIBase::WAI() { executeCommand(SCPICommons::WAI()); }
 
-        bool SCPIBase::isOperationComplete() { return trim(executeCommand(SCPICommons::OPC_Query())) == "1"; }
+        void SCPIBase::TRG() { executeCommand(SCPICommons::TRG()); }
+
+        bool SCPIBase::isOperationComplete() { return queryAndParse<bool>(SCPICommons::OPC_Query()); }
+
+        int SCPIBase::runSelfTest() { return queryAndParse<int>(SCPICommons::TST_Query()); }
+
+        uint8_t SCPIBase::STB_Query() { return queryRegister(SCPICommons::STB_Query()); }
+
+        uint8_t SCPIBase::ESR_Query() {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            // Include the events a status byte check has read (and so cleared) since the last query.
+            uint8_t value        = static_cast<uint8_t>(queryRegister(SCPICommons::ESR_Query()) | m_pendingEventStatus);
+            m_pendingEventStatus = 0;
+            return value;
+        }
+
+        void SCPIBase::ESE_Set(uint8_t mask) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            executeCommand(SCPICommons::ESE_Set(), mask);
+            m_eventStatusEnable = mask;
+        }
+
+        uint8_t SCPIBase::ESE_Query() { return queryRegister(SCPICommons::ESE_Query()); }
+
+        void SCPIBase::SRE_Set(uint8_t mask) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            executeCommand(SCPICommons::SRE_Set(), mask);
+            m_serviceRequestEnable = mask;
+        }
+
+        uint8_t SCPIBase::SRE_Query() { return queryRegister(SCPICommons::SRE_Query()); }
+
+        bool SCPIBase::waitForOperationComplete(unsigned int timeout_ms) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            // A status byte check would read ESR and consume the OPC event this waits for.
+            ErrorCheckSuspension suspension(*this);
+            if (!(m_eventStatusEnable & EventStatus::OPC)) {
+                ESE_Set(m_eventStatusEnable | EventStatus::OPC);
+            }
 
-        int SCPIBase::runSelfTest() {
-            std::string response = trim(executeCommand(SCPICommons::TST_Query()));
+            bool useServiceRequest = true;
             try {
-                return std::stoi(response);
-            } catch (const std::exception& e) {
-                throw CommandException("Invalid response from self-test query: " + response);
+                enableServiceRequest();
+            } catch (const VisaException&) {
+                useServiceRequest = false;
+                CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Service requests unavailable; polling *ESR? for operation complete.");
+            }
+            if (useServiceRequest && !(m_serviceRequestEnable & StatusByte::ESB)) {
+                SRE_Set(m_serviceRequestEnable | StatusByte::ESB);
+            }
+
+            // Reading ESR clears stale events, so only this *OPC can complete the wait.
+            ESR_Query();
+            if (useServiceRequest) {
+                discardServiceRequests();
+            }
+            executeCommand(SCPICommons::OPC());
+
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+            unsigned int                          poll_ms  = 1;
+            for (;;) {
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    return false;
+                }
+                unsigned int remaining_ms = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+                if (useServiceRequest) {
+                    if (!waitForStatus(StatusByte::ESB, remaining_ms)) {
+                        return false;
+                    }
+                } else {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(std::min(poll_ms, remaining_ms)));
+                    poll_ms = std::min(poll_ms * 2, s_maxOperationCompletePoll_ms);
+                }
+                // Other enabled events also raise ESB; keep waiting until OPC itself is set.
+                if (ESR_Query() & EventStatus::OPC) {
+                    return true;
+                }
             }
         }
 
-        uint8_t SCPIBase::STB_Query() {
-            std::string response = trim(executeCommand(SCPICommons::STB_Query()));
-            try {
-                return static_cast<uint8_t>(std::stoi(response));
-            } catch (const std::exception& e) {
-                throw CommandException("Invalid response for STB_Query: " + response);
+        void SCPIBase::useServiceRequestForQueries(bool enable) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            if (enable) {
+                setWaitForServiceRequest(true);
+                SRE_Set(m_serviceRequestEnable | StatusByte::MAV);
+            } else {
+                setWaitForServiceRequest(false);
+                SRE_Set(m_serviceRequestEnable & static_cast<uint8_t>(~StatusByte::MAV));
             }
         }
 
-        uint8_t SCPIBase::ESR_Query() {
-            std::string response = trim(executeCommand(SCPICommons::ESR_Query()));
-            try {
-                return static_cast<uint8_t>(std::stoi(response));
-            } catch (const std::exception& e) {
-                throw CommandException("Invalid response for ESR_Query: " + response);
+        uint8_t SCPIBase::queryRegister(const SCPICommand& spec) {
+            int value = queryAndParse<int>(spec);
+            if (value < 0 || value > 255) {
+                throw CommandException(std::string("Invalid response for ") + spec.command + ": " + utils::to_string(value));
             }
+            return static_cast<uint8_t>(value);
         }
 
-        void SCPIBase::ESE_Set(uint8_t mask) { executeCommand(SCPICommons::ESE_Set(), mask); }
+        // --- Error Checking ---
 
-        uint8_t SCPIBase::ESE_Query() {
-            std::string response = trim(executeCommand(SCPICommons::ESE_Query()));
-            try {
-                return static_cast<uint8_t>(std::stoi(response));
-            } catch (const std::exception& e) {
-                throw CommandException("Invalid response for ESE_Query: " + response);
-            }
+        constexpr size_t SCPIBase::COMMAND_HISTORY;
+
+        void SCPIBase::enableAutoErrorCheck(bool enable) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            VISACom::enableAutoErrorCheck(enable);
+            m_checkedCommandCount = m_commandCount;
+        }
+
+        void SCPIBase::setErrorCheckMode(ErrorCheckMode mode, unsigned int interval) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            m_errorCheckMode      = mode;
+            m_errorCheckInterval  = interval;
+            m_checkedCommandCount = m_commandCount;
         }
 
-        void SCPIBase::SRE_Set(uint8_t mask) { executeCommand(SCPICommons::SRE_Set(), mask); }
+        void SCPIBase::checkErrors() { readErrorQueue(); }
 
-        uint8_t SCPIBase::SRE_Query() {
-            std::string response = trim(executeCommand(SCPICommons::SRE_Query()));
-            try {
-                return static_cast<uint8_t>(std::stoi(response));
-            } catch (const std::exception& e) {
-                throw CommandException("Invalid response for SRE_Query: " + response);
+        size_t SCPIBase::drainErrorQueue(std::vector<InstrumentError>& errors) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            errors.clear();
+            // An error can only be attributed if a single command was sent since the last check.
+            uint64_t           window  = m_commandCount - m_checkedCommandCount;
+            const std::string* command = window == 1 ? &m_commandHistory[(m_commandCount - 1) % COMMAND_HISTORY] : nullptr;
+
+            while (errors.size() < s_maxErrorQueueEntries) {
+                MetricsScope scope(m_metrics, s_errorQuery);
+                query(s_errorQuery, m_errorResponse);
+                scope.complete();
+                // SCPI standard: "+0,\"No error\"" means no error; the code precedes the first comma.
+                const char* begin = m_errorResponse.data();
+                const char* end   = begin + m_errorResponse.size();
+                const char* comma = begin;
+                while (comma != end && *comma != ',') {
+                    ++comma;
+                }
+                const char* codeBegin = begin;
+                const char* codeEnd   = comma;
+                double      code;
+                ResponseParser::trim(codeBegin, codeEnd);
+                if (!ResponseParser::parseNumber(codeBegin, codeEnd, code) || codeBegin != codeEnd) {
+                    throw InstrumentException("Instrument error: " + ResponseParser::trimmed(m_errorResponse));
+                }
+                if (code == 0) {
+                    break;
+                }
+
+                const char* messageBegin = comma != end ? comma + 1 : end;
+                const char* messageEnd   = end;
+                ResponseParser::trim(messageBegin, messageEnd);
+                if (messageEnd - messageBegin >= 2 && *messageBegin == '"' && messageEnd[-1] == '"') {
+                    ++messageBegin;
+                    --messageEnd;
+                }
+                InstrumentError error = {static_cast<int>(code), std::string(messageBegin, messageEnd), command != nullptr ? *command : std::string()};
+                errors.push_back(error);
             }
+            m_checkedCommandCount = m_commandCount;
+            return errors.size();
+        }
+
+        std::vector<std::string> SCPIBase::getCommandHistory() const {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            uint64_t                 count = std::min<uint64_t>(m_commandCount, COMMAND_HISTORY);
+            std::vector<std::string> history;
+            history.reserve(static_cast<size_t>(count));
+            for (uint64_t i = m_commandCount - count; i < m_commandCount; ++i) {
+                history.push_back(m_commandHistory[i % COMMAND_HISTORY]);
+            }
+            return history;
         }
 
         void SCPIBase::readErrorQueue() {
-            std::string response = query("SYST:ERR?");
-            // SCPI standard: "+0,\"No error\"" means no error.
-            // Anything else is an error. We check for the leading '+0'
-            if (response.find("+0") != 0) {
-                throw InstrumentException("Instrument error: " + trim(response));
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            // Draining marks the candidates as checked, but leaves them in the history ring,
+            // so they are only copied if there is an error to describe.
+            uint64_t window = std::min<uint64_t>(m_commandCount - m_checkedCommandCount, COMMAND_HISTORY);
+            uint64_t last   = m_commandCount;
+
+            std::vector<InstrumentError>& errors = m_errorScratch;
+            if (drainErrorQueue(errors) == 0) {
+                return;
             }
+            m_lastErrors = errors;
+            // A rejected write leaves its setting unknown.
+            m_settingCache.clear();
+
+            std::string message = errors.size() == 1 ? "Instrument error: " : "Instrument errors: ";
+            for (size_t i = 0; i < errors.size(); ++i) {
+                if (i > 0) {
+                    message += "; ";
+                }
+                message += utils::to_string(errors[i].code) + ",\"" + errors[i].message + "\"";
+            }
+            if (window > 0) {
+                message += " (after ";
+                for (uint64_t i = last - window; i < last; ++i) {
+                    message += (i > last - window ? ", \"" : "\"") + m_commandHistory[i % COMMAND_HISTORY] + "\"";
+                }
+                message += ")";
+            }
+            throw InstrumentException(message);
         }
 
-        void SCPIBase::executeCommandChain(const std::vector<SCPICommand>& commands, const std::string& delimiter) {
-            if (commands.empty()) {
-                return;    // Nothing to do
+        void SCPIBase::recordCommand(const std::string& command) {
+            if (m_errorCheckSuspended) {
+                return;    // Internal commands of a check or wait are not error candidates.
+            }
+            m_commandHistory[m_commandCount % COMMAND_HISTORY] = command;
+            ++m_commandCount;
+        }
+
+        void SCPIBase::checkAfterCommand() {
+            if (!m_autoErrorCheckEnabled || m_errorCheckSuspended) {
+                return;
             }
+            switch (m_errorCheckMode) {
+                case ErrorCheckMode::EVERY_COMMAND:
+                    readErrorQueue();
+                    break;
+                case ErrorCheckMode::STATUS_BYTE:
+                    checkStatusByte();
+                    break;
+                case ErrorCheckMode::DEFERRED:
+                    if (m_errorCheckInterval > 0 && m_commandCount - m_checkedCommandCount >= m_errorCheckInterval) {
+                        readErrorQueue();
+                    }
+                    break;
+            }
+        }
 
-            std::string chained_command;
-            for (size_t i = 0; i < commands.size(); ++i) {
-                const auto& spec = commands[i];
+        void SCPIBase::checkStatusByte() {
+            ErrorCheckSuspension suspension(*this);
+            if ((m_eventStatusEnable & EventStatus::ERRORS) != EventStatus::ERRORS) {
+                ESE_Set(m_eventStatusEnable | EventStatus::ERRORS);
+            }
 
-                // Safety checks
-                if (spec.type != CommandType::WRITE) {
-                    throw std::logic_error("executeCommandChain only supports WRITE commands.");
+            uint8_t status = readStatusByte();
+            uint8_t events = 0;
+            if (status & StatusByte::ESB) {
+                // Reading ESR clears it; keep the other events for the next ESR_Query().
+                // `m_response` may hold the answer of the query being checked, so read into the error buffer.
+                const SCPICommand& esrQuery = SCPICommons::ESR_Query();
+                MetricsScope       scope(m_metrics, esrQuery.command);
+                query(esrQuery.command, m_errorResponse);
+                scope.complete();
+                long long value = ResponseParser::parseInteger(m_errorResponse);
+                if (value < 0 || value > 255) {
+                    throw CommandException(std::string("Invalid response for ") + esrQuery.command + ": " + ResponseParser::trimmed(m_errorResponse));
+                }
+                events = static_cast<uint8_t>(value);
+                m_pendingEventStatus |= static_cast<uint8_t>(events & ~EventStatus::ERRORS);
+            }
+            if (!(status & StatusByte::EAV) && !(events & EventStatus::ERRORS)) {
+                m_checkedCommandCount = m_commandCount;
+                return;
+            }
+
+            readErrorQueue();
+            // The error bits were set, but the instrument keeps no queue entry for them.
+            m_settingCache.clear();
+            throw InstrumentException("Instrument reported an error (ESR " + utils::to_string(static_cast<unsigned int>(events)) + ") with an empty error queue.");
+        }
+
+        // --- Setting Cache ---
+
+        void SCPIBase::enableSettingCache(bool enable) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Setting cache " + std::string(enable ? "enabled" : "disabled") + ".");
+            m_settingCacheEnabled = enable;
+            m_settingCache.clear();
+        }
+
+        void SCPIBase::invalidateSettingCache() {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            m_settingCache.clear();
+        }
+
+        uint64_t SCPIBase::getSettingCacheHits() const {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            return m_settingCacheHits;
+        }
+
+        void SCPIBase::invalidateCachedState() { m_settingCache.clear(); }
+
+        void SCPIBase::restoreInstrumentState() {
+            // The instrument may have been power-cycled, which clears both masks.
+            // Runs inside a write or query of `m_commandBuffer`, so it must not format into it.
+            if (m_eventStatusEnable != 0) {
+                write(formatCommand(SCPICommons::ESE_Set().command, m_eventStatusEnable));
+            }
+            if (m_serviceRequestEnable != 0) {
+                write(formatCommand(SCPICommons::SRE_Set().command, m_serviceRequestEnable));
+            }
+        }
+
+        bool SCPIBase::parseSetting(CommandType type) {
+            const std::string& command = m_commandBuffer;
+            m_settingKey.clear();
+            size_t             begin   = command.find_first_not_of(" \t:");
+            if (begin == std::string::npos || command.find(';') != std::string::npos) {
+                return false;    // Compound messages are not cached.
+            }
+            size_t headerEnd = command.find_first_of(" \t", begin);
+            if (headerEnd == std::string::npos) {
+                headerEnd = command.size();
+            }
+            m_settingKey.assign(command, begin, headerEnd - begin);
+            m_settingArguments = command.find_first_not_of(" \t", headerEnd);
+            if (m_settingArguments == std::string::npos) {
+                m_settingArguments = command.size();
+            }
+
+            if (type == CommandType::QUERY) {
+                // Only parameterless queries of a plain header are answered, e.g. "VOLT?" but not "MEAS:VOLT? (@1)".
+                if (m_settingArguments != command.size() || m_settingKey[0] == '*' || m_settingKey[m_settingKey.size() - 1] != '?') {
+                    return false;
                 }
-                if (std::string(spec.command).find('%') != std::string::npos) {
+                m_settingKey.erase(m_settingKey.size() - 1);
+                return true;
+            }
+            return m_settingKey[0] != '*' && m_settingArguments != command.size();
+        }
+
+        bool SCPIBase::lookupSetting(const SCPICommand& spec, std::string& response) {
+            const CommandType type = spec.type;
+            if (type == CommandType::QUERY && !spec.cacheable) {
+                m_settingKey.clear();
+                return false;    // Measurements and states are always read from the instrument.
+            }
+            if (!parseSetting(type) || !spec.cacheable) {
+                // Writes that may change settings we cannot track, e.g. selectors, invalidate everything.
+                if (type == CommandType::WRITE && !keepsSettings(m_settingKey)) {
+                    m_settingCache.clear();
+                }
+                m_settingKey.clear();
+                return false;
+            }
+
+            auto cached = m_settingCache.find(m_settingKey);
+            if (cached == m_settingCache.end()) {
+                return false;
+            }
+            if (type == CommandType::QUERY) {
+                response = cached->second;
+            } else if (cached->second.compare(0, std::string::npos, m_commandBuffer, m_settingArguments, std::string::npos) == 0) {
+                response.clear();
+            } else {
+                // The instrument state is unknown until the new value is written.
+                m_settingCache.erase(cached);
+                return false;
+            }
+            ++m_settingCacheHits;
+            CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Answered from setting cache: " + m_commandBuffer);
+            return true;
+        }
+
+        void SCPIBase::storeSetting() {
+            if (m_settingKey.empty()) {
+                return;
+            }
+            size_t end = m_commandBuffer.find_last_not_of(" \t\r\n");
+            m_settingCache[m_settingKey].assign(m_commandBuffer, m_settingArguments, end + 1 - m_settingArguments);
+        }
+
+        std::vector<std::string> SCPIBase::executeCommandChain(const std::vector<SCPICommand>& commands) {
+            std::vector<std::string> results;
+            if (commands.empty()) {
+                return results;    // Nothing to do
+            }
+
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            // The batch roots every header, so "MEAS:VOLT?;MEAS:CURR?" is not read as "MEAS:MEAS:CURR?".
+            SCPIBatch& batch = m_chainBatch;
+            batch.clear();
+            for (const auto& spec : commands) {
+                // Safety checks
+                if (std::strchr(spec.command, '%') != nullptr) {
                     throw std::logic_error(
                         "executeCommandChain does not support commands with format "
                         "specifiers.");
                 }
+                batch.add(spec);
+            }
 
-                chained_command += spec.command;
-                if (i < commands.size() - 1) {
-                    chained_command += delimiter;
-                }
+            executeBatch(batch);
+            results.reserve(batch.queryCount());
+            for (size_t i = 0; i < batch.queryCount(); ++i) {
+                results.push_back(batch.get<std::string>(i));
             }
+            return results;
+        }
 
-            Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Executing command chain: " + chained_command);
+        void SCPIBase::executeBatch(SCPIBatch& batch) {
+            if (batch.empty()) {
+                return;
+            }
 
-            write(chained_command);
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            MetricsScope                          scope(m_metrics, SessionMetrics::BATCH);
+            CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Executing batch: " + batch.message());
+            recordCommand(batch.message());
+            if (batch.queryCount() < batch.size()) {
+                m_settingCache.clear();
+            }
 
-            if (m_autoErrorCheckEnabled) {
-                readErrorQueue();
+            if (batch.queryCount() == 0) {
+                write(batch.message());
+                batch.m_response.clear();
+            } else {
+                queryMessage(batch.message(), batch.m_response, batch.delayMs());
             }
+            scope.complete();
+
+            // Check the error queue first: a failed command usually explains a short response.
+            checkAfterCommand();
+            batch.parseResponse();
+        }
+
+        void SCPIBase::reserveBuffers(size_t commandBytes, size_t responseBytes) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            m_commandBuffer.reserve(commandBytes);
+            m_settingKey.reserve(commandBytes);
+            for (auto& command : m_commandHistory) command.reserve(commandBytes);
+            m_response.reserve(responseBytes);
+            m_errorResponse.reserve(responseBytes);
+            if (m_readBuffer.size() < responseBytes) m_readBuffer.resize(responseBytes);
+            m_errorScratch.reserve(s_maxErrorQueueEntries);
+        }
+
+        void SCPIBase::releaseBuffers() {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            // Swapping with empty containers frees the storage; shrink_to_fit is only a request.
+            std::string().swap(m_commandBuffer);
+            std::string().swap(m_settingKey);
+            for (auto& command : m_commandHistory) std::string(command).swap(command);
+            std::string().swap(m_response);
+            std::string().swap(m_errorResponse);
+            std::vector<char>().swap(m_readBuffer);
+            std::vector<InstrumentError>().swap(m_errorScratch);
+            m_chainBatch = SCPIBatch();
         }
 
     }    // namespace drivers
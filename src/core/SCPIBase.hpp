@@ -1,22 +1,49 @@
 #ifndef CVISA_INSTRUMENT_DRIVER_HPP
 #define CVISA_INSTRUMENT_DRIVER_HPP
 
+#include "CommandFormatter.hpp"
+#include "ResponseParser.hpp"
+#include "Result.hpp"
+#include "SCPIBatch.hpp"
 #include "SCPICommand.hpp"
 #include "VISACom.hpp"
 #include "Exceptions.hpp"
 #include <type_traits>
 
-#include <cstdio>
+#include <array>
+#include <cstdint>
 #include <future>
+#include <limits>
 #include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace cvisa {
     namespace drivers {
 
+        /**
+         * @enum ErrorCheckMode
+         * @brief How `enableAutoErrorCheck(true)` checks for instrument errors.
+         */
+        enum class ErrorCheckMode {
+            EVERY_COMMAND,    // Read the error queue after every command (one extra round trip each).
+            STATUS_BYTE,      // Read the status byte after every command; read the queue only if it reports an error.
+            DEFERRED          // Read the error queue every N commands and on `checkErrors()`.
+        };
+
+        /**
+         * @struct InstrumentError
+         * @brief One entry of an instrument's error queue.
+         */
+        struct InstrumentError {
+            int         code;       // The SCPI error code, e.g. -222.
+            std::string message;    // The error description, e.g. "Data out of range".
+            std::string command;    // The command it is attributed to, or empty if several are candidates.
+        };
+
         /**
          * @class SCPIBase
          * @brief An abstract base class for creating instrument-specific drivers.
@@ -32,7 +59,8 @@ namespace cvisa {
          * `std::string`).
          * - Implementations for common SCPI commands (e.g., `*IDN_Query?`, `*RST`).
          * - An optional automatic instrument error-checking mechanism.
-         * - Asynchronous query support using `std::future`.
+         * - Asynchronous query support using `std::future`, serialized through a
+         *   per-session request queue.
          *
          * To create a new driver, inherit from this class and define the instrument's
          * specific command set in a nested `Commands` struct.
@@ -61,7 +89,10 @@ namespace cvisa {
             explicit SCPIBase(const std::string& resourceName, unsigned int timeout_ms, char read_termination)
                 : VISACom(resourceName, timeout_ms, read_termination), m_description("Undefined Instrument Driver Name") {}
 
-            virtual ~SCPIBase() = default;
+            /**
+             * @brief Destructor. Completes any queued asynchronous requests first.
+             */
+            virtual ~SCPIBase() { stopCommandQueue(); }
 
             // Disable copy/move operations for drivers to prevent slicing and resource
             // issues.
@@ -82,6 +113,26 @@ namespace cvisa {
              */
             std::string getDescription() const { return m_description; }
 
+            /**
+             * @brief Sets the number of decimals used for floating-point command arguments.
+             *
+             * Applies to `%f`, `%e` and `%g` specifiers that do not give their own
+             * precision (e.g., "VOLT %f"). The default of 6 matches printf.
+             *
+             * @param precision The number of decimals (0 or more).
+             */
+            void setFormatPrecision(int precision) {
+                if (precision < 0) {
+                    throw std::invalid_argument("Format precision must not be negative.");
+                }
+                m_formatPrecision = precision;
+            }
+
+            /**
+             * @brief Returns the number of decimals used for floating-point command arguments.
+             */
+            int getFormatPrecision() const { return m_formatPrecision; }
+
             // --- Common SCPI Commands ---
             /**
              * @brief Queries the instrument's identification string (*IDN_Query?).
@@ -104,6 +155,11 @@ namespace cvisa {
              */
             void WAI();
 
+            /**
+             * @brief Triggers the instrument (*TRG).
+             */
+            void TRG();
+
             /**
              * @brief Queries if the operation is complete (*OPC?).
              * @return True if the operation is complete, false otherwise.
@@ -153,38 +209,279 @@ namespace cvisa {
              */
             uint8_t SRE_Query();
 
+            // --- Error Checking ---
+            /**
+             * @brief Enables or disables automatic error checking in the mode set by `setErrorCheckMode()`.
+             *
+             * Commands sent before enabling are not attributed to later errors.
+             */
+            void enableAutoErrorCheck(bool enable) override;
+
+            /**
+             * @brief Selects how automatic error checks are made.
+             *
+             * Takes effect while `enableAutoErrorCheck(true)` is active:
+             *
+             * - `EVERY_COMMAND` (default) reads `SYST:ERR?` after every command.
+             * - `STATUS_BYTE` reads the status byte instead, which is a serial poll
+             *   without a message exchange on GPIB, USBTMC and VXI-11. The error
+             *   bits are enabled in ESE, and the error queue is only read if EAV or
+             *   ESB is set. When ESB is set, `*ESR?` is read to tell errors from
+             *   other events; its other bits are kept and returned by the next
+             *   `ESR_Query()`.
+             * - `DEFERRED` reads the error queue after every `interval` commands
+             *   and whenever `checkErrors()` is called, e.g. at the end of a
+             *   configuration sequence. With `interval` 0 it only checks in
+             *   `checkErrors()`.
+             *
+             * Every check drains the whole error queue and throws a single
+             * `InstrumentException` listing all entries and the commands that
+             * may have caused them.
+             *
+             * @param mode The checking strategy.
+             * @param interval For `DEFERRED`, the number of commands between checks.
+             */
+            void setErrorCheckMode(ErrorCheckMode mode, unsigned int interval = 16);
+
+            /**
+             * @brief Returns the current error check mode.
+             */
+            ErrorCheckMode getErrorCheckMode() const { return m_errorCheckMode; }
+
+            /**
+             * @brief Drains the error queue and throws if it held any errors.
+             *
+             * Independent of the automatic checks, so it can mark transaction
+             * boundaries in any mode.
+             *
+             * @throws InstrumentException if the instrument reported errors.
+             */
+            void checkErrors();
+
+            /**
+             * @brief Reads every entry of the error queue (`SYST:ERR?` until "0").
+             *
+             * Entries are attributed to the last command if it is the only one
+             * sent since the previous check. Does not throw for instrument errors.
+             *
+             * @param errors Receives the errors, oldest first.
+             * @return The number of errors read.
+             */
+            size_t drainErrorQueue(std::vector<InstrumentError>& errors);
+
+            /**
+             * @brief Returns the errors reported by the last check that found any.
+             */
+            const std::vector<InstrumentError>& getLastErrors() const { return m_lastErrors; }
+
+            /**
+             * @brief Returns up to the last 16 commands sent by this driver, oldest first.
+             */
+            std::vector<std::string> getCommandHistory() const;
+
+            // --- Setting Cache ---
+            /**
+             * @brief Enables or disables the write-through setting cache.
+             *
+             * While enabled, the driver remembers the arguments last written with
+             * each command marked by `SCPICommand::asCachedSetting()`, e.g.
+             * "5.000000" for "VOLT 5.000000":
+             *
+             * - A write whose arguments match the cached ones is not sent.
+             * - A query of the same header without parameters ("VOLT?") is answered
+             *   from the cache until the header is written again.
+             *
+             * Cached answers are the values as written, so do not enable this for
+             * instruments that round or clamp settings, or whose settings change on
+             * their own. Unmarked queries are always sent. The cache is emptied by
+             * `RST()`, `clear()`, connecting and disconnecting, by every unmarked
+             * write (including selectors such as the TA-5000's "SETN 2", triggers
+             * and common commands such as "*RCL"), command chains and batches
+             * that contain writes, and by instrument errors. Raw `write()` and
+             * `query()` calls bypass it; call `invalidateSettingCache()` after them.
+             *
+             * @param enable True to enable the cache, false to disable and empty it.
+             */
+            void enableSettingCache(bool enable = true);
+
+            /**
+             * @brief Returns true if the setting cache is enabled.
+             */
+            bool isSettingCacheEnabled() const { return m_settingCacheEnabled; }
+
+            /**
+             * @brief Empties the setting cache.
+             */
+            void invalidateSettingCache();
+
+            /**
+             * @brief Returns the number of writes and queries the setting cache has saved.
+             */
+            uint64_t getSettingCacheHits() const;
+
+            // --- Service Requests ---
+            /**
+             * @brief Waits until all pending operations are complete, driven by SRQ.
+             *
+             * Sends `*OPC` with the OPC bit enabled in ESE and ESB enabled in SRE, and
+             * returns as soon as the instrument requests service, instead of polling
+             * `isOperationComplete()` or sleeping for a worst-case time. If the
+             * interface has no SRQ events (e.g., raw sockets), `*ESR?` is polled
+             * with a growing interval instead. The OPC and ESB enable bits stay set.
+             *
+             * @param timeout_ms The maximum time to wait in milliseconds.
+             * @return True if the operations completed, false on timeout.
+             */
+            bool waitForOperationComplete(unsigned int timeout_ms);
+
+            /**
+             * @brief Makes query delays wait for "message available" SRQs.
+             *
+             * Enables MAV in the instrument's SRE and switches the session to
+             * `setWaitForServiceRequest()`. Queries defined with a `delay_ms` (e.g.,
+             * a measurement) then read as soon as the response is ready instead of
+             * after the fixed delay.
+             *
+             * @param enable True to wait for SRQ, false to restore fixed delays.
+             * @throws VisaException if the interface does not support SRQ events.
+             */
+            void useServiceRequestForQueries(bool enable);
+
             /**
              * @brief Executes a chain of commands as a single string.
              *
-             * This method is for chaining `WRITE` commands that do not require
-             * arguments. The commands are concatenated with a delimiter and sent as a
-             * single write. It will throw an exception if any command is a `QUERY` or
-             * contains format specifiers.
+             * The commands are joined like an `SCPIBatch`, so every header after the
+             * first is rooted with ':', and sent as a single message. Queries are
+             * allowed; their responses are read back in one read and split into one
+             * string per query. It will throw an exception if any command contains
+             * format specifiers; use `executeBatch()` for formatted commands.
              *
              * @param commands A vector of `SCPICommand` objects to chain.
-             * @param delimiter The delimiter to use between commands (default: ";").
+             * @return The trimmed response of each query, in order. Empty if the chain
+             * contains no queries.
              */
-            void executeCommandChain(const std::vector<SCPICommand>& commands, const std::string& delimiter = ";");
+            std::vector<std::string> executeCommandChain(const std::vector<SCPICommand>& commands);
+
+            /**
+             * @brief Creates an empty batch that formats arguments like this driver.
+             * @return An `SCPIBatch` using the driver's format precision.
+             */
+            SCPIBatch createBatch() const { return SCPIBatch(m_formatPrecision); }
+
+            /**
+             * @brief Executes all commands of a batch in a single round trip.
+             *
+             * The batch's compound message is written once. If it contains queries,
+             * the compound response is read once (after the batch's combined delay)
+             * and split into the batch's results. The automatic error check, if
+             * enabled, runs once for the whole batch.
+             *
+             * @param batch The batch to execute. Receives the results.
+             * @throws CommandException if the number of results does not match the
+             * number of queries.
+             */
+            void executeBatch(SCPIBatch& batch);
+
+            using VISACom::tryQuery;
+
+            /**
+             * @brief Executes a query without throwing on I/O failures.
+             *
+             * The counterpart of `executeCommand()` for polling loops in which
+             * timeouts are routine (e.g., an optional instrument that is switched
+             * off). Transport failures and instrument errors found by the automatic
+             * error check are returned in the `Result` instead of thrown; a timeout
+             * is reported without unwinding and without formatting a message.
+             *
+             * @tparam Args The types of the format arguments.
+             * @param spec The `SCPICommand` to execute.
+             * @param args The arguments to format into the command string.
+             * @return The raw response, or the status of the failure.
+             * @throws CommandException if the arguments do not match the template.
+             */
+            template <typename... Args>
+            Result<std::string> tryQuery(const SCPICommand& spec, Args... args) {
+                std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+                IoStatus                              status = tryExecuteCommandInto(m_response, spec, args...);
+                if (!status) {
+                    return status;
+                }
+                return m_response;
+            }
+
+            /**
+             * @brief Executes a query and parses the response without throwing on failures.
+             *
+             * @code
+             * cvisa::Result<double> temperature = chamber.tryQueryAndParse<double>(ThermalAirTA5000::Commands::getTemperature());
+             * if (temperature) {
+             *     record(temperature.value());
+             * }
+             * @endcode
+             *
+             * @tparam T The desired return type (`double`, `int`, `long long`, `bool`, or `std::string`).
+             * @tparam Args The types of the format arguments.
+             * @param spec The `SCPICommand` for the `QUERY` command.
+             * @param args The arguments to format into the command string.
+             * @return The parsed value, or the status of the failure. A response that does
+             * not parse as `T` is a `StatusCode::COMMAND` failure.
+             * @throws CommandException if the arguments do not match the template.
+             */
+            template <typename T, typename... Args>
+            Result<T> tryQueryAndParse(const SCPICommand& spec, Args... args) {
+                std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+                IoStatus                              status = tryExecuteCommandInto(m_response, spec, args...);
+                if (!status) {
+                    return status;
+                }
+                T value;
+                if (!tryParseResponse(m_response, value)) {
+                    return IoStatus::fromMessage(StatusCode::COMMAND, "Failed to parse instrument response: \"" + ResponseParser::trimmed(m_response) + "\"");
+                }
+                return value;
+            }
+
+            /**
+             * @brief Pre-allocates the session's scratch buffers.
+             *
+             * Commands, responses, error checks, the command history and chain
+             * results are staged in buffers owned by the session, which keep their
+             * capacity, so a steady-state poll or status sweep does not touch the
+             * heap. Reserving them up front also takes the first sweep's
+             * allocations off the I/O path, which matters on controllers where
+             * many sessions allocate concurrently.
+             *
+             * @param commandBytes The longest command expected (also reserved for
+             * every entry of the command history).
+             * @param responseBytes The longest response expected.
+             */
+            void reserveBuffers(size_t commandBytes, size_t responseBytes);
+
+            /**
+             * @brief Frees the session's scratch buffers in one step, e.g. after a large transfer.
+             */
+            void releaseBuffers();
 
           protected:
             std::string m_description;    // A description of the instrument.
 
             /**
              * @brief Safely formats a command string with variadic arguments.
+             *
+             * Uses `CommandFormatter`, so the output does not depend on the C locale
+             * and mismatched arguments throw instead of invoking undefined behavior.
+             *
              * @tparam Args The types of the format arguments.
              * @param cmd_format The command string template (e.g., "VOLT %f").
              * @param args The arguments to format into the command string.
              * @return The formatted command string.
+             * @throws CommandException if the arguments do not match the template.
              */
             template <typename... Args>
             std::string formatCommand(const char* cmd_format, Args... args) {
-                int size = std::snprintf(nullptr, 0, cmd_format, args...);
-                if (size < 0) {
-                    throw std::runtime_error("Error during command formatting: snprintf failed.");
-                }
-                std::vector<char> buffer(size + 1);
-                std::snprintf(buffer.data(), buffer.size(), cmd_format, args...);
-                return std::string(buffer.data());
+                std::string command;
+                CommandFormatter::format(command, cmd_format, m_formatPrecision, args...);
+                return command;
             }
 
             /**
@@ -201,25 +498,101 @@ namespace cvisa {
              */
             template <typename... Args>
             std::string executeCommand(const SCPICommand& spec, Args... args) {
-                std::string command = formatCommand(spec.command, args...);
-                Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Executing command: " + command);
-
                 std::string response;
+                executeCommandInto(response, spec, args...);
+                return response;
+            }
+
+            /**
+             * @brief Executes a command and stores the response in a caller-owned string.
+             *
+             * Behaves like `executeCommand`, but lets the caller reuse the response
+             * buffer across calls so that repeated queries do not allocate.
+             *
+             * @tparam Args The types of the format arguments.
+             * @param response The string that receives the response. It is cleared
+             * for `WRITE` commands.
+             * @param spec The `SCPICommand` object defining the command.
+             * @param args The arguments to format into the command string.
+             */
+            template <typename... Args>
+            void executeCommandInto(std::string& response, const SCPICommand& spec, Args... args) {
+                std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+                CommandFormatter::format(m_commandBuffer, spec.command, m_formatPrecision, args...);
+                if (m_settingCacheEnabled && lookupSetting(spec, response)) {
+                    return;
+                }
+                MetricsScope scope(m_metrics, spec.command);
+                CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Executing command: " + m_commandBuffer);
+                recordCommand(m_commandBuffer);
+
                 if (spec.type == CommandType::WRITE) {
-                    write(command);
+                    write(m_commandBuffer);
+                    response.clear();
+                } else if (m_adaptivePolicy.isEnabled()) {
+                    tryAdaptiveQuery(spec.command, m_commandBuffer, response, 2048, spec.delay_ms, spec.idempotent).throwIfError();
                 } else {
-                    response = query(command, 2048, spec.delay_ms);
+                    query(m_commandBuffer, response, 2048, spec.delay_ms);
+                }
+                // The error check is accounted to its own SYST:ERR? entry.
+                scope.complete();
+                if (m_settingCacheEnabled && spec.type == CommandType::WRITE) {
+                    storeSetting();    // Before the error check, which may format other commands; errors empty the cache.
                 }
+                checkAfterCommand();
+            }
 
-                if (m_autoErrorCheckEnabled) {
-                    readErrorQueue();
+            /**
+             * @brief The non-throwing counterpart of `executeCommandInto()`.
+             *
+             * @param response The string that receives the response. Cleared for
+             * successful `WRITE` commands, unchanged on failure.
+             * @return The status of the command, including the automatic error check.
+             * @throws CommandException if the arguments do not match the template.
+             */
+            template <typename... Args>
+            IoStatus tryExecuteCommandInto(std::string& response, const SCPICommand& spec, Args... args) {
+                std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+                CommandFormatter::format(m_commandBuffer, spec.command, m_formatPrecision, args...);
+                if (m_settingCacheEnabled && lookupSetting(spec, response)) {
+                    return IoStatus();
                 }
+                MetricsScope scope(m_metrics, spec.command);
+                CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Executing command: " + m_commandBuffer);
+                recordCommand(m_commandBuffer);
 
-                return response;
+                IoStatus status;
+                if (spec.type == CommandType::WRITE) {
+                    status = tryWrite(m_commandBuffer);
+                } else if (m_adaptivePolicy.isEnabled()) {
+                    status = tryAdaptiveQuery(spec.command, m_commandBuffer, response, 2048, spec.delay_ms, spec.idempotent);
+                } else {
+                    status = tryQuery(m_commandBuffer, response, 2048, spec.delay_ms);
+                }
+                if (!status) {
+                    return status;
+                }
+                if (spec.type == CommandType::WRITE) {
+                    response.clear();
+                }
+                scope.complete();
+                if (m_settingCacheEnabled && spec.type == CommandType::WRITE) {
+                    storeSetting();
+                }
+                try {
+                    checkAfterCommand();
+                } catch (const VisaException& error) {
+                    return IoStatus::fromException(error);
+                }
+                return status;
             }
 
             /**
              * @brief Executes an asynchronous `QUERY` command.
+             *
+             * The command is formatted on the calling thread and queued on the
+             * session's worker, behind any earlier asynchronous requests.
+             *
              * @tparam Args The types of the format arguments.
              * @param spec The `SCPICommand` for the `QUERY` command.
              * @param args The arguments to format into the command string.
@@ -238,17 +611,41 @@ namespace cvisa {
             }
 
             /**
-             * @brief Checks the instrument's error queue for errors (SYST:ERR?).
+             * @brief Drains the instrument's error queue (SYST:ERR?) and throws if it held errors.
              * @throws InstrumentException if the instrument reports an error.
              */
             void readErrorQueue();
 
+            /**
+             * @brief Drops cached settings when the instrument state may have changed.
+             */
+            void invalidateCachedState() override;
+
+            /**
+             * @brief Writes the ESE and SRE masks again after a reconnect.
+             */
+            void restoreInstrumentState() override;
+
+            /**
+             * @brief Appends a sent command to the history used to attribute errors.
+             */
+            void recordCommand(const std::string& command);
+
+            /**
+             * @brief Runs the automatic error check of the current mode after a command.
+             * @throws InstrumentException if the instrument reports an error.
+             */
+            void checkAfterCommand();
+
             /**
              * @brief Executes a query and parses the response into the specified type.
              *
              * This is a high-level helper that combines `executeCommand` with automatic
              * type parsing.
              *
+             * Numbers and booleans are parsed by `ResponseParser` without copying
+             * the response or depending on the C locale.
+             *
              * @tparam T The desired return type (`double`, `int`, `bool`, or
              * `std::string`).
              * @tparam Args The types of the format arguments.
@@ -258,11 +655,124 @@ namespace cvisa {
              */
             template <typename T, typename... Args>
             T queryAndParse(const SCPICommand& spec, Args... args) {
-                std::string response = executeCommand(spec, args...);
-                return parseResponse<T>(response);
+                std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+                executeCommandInto(m_response, spec, args...);
+                return parseResponse<T>(m_response);
+            }
+
+            /**
+             * @brief Executes a query and parses a comma-separated list of numbers.
+             *
+             * The values are parsed straight from the session's response buffer into
+             * `values`, which keeps its capacity between calls, so polling a list
+             * (e.g., "1.2,3.4,5.6") into the same vector does not allocate.
+             *
+             * @tparam Args The types of the format arguments.
+             * @param values The vector that receives the parsed values.
+             * @param spec The `SCPICommand` for the `QUERY` command.
+             * @param args The arguments to format into the command string.
+             * @return The number of values parsed.
+             * @throws CommandException if an element is not a number.
+             */
+            template <typename... Args>
+            size_t queryAndParseInto(std::vector<double>& values, const SCPICommand& spec, Args... args) {
+                std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+                executeCommandInto(m_response, spec, args...);
+                return ResponseParser::parseDoubleArray(m_response, values);
+            }
+
+            /**
+             * @brief Sends a query and reads the response as soon as the instrument has it ready.
+             *
+             * Instead of the command's fixed `delay_ms`, waits for a service request
+             * on MAV (enabling it in SRE first), so slow operations such as a
+             * triggered measurement return as soon as they finish.
+             *
+             * @tparam T The desired return type (`double`, `int`, `bool`, or
+             * `std::string`).
+             * @tparam Args The types of the format arguments.
+             * @param spec The `SCPICommand` for the `QUERY` command.
+             * @param timeout_ms The maximum time to wait for the response.
+             * @param args The arguments to format into the command string.
+             * @return The parsed response value.
+             * @throws TimeoutException if no response is available within `timeout_ms`.
+             */
+            template <typename T, typename... Args>
+            T queryWhenReady(const SCPICommand& spec, unsigned int timeout_ms, Args... args) {
+                std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+                if (!(m_serviceRequestEnable & StatusByte::MAV)) {
+                    SRE_Set(m_serviceRequestEnable | StatusByte::MAV);
+                }
+                MetricsScope scope(m_metrics, spec.command);
+                CommandFormatter::format(m_commandBuffer, spec.command, m_formatPrecision, args...);
+                CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Executing command when ready: " + m_commandBuffer);
+                recordCommand(m_commandBuffer);
+
+                enableServiceRequest();
+                discardServiceRequests();
+                write(m_commandBuffer);
+                if (!waitForStatus(StatusByte::MAV, timeout_ms)) {
+                    throw TimeoutException("No response to \"" + m_commandBuffer + "\" within " + utils::to_string(timeout_ms) + " ms.");
+                }
+                read(m_response);
+                scope.complete();
+                checkAfterCommand();
+                return parseResponse<T>(m_response);
             }
 
           private:
+            std::string m_commandBuffer;                 // Reusable buffer for formatted commands.
+            std::string m_response;                      // Reusable response buffer for `queryAndParse`.
+            std::string m_errorResponse;                 // Reusable response buffer for `readErrorQueue`.
+            int         m_formatPrecision        = 6;    // Decimals for floating-point arguments without an explicit precision.
+            uint8_t     m_eventStatusEnable      = 0;    // Last value written to ESE (0 at power-on).
+            uint8_t     m_serviceRequestEnable   = 0;    // Last value written to SRE (0 at power-on).
+
+            std::vector<InstrumentError> m_errorScratch;    // Reusable error list for `readErrorQueue`.
+            SCPIBatch                    m_chainBatch;      // Reusable batch for `executeCommandChain`.
+
+            // Automatic error checks
+            static constexpr size_t COMMAND_HISTORY = 16;
+
+            ErrorCheckMode                           m_errorCheckMode      = ErrorCheckMode::EVERY_COMMAND;
+            unsigned int                             m_errorCheckInterval  = 16;       // Commands between `DEFERRED` checks.
+            bool                                     m_errorCheckSuspended = false;    // Set while a composite operation runs.
+            uint8_t                                  m_pendingEventStatus  = 0;        // ESR bits read by a status check, for `ESR_Query()`.
+            std::array<std::string, COMMAND_HISTORY> m_commandHistory;                 // Ring of the last commands sent.
+            uint64_t                                 m_commandCount        = 0;        // Commands recorded in total.
+            uint64_t                                 m_checkedCommandCount = 0;        // Commands covered by the last check.
+            std::vector<InstrumentError>             m_lastErrors;
+
+            // Setting cache
+            bool                                         m_settingCacheEnabled = false;
+            std::unordered_map<std::string, std::string> m_settingCache;                // Header -> arguments last written.
+            std::string                                  m_settingKey;                  // Header of `m_commandBuffer`; reused across commands.
+            size_t                                       m_settingArguments    = 0;    // Offset of the arguments in `m_commandBuffer`.
+            uint64_t                                     m_settingCacheHits    = 0;
+
+            // Splits `m_commandBuffer` into `m_settingKey` and its arguments. False if it cannot be cached.
+            bool parseSetting(CommandType type);
+            // Answers the formatted command from the cache. True if it need not be sent.
+            bool lookupSetting(const SCPICommand& spec, std::string& response);
+            // Records the formatted write after it was sent.
+            void storeSetting();
+
+            // Suspends automatic error checks for the internal commands of a composite operation.
+            class ErrorCheckSuspension {
+              public:
+                explicit ErrorCheckSuspension(SCPIBase& driver) : m_driver(driver), m_previous(driver.m_errorCheckSuspended) { driver.m_errorCheckSuspended = true; }
+                ~ErrorCheckSuspension() { m_driver.m_errorCheckSuspended = m_previous; }
+
+              private:
+                SCPIBase& m_driver;
+                bool      m_previous;
+            };
+
+            // Reads the status byte and drains the error queue if it reports an error.
+            void checkStatusByte();
+            // Builds the message of an `InstrumentException` for `errors`.
+            std::string describeErrors(const std::vector<InstrumentError>& errors) const;
+
             // C++11 Tag Dispatching for Type-Safe Parsing
             template <typename T>
             struct type_tag {};
@@ -274,25 +784,47 @@ namespace cvisa {
 
             std::string parseResponse(type_tag<std::string>, const std::string& response) { return response; }
 
-            double parseResponse(type_tag<double>, const std::string& response) {
-                try {
-                    return std::stod(response);
-                } catch (const std::invalid_argument& e) {
-                    throw CommandException("Failed to parse double from instrument response: \"" + response + "\"");
-                }
-            }
+            double parseResponse(type_tag<double>, const std::string& response) { return ResponseParser::parseDouble(response); }
 
             int parseResponse(type_tag<int>, const std::string& response) {
-                try {
-                    return std::stoi(response);
-                } catch (const std::invalid_argument& e) {
+                long long value = ResponseParser::parseInteger(response);
+                if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
                     throw CommandException("Failed to parse int from instrument response: \"" + response + "\"");
                 }
+                return static_cast<int>(value);
+            }
+
+            bool parseResponse(type_tag<bool>, const std::string& response) { return ResponseParser::parseBool(response); }
+
+            // Non-throwing parsers for `tryQueryAndParse`.
+            static bool tryParseResponse(const std::string& response, std::string& value) {
+                value = response;
+                return true;
+            }
+
+            static bool tryParseResponse(const std::string& response, double& value) {
+                return ResponseParser::tryParseDouble(response.data(), response.data() + response.size(), value);
             }
 
-            bool parseResponse(type_tag<bool>, const std::string& response) {
-                return response.find('1') != std::string::npos || response.find("ON") != std::string::npos;
+            static bool tryParseResponse(const std::string& response, long long& value) {
+                return ResponseParser::tryParseInteger(response.data(), response.data() + response.size(), value);
             }
+
+            static bool tryParseResponse(const std::string& response, int& value) {
+                long long wide;
+                if (!tryParseResponse(response, wide) || wide < std::numeric_limits<int>::min() || wide > std::numeric_limits<int>::max()) {
+                    return false;
+                }
+                value = static_cast<int>(wide);
+                return true;
+            }
+
+            static bool tryParseResponse(const std::string& response, bool& value) {
+                return ResponseParser::tryParseBool(response.data(), response.data() + response.size(), value);
+            }
+
+            // Queries a 0-255 status register value.
+            uint8_t queryRegister(const SCPICommand& spec);
         };
 
     }    // namespace drivers
@@ -0,0 +1,129 @@
+#include "SCPIBatch.hpp"
+
+#include "Exceptions.hpp"
+#include "../utils/utils.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+namespace cvisa {
+
+    namespace {
+        using utils::isDigit;
+        using utils::isSpace;
+
+        // If a definite-length block header ("#<n><length>") starts at `p`, returns the position
+        // just past the block, clamped to `end`. Otherwise returns `p`.
+        const char* skipBlock(const char* p, const char* end) {
+            if (end - p < 2 || p[0] != '#' || !isDigit(p[1]) || p[1] == '0') {
+                return p;
+            }
+            size_t      digits = static_cast<size_t>(p[1] - '0');
+            const char* q      = p + 2;
+            if (static_cast<size_t>(end - q) < digits) {
+                return p;
+            }
+            size_t length = 0;
+            for (size_t i = 0; i < digits; ++i, ++q) {
+                if (!isDigit(*q)) {
+                    return p;
+                }
+                length = length * 10 + static_cast<size_t>(*q - '0');
+            }
+            return static_cast<size_t>(end - q) < length ? end : q + length;
+        }
+    }    // namespace
+
+    void SCPIBatch::clear() {
+        m_message.clear();
+        m_response.clear();
+        m_fields.clear();
+        m_queryCount   = 0;
+        m_commandCount = 0;
+        m_delay_ms     = 0;
+    }
+
+    void SCPIBatch::reserve(size_t messageBytes, size_t responseBytes, size_t results) {
+        m_message.reserve(messageBytes);
+        m_response.reserve(responseBytes);
+        m_fields.reserve(results);
+    }
+
+    size_t SCPIBatch::getArray(size_t index, std::vector<double>& values) const {
+        const char* begin;
+        const char* end;
+        field(index, begin, end);
+        return ResponseParser::parseDoubleArray(begin, end, values);
+    }
+
+    size_t SCPIBatch::splitResponse(const std::string& response, std::vector<Field>& fields) {
+        fields.clear();
+        const char* base  = response.data();
+        const char* begin = base;
+        const char* end   = base + response.size();
+        ResponseParser::trim(begin, end);
+        if (begin == end) {
+            return 0;
+        }
+
+        const char* fieldBegin = begin;
+        char        quote      = '\0';
+        for (const char* p = begin;; ++p) {
+            if (p != end && quote != '\0') {
+                // A doubled quote inside a string toggles twice, so it needs no special case.
+                if (*p == quote) {
+                    quote = '\0';
+                }
+                continue;
+            }
+            if (p != end && (*p == '"' || *p == '\'')) {
+                quote = *p;
+                continue;
+            }
+            if (p != end && *p == '#') {
+                const char* next = skipBlock(p, end);
+                if (next != p) {
+                    p = next - 1;
+                    continue;
+                }
+            }
+            if (p == end || *p == ';') {
+                const char* first = fieldBegin;
+                const char* last  = p;
+                ResponseParser::trim(first, last);
+                Field f = {static_cast<size_t>(first - base), static_cast<size_t>(last - first)};
+                fields.push_back(f);
+                if (p == end) {
+                    break;
+                }
+                fieldBegin = p + 1;
+            }
+        }
+        return fields.size();
+    }
+
+    int SCPIBatch::parse(type_tag<int>, const char* begin, const char* end) {
+        long long value = ResponseParser::parseInteger(begin, end);
+        if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+            throw CommandException("Failed to parse int from instrument response: \"" + std::string(begin, end) + "\"");
+        }
+        return static_cast<int>(value);
+    }
+
+    void SCPIBatch::field(size_t index, const char*& begin, const char*& end) const {
+        if (index >= m_fields.size()) {
+            throw std::out_of_range("SCPIBatch result index out of range.");
+        }
+        begin = m_response.data() + m_fields[index].offset;
+        end   = begin + m_fields[index].length;
+    }
+
+    void SCPIBatch::parseResponse() {
+        size_t count = splitResponse(m_response, m_fields);
+        if (count != m_queryCount) {
+            throw CommandException("Batch response has " + utils::to_string(count) + " results, expected " + utils::to_string(m_queryCount) + ": \""
+                                   + ResponseParser::trimmed(m_response) + "\"");
+        }
+    }
+
+}    // namespace cvisa
@@ -0,0 +1,185 @@
+#ifndef CVISA_SCPI_BATCH_HPP
+#define CVISA_SCPI_BATCH_HPP
+
+#include "CommandFormatter.hpp"
+#include "ResponseParser.hpp"
+#include "SCPICommand.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace cvisa {
+
+    namespace drivers {
+        class SCPIBase;
+    }
+
+    /**
+     * @class SCPIBatch
+     * @brief Builds a compound SCPI message and splits its compound response.
+     *
+     * Commands and queries, including formatted ones, are joined into a single
+     * program message separated by ';' and executed with
+     * `SCPIBase::executeBatch()` in one bus round trip. Every command after the
+     * first is prefixed with ':' (unless it is a '*' common command), so each one
+     * is interpreted from the root of the command tree as if it were sent alone.
+     *
+     * The instrument answers all queries of the message in one response whose
+     * units are separated by ';'. After execution, the results are accessed in
+     * query order with `get<T>(index)`:
+     *
+     * @code
+     * SCPIBatch batch = psu.createBatch();
+     * batch.add(Agilent66xxA::Commands::SET_VOLTAGE(), 5.0)
+     *      .add(Agilent66xxA::Commands::MEAS_VOLTAGE())
+     *      .add(Agilent66xxA::Commands::GET_OUTPUT_STATE());
+     * psu.executeBatch(batch);
+     * double volts = batch.get<double>(0);
+     * bool   on    = batch.get<bool>(1);
+     * @endcode
+     *
+     * A batch can be cleared and refilled; its buffers keep their capacity, so
+     * a batch that is reused for polling does not allocate.
+     */
+    class SCPIBatch {
+      public:
+        /**
+         * @brief A response unit within a response string.
+         */
+        struct Field {
+            size_t offset;    // Offset of the first character.
+            size_t length;    // Number of characters.
+        };
+
+        /**
+         * @brief Creates an empty batch.
+         * @param formatPrecision The number of decimals for floating-point arguments
+         * without an explicit precision (see `SCPIBase::setFormatPrecision()`).
+         */
+        explicit SCPIBatch(int formatPrecision = 6) : m_queryCount(0), m_commandCount(0), m_delay_ms(0), m_formatPrecision(formatPrecision) {}
+
+        /**
+         * @brief Appends a command or query to the batch.
+         *
+         * @tparam Args The types of the format arguments.
+         * @param spec The command definition.
+         * @param args The arguments to format into the command string.
+         * @return This batch, for chaining.
+         * @throws CommandException if the arguments do not match the template.
+         */
+        template <typename... Args>
+        SCPIBatch& add(const SCPICommand& spec, const Args&... args) {
+            CommandFormatter::format(m_scratch, spec.command, m_formatPrecision, args...);
+            if (m_commandCount > 0) {
+                m_message.push_back(';');
+                if (!m_scratch.empty() && m_scratch[0] != '*' && m_scratch[0] != ':') {
+                    m_message.push_back(':');
+                }
+            }
+            m_message.append(m_scratch);
+            ++m_commandCount;
+            if (spec.type == CommandType::QUERY) {
+                ++m_queryCount;
+                m_delay_ms += spec.delay_ms;
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Removes all commands and results, keeping the allocated buffers.
+         */
+        void clear();
+
+        /**
+         * @brief Pre-allocates the batch's buffers, e.g. before a sweep that must not allocate on the I/O path.
+         *
+         * @param messageBytes The expected length of the compound message.
+         * @param responseBytes The expected length of the compound response.
+         * @param results The expected number of queries.
+         */
+        void reserve(size_t messageBytes, size_t responseBytes, size_t results);
+
+        /// @return True if the batch contains no commands.
+        bool empty() const { return m_commandCount == 0; }
+
+        /// @return The number of commands and queries in the batch.
+        size_t size() const { return m_commandCount; }
+
+        /// @return The number of queries in the batch, i.e. the number of expected results.
+        size_t queryCount() const { return m_queryCount; }
+
+        /// @return The compound program message that will be sent.
+        const std::string& message() const { return m_message; }
+
+        /// @return The combined pre-read delay of all queries in the batch.
+        unsigned int delayMs() const { return m_delay_ms; }
+
+        /// @return The raw compound response of the last execution.
+        const std::string& response() const { return m_response; }
+
+        /**
+         * @brief Returns the result of a query, parsed into `T`.
+         *
+         * @tparam T `double`, `int`, `long long`, `bool` or `std::string` (trimmed, raw).
+         * @param index The index of the query among the batch's queries (0-based).
+         * @throws std::out_of_range if there is no such result.
+         * @throws CommandException if the result cannot be parsed as `T`.
+         */
+        template <typename T>
+        T get(size_t index) const {
+            const char* begin;
+            const char* end;
+            field(index, begin, end);
+            return parse(type_tag<T>(), begin, end);
+        }
+
+        /**
+         * @brief Parses a list-valued result (e.g., "1.2,3.4") into `values`.
+         * @return The number of values parsed.
+         */
+        size_t getArray(size_t index, std::vector<double>& values) const;
+
+        /**
+         * @brief Splits a compound response into its ';'-separated units.
+         *
+         * Separators inside quoted strings and IEEE 488.2 definite-length blocks
+         * are ignored. The trailing terminator and whitespace around units are
+         * excluded. `fields` is cleared but keeps its capacity.
+         *
+         * @param response The compound response.
+         * @param fields Receives the position of each unit within `response`.
+         * @return The number of units.
+         */
+        static size_t splitResponse(const std::string& response, std::vector<Field>& fields);
+
+      private:
+        friend class drivers::SCPIBase;
+
+        template <typename T>
+        struct type_tag {};
+
+        static double      parse(type_tag<double>, const char* begin, const char* end) { return ResponseParser::parseDouble(begin, end); }
+        static long long   parse(type_tag<long long>, const char* begin, const char* end) { return ResponseParser::parseInteger(begin, end); }
+        static int         parse(type_tag<int>, const char* begin, const char* end);
+        static bool        parse(type_tag<bool>, const char* begin, const char* end) { return ResponseParser::parseBool(begin, end); }
+        static std::string parse(type_tag<std::string>, const char* begin, const char* end) { return std::string(begin, end); }
+
+        void field(size_t index, const char*& begin, const char*& end) const;
+
+        // Splits `m_response` into results. Throws CommandException if the count does not match.
+        void parseResponse();
+
+        std::string        m_message;            // The compound program message.
+        std::string        m_scratch;            // Reusable buffer for formatting one command.
+        std::string        m_response;           // The compound response of the last execution.
+        std::vector<Field> m_fields;             // Positions of the results in `m_response`.
+        size_t             m_queryCount;         // Number of queries in the batch.
+        size_t             m_commandCount;       // Number of commands and queries in the batch.
+        unsigned int       m_delay_ms;           // Combined pre-read delay.
+        int                m_formatPrecision;    // Decimals for floating-point arguments.
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_SCPI_BATCH_HPP
@@ -0,0 +1,27 @@
+#include "SCPICommand.hpp"
+
+namespace cvisa {
+
+    namespace {
+        // Compile-time table of the common IEEE 488.2 commands.
+        constexpr SCPICommandEntry s_commandTable[] = {
+            {"IDN_Query", SCPICommons::IDN_Query()},
+            {"RST", SCPICommons::RST()},
+            {"CLS", SCPICommons::CLS()},
+            {"TST_Query", SCPICommons::TST_Query()},
+            {"OPC_Query", SCPICommons::OPC_Query()},
+            {"OPC", SCPICommons::OPC()},
+            {"WAI", SCPICommons::WAI()},
+            {"TRG", SCPICommons::TRG()},
+            {"STB_Query", SCPICommons::STB_Query()},
+            {"ESR_Query", SCPICommons::ESR_Query()},
+            {"ESE_Set", SCPICommons::ESE_Set()},
+            {"ESE_Query", SCPICommons::ESE_Query()},
+            {"SRE_Set", SCPICommons::SRE_Set()},
+            {"SRE_Query", SCPICommons::SRE_Query()},
+        };
+    }    // namespace
+
+    SCPICommandTable SCPICommons::table() { return SCPICommandTable(s_commandTable); }
+
+}    // namespace cvisa
@@ -1,7 +1,8 @@
 #ifndef CVISA_COMMAND_HPP
 #define CVISA_COMMAND_HPP
 
-#include <string>
+#include <cstddef>
+#include <cstring>
 
 namespace cvisa {
 
@@ -34,42 +35,110 @@ namespace cvisa {
      * This struct separates the definition of a command—its string template
      * and its fundamental type—from its execution. This allows drivers to define
      * their command sets as data, making them easier to manage and extend.
+     *
+     * `SCPICommand` is a literal type: it only holds pointers to string
+     * literals and scalars, so command definitions are built at compile time
+     * and issuing a command never allocates.
      */
     struct SCPICommand {
         const char*  command;         // The SCPI command string template (e.g., "VOLT %f").
         CommandType  type;            // The type of the command (WRITE or QUERY).
         ResponseType responseType;    // The expected type of the response.
         unsigned int delay_ms;        // Optional delay in ms to wait after a write, before a read.
-        std::string  description;     // A human-readable description of the command.
+        const char*  description;     // A human-readable description of the command.
+        bool         idempotent;      // A QUERY that may be sent again after a timeout (false for destructive reads).
+        bool         cacheable;       // A setting the `SCPIBase` setting cache may remember (see `asCachedSetting()`).
+
+        // C++11 constexpr constructor to provide default values.
+        constexpr SCPICommand(const char* cmd, CommandType t, ResponseType rt = ResponseType::NONE, unsigned int delay = 0, const char* desc = "", bool idem = true,
+                              bool cache = false)
+            : command(cmd), type(t), responseType(rt), delay_ms(delay), description(desc), idempotent(idem), cacheable(cache) {}
+
+        /**
+         * @brief Returns this command marked as a cacheable setting.
+         *
+         * Mark a setter and the query that reads the setting back, spelling the
+         * header the same way in both (e.g., "VOLT %f" and "VOLT?"). Only mark
+         * values that change solely through that setter: not measurements, not
+         * physical states, and not values that depend on a selector command.
+         */
+        constexpr SCPICommand asCachedSetting() const { return SCPICommand(command, type, responseType, delay_ms, description, idempotent, true); }
+    };
+
+    /**
+     * @struct SCPICommandEntry
+     * @brief A named entry of a driver's command table.
+     */
+    struct SCPICommandEntry {
+        const char* name;       // The name of the command accessor (e.g., "SET_VOLTAGE").
+        SCPICommand command;    // The command definition.
+    };
 
-        // C++11 constructor to provide default values.
-        SCPICommand(const char* cmd, CommandType t, ResponseType rt = ResponseType::NONE, unsigned int delay = 0, const std::string& desc = "")
-            : command(cmd), type(t), responseType(rt), delay_ms(delay), description(desc) {}
+    /**
+     * @class SCPICommandTable
+     * @brief A read-only view over a driver's compile-time command table.
+     *
+     * Every driver's `Commands` struct exposes its full command set through a
+     * static `table()` method, which makes the commands available for
+     * introspection and tooling (e.g., generating documentation or validating
+     * command templates) without touching the hot path.
+     */
+    class SCPICommandTable {
+      public:
+        template <size_t N>
+        constexpr SCPICommandTable(const SCPICommandEntry (&entries)[N]) : m_entries(entries), m_count(N) {}
+
+        constexpr const SCPICommandEntry* begin() const { return m_entries; }
+        constexpr const SCPICommandEntry* end() const { return m_entries + m_count; }
+        constexpr size_t                  size() const { return m_count; }
+
+        /**
+         * @brief Looks up a command by its accessor name.
+         * @param name The accessor name (e.g., "SET_VOLTAGE").
+         * @return A pointer to the command, or nullptr if it is not in the table.
+         */
+        const SCPICommand* find(const char* name) const {
+            for (const SCPICommandEntry* entry = begin(); entry != end(); ++entry) {
+                if (std::strcmp(entry->name, name) == 0) return &entry->command;
+            }
+            return nullptr;
+        }
+
+      private:
+        const SCPICommandEntry* m_entries;
+        size_t                  m_count;
     };
 
     /**
      * @struct SCPICommons
      * @brief A struct containing static methods that return SCPICommand objects for
      * common SCPI commands.
+     *
+     * All methods are `constexpr`. `table()` lists the complete command set.
      */
     struct SCPICommons {
         // Common System Commands
-        static SCPICommand IDN_Query() { return SCPICommand("*IDN?", CommandType::QUERY, ResponseType::STRING, 0, "Get identification string."); }
-        static SCPICommand RST() { return SCPICommand("*RST", CommandType::WRITE, ResponseType::NONE, 0, "Perform a system reset."); }
-        static SCPICommand CLS() { return SCPICommand("*CLS", CommandType::WRITE, ResponseType::NONE, 0, "Clear status registers."); }
+        static constexpr SCPICommand IDN_Query() { return SCPICommand("*IDN?", CommandType::QUERY, ResponseType::STRING, 0, "Get identification string."); }
+        static constexpr SCPICommand RST() { return SCPICommand("*RST", CommandType::WRITE, ResponseType::NONE, 0, "Perform a system reset."); }
+        static constexpr SCPICommand CLS() { return SCPICommand("*CLS", CommandType::WRITE, ResponseType::NONE, 0, "Clear status registers."); }
 
         // Synchronization Commands
-        static SCPICommand TST_Query() { return SCPICommand("*TST?", CommandType::QUERY, ResponseType::INTEGER, 0, "Initiate a self-test."); }
-        static SCPICommand OPC_Query() { return SCPICommand("*OPC?", CommandType::QUERY, ResponseType::INTEGER, 0, "Operation complete query."); }
-        static SCPICommand WAI() { return SCPICommand("*WAI", CommandType::WRITE, ResponseType::NONE, 0, "Wait for operation complete."); }
+        static constexpr SCPICommand TST_Query() { return SCPICommand("*TST?", CommandType::QUERY, ResponseType::INTEGER, 0, "Initiate a self-test.", false); }
+        static constexpr SCPICommand OPC_Query() { return SCPICommand("*OPC?", CommandType::QUERY, ResponseType::INTEGER, 0, "Operation complete query."); }
+        static constexpr SCPICommand OPC() { return SCPICommand("*OPC", CommandType::WRITE, ResponseType::NONE, 0, "Set OPC in ESR when pending operations complete."); }
+        static constexpr SCPICommand WAI() { return SCPICommand("*WAI", CommandType::WRITE, ResponseType::NONE, 0, "Wait for operation complete."); }
+        static constexpr SCPICommand TRG() { return SCPICommand("*TRG", CommandType::WRITE, ResponseType::NONE, 0, "Trigger the instrument."); }
 
         // Status Reporting Commands
-        static SCPICommand STB_Query() { return SCPICommand("*STB?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get status byte."); }
-        static SCPICommand ESR_Query() { return SCPICommand("*ESR?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get event status register."); }
-        static SCPICommand ESE_Set() { return SCPICommand("*ESE %d", CommandType::WRITE, ResponseType::NONE, 0, "Set event status enable."); }
-        static SCPICommand ESE_Query() { return SCPICommand("*ESE?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get event status enable."); }
-        static SCPICommand SRE_Set() { return SCPICommand("*SRE %d", CommandType::WRITE, ResponseType::NONE, 0, "Set service request enable."); }
-        static SCPICommand SRE_Query() { return SCPICommand("*SRE?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get service request enable."); }
+        static constexpr SCPICommand STB_Query() { return SCPICommand("*STB?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get status byte."); }
+        static constexpr SCPICommand ESR_Query() { return SCPICommand("*ESR?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get event status register.", false); }
+        static constexpr SCPICommand ESE_Set() { return SCPICommand("*ESE %d", CommandType::WRITE, ResponseType::NONE, 0, "Set event status enable."); }
+        static constexpr SCPICommand ESE_Query() { return SCPICommand("*ESE?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get event status enable."); }
+        static constexpr SCPICommand SRE_Set() { return SCPICommand("*SRE %d", CommandType::WRITE, ResponseType::NONE, 0, "Set service request enable."); }
+        static constexpr SCPICommand SRE_Query() { return SCPICommand("*SRE?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get service request enable."); }
+
+        // Introspection
+        static SCPICommandTable table();
     };
 
 }    // namespace cvisa
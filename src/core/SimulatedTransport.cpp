@@ -0,0 +1,383 @@
+#include "SimulatedTransport.hpp"
+
+#include "CommandFormatter.hpp"
+#include "Exceptions.hpp"
+#include "VISACom.hpp"
+#include "../utils/utils.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace cvisa {
+
+    namespace {
+        const char* const s_identity = "cvisa,SimulatedInstrument,0,1.0";
+        const char* const s_noError  = "+0,\"No error\"";
+
+        using utils::isSpace;
+        using utils::toUpper;
+
+        // Upper-cases a query or header and drops a leading ':'.
+        std::string normalized(const std::string& text) {
+            size_t begin = 0;
+            while (begin < text.size() && (isSpace(text[begin]) || text[begin] == ':')) ++begin;
+            std::string key(text, begin);
+            std::transform(key.begin(), key.end(), key.begin(), toUpper);
+            while (!key.empty() && isSpace(key[key.size() - 1])) key.erase(key.size() - 1);
+            return key;
+        }
+
+        uint8_t parseRegister(const std::string& arguments) { return static_cast<uint8_t>(std::strtol(arguments.c_str(), nullptr, 10)); }
+    }    // namespace
+
+    SimulatedTransport::SimulatedTransport()
+        : m_defaultResponse("0"),
+          m_writeLatency(Clock::duration::zero()),
+          m_responseLatency(Clock::duration::zero()),
+          m_open(false),
+          m_linkLost(false),
+          m_failedOpens(0),
+          m_openCount(0),
+          m_timeout(std::chrono::milliseconds(2000)),
+          m_readTermination('\n'),
+          m_readTerminationEnabled(false),
+          m_writeTermination('\n'),
+          m_messageCount(0),
+          m_triggerCount(0),
+          m_eventStatus(0),
+          m_eventStatusEnable(0),
+          m_serviceRequestEnable(0),
+          m_serviceRequestEnabled(false),
+          m_requestActive(false),
+          m_requestQueued(false) {}
+
+    // --- Script ---
+
+    void SimulatedTransport::setResponse(const std::string& query, const std::string& response, unsigned int latency_us) {
+        Response entry = {response, latency_us};
+        m_responses[normalized(query)] = entry;
+    }
+
+    void SimulatedTransport::queueError(int code, const std::string& message) {
+        std::string entry;
+        CommandFormatter::appendInteger(entry, code);
+        entry += ",\"" + message + "\"";
+        m_errors.push_back(entry);
+
+        if (code <= -100 && code > -200) {
+            m_eventStatus |= EventStatus::CME;
+        } else if (code <= -200 && code > -300) {
+            m_eventStatus |= EventStatus::EXE;
+        } else if (code <= -400 && code > -500) {
+            m_eventStatus |= EventStatus::QYE;
+        } else {
+            m_eventStatus |= EventStatus::DDE;
+        }
+        updateServiceRequest();
+    }
+
+    std::string SimulatedTransport::setting(const std::string& header) const {
+        auto found = m_settings.find(normalized(header));
+        return found != m_settings.end() ? found->second : std::string();
+    }
+
+    // --- Session ---
+
+    void SimulatedTransport::dropConnection() {
+        m_linkLost = true;
+        m_output.clear();
+        updateServiceRequest();
+    }
+
+    void SimulatedTransport::open(const std::string& resourceName) {
+        if (m_failedOpens > 0) {
+            --m_failedOpens;
+            throw ConnectionException("Failed to connect to instrument: " + resourceName + " (simulated failure)");
+        }
+        m_resourceName = resourceName;
+        m_open         = true;
+        m_linkLost     = false;
+        ++m_openCount;
+    }
+
+    void SimulatedTransport::close() {
+        m_open = false;
+        m_output.clear();
+        m_serviceRequestEnabled = false;
+        m_requestActive         = false;
+        m_requestQueued         = false;
+    }
+
+    void SimulatedTransport::setReadTermination(char termChar, bool enable) {
+        m_readTermination        = termChar;
+        m_readTerminationEnabled = enable;
+    }
+
+    void SimulatedTransport::resetConfiguration() {
+        m_timeout                = std::chrono::milliseconds(2000);
+        m_readTermination        = '\n';
+        m_readTerminationEnabled = false;
+        m_writeTermination       = '\n';
+    }
+
+    // --- I/O ---
+
+    size_t SimulatedTransport::write(const char* data, size_t size) {
+        if (!m_open) throw ConnectionException("Simulated instrument is not open.");
+        if (m_linkLost) throw ConnectionException("Connection to simulated instrument " + m_resourceName + " was lost.");
+        if (m_writeLatency > Clock::duration::zero()) waitUntil(Clock::now() + m_writeLatency);
+
+        ++m_messageCount;
+        m_lastMessage.assign(data, size);
+        while (!m_lastMessage.empty() && (m_lastMessage[m_lastMessage.size() - 1] == m_writeTermination || isSpace(m_lastMessage[m_lastMessage.size() - 1]))) {
+            m_lastMessage.erase(m_lastMessage.size() - 1);
+        }
+
+        // Split the message into units at ';' outside quoted strings.
+        m_answer.clear();
+        bool            answered = false;
+        Clock::duration latency  = m_responseLatency;
+        const char*     begin    = m_lastMessage.data();
+        const char*     end      = begin + m_lastMessage.size();
+        const char*     unit     = begin;
+        char            quote    = 0;
+        for (const char* p = begin; p != end; ++p) {
+            if (quote != 0) {
+                if (*p == quote) quote = 0;
+            } else if (*p == '"' || *p == '\'') {
+                quote = *p;
+            } else if (*p == ';') {
+                execute(unit, p, answered, latency);
+                unit = p + 1;
+            }
+        }
+        execute(unit, end, answered, latency);
+
+        if (answered) {
+            m_answer += '\n';
+            Message message = {m_answer, 0, Clock::now() + latency};
+            m_output.push_back(message);
+        }
+        updateServiceRequest();
+        return size;
+    }
+
+    size_t SimulatedTransport::read(char* buffer, size_t capacity, bool& end) {
+        if (!m_open) throw ConnectionException("Simulated instrument is not open.");
+        if (m_linkLost) throw ConnectionException("Connection to simulated instrument " + m_resourceName + " was lost.");
+        if (!responseWithinTimeout()) {
+            waitUntil(Clock::now() + m_timeout);
+            throw TimeoutException("Simulated instrument " + m_resourceName + " has no response pending.");
+        }
+
+        Message& message = m_output.front();
+        waitUntil(message.readyAt);
+
+        size_t available = message.data.size() - message.offset;
+        size_t count     = std::min(capacity, available);
+        end              = false;
+        if (m_readTerminationEnabled) {
+            const char* first = message.data.data() + message.offset;
+            const void* term  = std::memchr(first, m_readTermination, count);
+            if (term != nullptr) {
+                count = static_cast<size_t>(static_cast<const char*>(term) - first) + 1;
+                end   = true;
+            }
+        }
+        std::memcpy(buffer, message.data.data() + message.offset, count);
+        message.offset += count;
+        if (message.offset == message.data.size()) {
+            end = true;
+            m_output.pop_front();
+            updateServiceRequest();
+        }
+        return count;
+    }
+
+    IoStatus SimulatedTransport::tryRead(char* buffer, size_t capacity, bool& end, size_t& count) {
+        if (m_open && !m_linkLost && !responseWithinTimeout()) {
+            waitUntil(Clock::now() + m_timeout);
+            count = 0;
+            return IoStatus(StatusCode::TIMEOUT, "read");
+        }
+        return Transport::tryRead(buffer, capacity, end, count);
+    }
+
+    // --- Instrument Control & Status ---
+
+    void SimulatedTransport::clear() {
+        m_output.clear();
+        updateServiceRequest();
+    }
+
+    uint8_t SimulatedTransport::readStatusByte() { return static_cast<uint8_t>(statusSummary(true) | (m_requestActive ? StatusByte::RQS : 0)); }
+
+    void SimulatedTransport::assertTrigger() {
+        if (!m_open) throw ConnectionException("Simulated instrument is not open.");
+        if (m_linkLost) throw ConnectionException("Connection to simulated instrument " + m_resourceName + " was lost.");
+        ++m_triggerCount;
+    }
+
+    // --- Service Requests ---
+
+    void SimulatedTransport::disableServiceRequest() {
+        m_serviceRequestEnabled = false;
+        m_requestQueued         = false;
+    }
+
+    bool SimulatedTransport::waitForServiceRequest(unsigned int timeout_ms) {
+        if (!m_serviceRequestEnabled) throw VisaException("Service requests are not enabled on the simulated instrument.");
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+        if (m_requestQueued && m_requestTime <= deadline) {
+            waitUntil(m_requestTime);
+            m_requestQueued = false;
+            return true;
+        }
+        waitUntil(deadline);
+        return false;
+    }
+
+    // --- Private Helpers ---
+
+    bool SimulatedTransport::responseWithinTimeout() const { return !m_output.empty() && m_output.front().readyAt <= Clock::now() + m_timeout; }
+
+    void SimulatedTransport::execute(const char* begin, const char* end, bool& answered, Clock::duration& latency) {
+        while (begin != end && (isSpace(*begin) || *begin == ':')) ++begin;
+        while (end != begin && isSpace(end[-1])) --end;
+        if (begin == end) return;
+
+        const char* headerEnd = begin;
+        while (headerEnd != end && !isSpace(*headerEnd)) ++headerEnd;
+
+        m_unit.assign(begin, headerEnd);
+        std::transform(m_unit.begin(), m_unit.end(), m_unit.begin(), toUpper);
+        if (m_unit[m_unit.size() - 1] == '?') {
+            if (answered) m_answer += ';';
+            answered = true;
+            if (headerEnd != end) {
+                // Keep the parameters of a query such as "MEAS:VOLT? (@1)".
+                m_unit.append(headerEnd, end);
+                std::transform(m_unit.begin(), m_unit.end(), m_unit.begin(), toUpper);
+            }
+            answerQuery(m_unit, latency);
+        } else {
+            const char* arguments = headerEnd;
+            while (arguments != end && isSpace(*arguments)) ++arguments;
+            executeCommand(m_unit, std::string(arguments, end));
+        }
+    }
+
+    void SimulatedTransport::answerQuery(const std::string& query, Clock::duration& latency) {
+        auto scripted = m_responses.find(query);
+        if (scripted == m_responses.end()) {
+            size_t space = query.find(' ');
+            if (space != std::string::npos) scripted = m_responses.find(query.substr(0, space));
+        }
+        if (scripted != m_responses.end()) {
+            m_answer += scripted->second.text;
+            if (scripted->second.latency_us > 0) latency = std::max<Clock::duration>(latency, std::chrono::microseconds(scripted->second.latency_us));
+            return;
+        }
+
+        if (m_queryHandler) {
+            std::string response;
+            if (m_queryHandler(query, response)) {
+                m_answer += response;
+                return;
+            }
+        }
+
+        if (answerCommonQuery(query)) return;
+
+        auto setting = m_settings.find(query.substr(0, query.find('?')));
+        m_answer += setting != m_settings.end() ? setting->second : m_defaultResponse;
+    }
+
+    bool SimulatedTransport::answerCommonQuery(const std::string& query) {
+        if (query == "*IDN?") {
+            m_answer += s_identity;
+        } else if (query == "*OPC?") {
+            m_answer += '1';
+        } else if (query == "*TST?") {
+            m_answer += '0';
+        } else if (query == "*ESR?") {
+            // Reading the event status register clears it.
+            CommandFormatter::appendUnsigned(m_answer, m_eventStatus);
+            m_eventStatus = 0;
+        } else if (query == "*ESE?") {
+            CommandFormatter::appendUnsigned(m_answer, m_eventStatusEnable);
+        } else if (query == "*SRE?") {
+            CommandFormatter::appendUnsigned(m_answer, m_serviceRequestEnable);
+        } else if (query == "*STB?") {
+            CommandFormatter::appendUnsigned(m_answer, statusSummary(true));
+        } else if (query == "SYST:ERR?" || query == "SYSTEM:ERROR?" || query == "SYST:ERR:NEXT?") {
+            if (m_errors.empty()) {
+                m_answer += s_noError;
+            } else {
+                m_answer += m_errors.front();
+                m_errors.pop_front();
+            }
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void SimulatedTransport::executeCommand(const std::string& header, const std::string& arguments) {
+        if (header == "*CLS") {
+            m_eventStatus = 0;
+            m_errors.clear();
+        } else if (header == "*ESE") {
+            m_eventStatusEnable = parseRegister(arguments);
+        } else if (header == "*SRE") {
+            m_serviceRequestEnable = parseRegister(arguments);
+        } else if (header == "*OPC") {
+            // Nothing is ever pending, so the operation completes immediately.
+            m_eventStatus |= EventStatus::OPC;
+        } else if (header == "*TRG") {
+            ++m_triggerCount;
+        } else if (header == "*RST") {
+            m_settings.clear();
+        } else if (!arguments.empty() && header[0] != '*') {
+            m_settings[header] = arguments;
+        }
+    }
+
+    uint8_t SimulatedTransport::statusSummary(bool requireReady) const {
+        uint8_t summary = 0;
+        if (!m_output.empty() && (!requireReady || m_output.front().readyAt <= Clock::now())) summary |= StatusByte::MAV;
+        if (!m_errors.empty()) summary |= StatusByte::EAV;
+        if (m_eventStatus & m_eventStatusEnable) summary |= StatusByte::ESB;
+        return summary;
+    }
+
+    void SimulatedTransport::updateServiceRequest() {
+        uint8_t summary = statusSummary(false);
+        bool    active  = (summary & m_serviceRequestEnable) != 0;
+        if (active && !m_requestActive) {
+            // A request for a pending response is raised once the response is available.
+            bool onlyMessage = (summary & m_serviceRequestEnable) == StatusByte::MAV;
+            m_requestTime    = onlyMessage ? m_output.front().readyAt : Clock::now();
+            m_requestQueued  = m_serviceRequestEnabled;
+        }
+        m_requestActive = active;
+    }
+
+    void SimulatedTransport::waitUntil(Clock::time_point deadline) {
+        // Sleep for the bulk of long waits and spin for the rest, so that short
+        // latencies are reproduced to within microseconds.
+        for (;;) {
+            Clock::time_point now = Clock::now();
+            if (now >= deadline) return;
+            Clock::duration remaining = deadline - now;
+            if (remaining > std::chrono::milliseconds(2)) {
+                std::this_thread::sleep_for(remaining - std::chrono::milliseconds(1));
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+}    // namespace cvisa
@@ -0,0 +1,225 @@
+#ifndef CVISA_SIMULATED_TRANSPORT_HPP
+#define CVISA_SIMULATED_TRANSPORT_HPP
+
+#include "Transport.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace cvisa {
+
+    /**
+     * @class SimulatedTransport
+     * @brief An in-process instrument that answers from a script.
+     *
+     * Lets drivers run without hardware or a VISA installation, e.g. to
+     * benchmark the library's own formatting, parsing and logging overhead, or
+     * to exercise a driver in CI. Every written message is split into its
+     * program message units (separated by ';'), and each query is answered in
+     * this order:
+     *
+     * 1. A response scripted with `setResponse()` for the full query or its
+     *    header (the text before the first space), ignoring case and a leading ':'.
+     * 2. The query handler set with `setQueryHandler()`.
+     * 3. The built-in IEEE 488.2 model: `*IDN?`, `*OPC?`, `*TST?`, `*ESR?`,
+     *    `*ESE?`, `*SRE?`, `*STB?` and `SYST:ERR?` (see `queueError()`).
+     * 4. The last value written to the same header, so that "VOLT 5" followed
+     *    by "VOLT?" returns "5".
+     * 5. The default response (`setDefaultResponse()`).
+     *
+     * The answers to one message are joined with ';' and terminated with '\n'.
+     * Responses become readable after their latency; reading earlier blocks
+     * until then, or times out if the response would arrive after the
+     * timeout, in which case it stays queued like a late answer from a real
+     * instrument. Service requests are raised when responses become available,
+     * so SRQ-driven code paths see realistic timing. All latencies default to
+     * zero, which runs drivers at full speed.
+     *
+     * Like every transport, it is not thread-safe. Script it before connecting
+     * or from the thread that drives the session.
+     */
+    class SimulatedTransport : public Transport {
+      public:
+        /**
+         * @brief Answers a query unit. Returns false to fall through to the next rule.
+         */
+        typedef std::function<bool(const std::string& query, std::string& response)> QueryHandler;
+
+        SimulatedTransport();
+
+        // --- Script ---
+        /**
+         * @brief Scripts the response to a query.
+         *
+         * @param query The query (e.g., "MEAS:VOLT?") or its header.
+         * @param response The response without the terminator. May contain
+         * binary data, e.g. an IEEE 488.2 block.
+         * @param latency_us The time until the response is available, like a
+         * measurement's duration. 0 uses the default response latency.
+         */
+        void setResponse(const std::string& query, const std::string& response, unsigned int latency_us = 0);
+
+        /**
+         * @brief Sets a handler consulted for queries without a scripted response.
+         */
+        void setQueryHandler(QueryHandler handler) { m_queryHandler = handler; }
+
+        /**
+         * @brief Sets the response to queries that no rule answers (default "0").
+         */
+        void setDefaultResponse(const std::string& response) { m_defaultResponse = response; }
+
+        /**
+         * @brief Sets the time every `write()` takes, simulating bus transfer time.
+         */
+        void setWriteLatency(unsigned int latency_us) { m_writeLatency = std::chrono::microseconds(latency_us); }
+
+        /**
+         * @brief Sets the default time until a response is available.
+         */
+        void setResponseLatency(unsigned int latency_us) { m_responseLatency = std::chrono::microseconds(latency_us); }
+
+        /**
+         * @brief Appends an error to the queue reported by `SYST:ERR?`.
+         *
+         * Like a SCPI instrument, sets the event status bit of the error's
+         * class (CME for -1xx, EXE for -2xx, DDE for -3xx and device-specific
+         * errors, QYE for -4xx), and the status byte reports EAV while the
+         * queue is not empty.
+         */
+        void queueError(int code, const std::string& message);
+
+        /**
+         * @brief Returns the last value written to a header, or an empty string.
+         */
+        std::string setting(const std::string& header) const;
+
+        /**
+         * @brief Returns the number of messages written since construction.
+         */
+        size_t messageCount() const { return m_messageCount; }
+
+        /**
+         * @brief Returns the last message written, without its terminator.
+         */
+        const std::string& lastMessage() const { return m_lastMessage; }
+
+        /**
+         * @brief Simulates a lost link, like `VI_ERROR_CONN_LOST`.
+         *
+         * The session still reports being open, but pending responses are
+         * discarded and every write and read throws `ConnectionException` until
+         * the session is opened again.
+         */
+        void dropConnection();
+
+        /**
+         * @brief Makes the next `count` calls of `open()` throw `ConnectionException`.
+         */
+        void failOpens(unsigned int count) { m_failedOpens = count; }
+
+        /**
+         * @brief Returns the number of successful `open()` calls since construction.
+         */
+        size_t openCount() const { return m_openCount; }
+
+        /**
+         * @brief Returns the number of device triggers (`assertTrigger()` and `*TRG`) since construction.
+         */
+        size_t triggerCount() const { return m_triggerCount; }
+
+        // --- Transport ---
+        void open(const std::string& resourceName) override;
+        void close() override;
+        bool isOpen() const override { return m_open; }
+
+        void setTimeout(unsigned int timeout_ms) override { m_timeout = std::chrono::milliseconds(timeout_ms); }
+        void setReadTermination(char termChar, bool enable) override;
+        bool isReadTerminationEnabled() const override { return m_readTerminationEnabled; }
+        void setWriteTermination(char termChar) override { m_writeTermination = termChar; }
+        void resetConfiguration() override;
+
+        size_t   write(const char* data, size_t size) override;
+        size_t   read(char* buffer, size_t capacity, bool& end) override;
+        IoStatus tryRead(char* buffer, size_t capacity, bool& end, size_t& count) override;
+
+        void    clear() override;
+        uint8_t readStatusByte() override;
+        void    assertTrigger() override;
+
+        void enableServiceRequest() override { m_serviceRequestEnabled = true; }
+        void disableServiceRequest() override;
+        void discardServiceRequests() override { m_requestQueued = false; }
+        bool waitForServiceRequest(unsigned int timeout_ms) override;
+
+      private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Response {
+            std::string  text;
+            unsigned int latency_us;
+        };
+
+        struct Message {
+            std::string       data;
+            size_t            offset;
+            Clock::time_point readyAt;
+        };
+
+        // Handles one program message unit; appends a query's answer to `m_answer`.
+        void execute(const char* begin, const char* end, bool& answered, Clock::duration& latency);
+        void answerQuery(const std::string& query, Clock::duration& latency);
+        bool answerCommonQuery(const std::string& query);
+        void executeCommand(const std::string& header, const std::string& arguments);
+
+        // True if the next response is readable within the timeout.
+        bool    responseWithinTimeout() const;
+        uint8_t statusSummary(bool requireReady) const;
+        void    updateServiceRequest();
+        static void waitUntil(Clock::time_point deadline);
+
+        // Script
+        std::unordered_map<std::string, Response> m_responses;    // Keyed by upper-case query.
+        std::map<std::string, std::string>        m_settings;     // Keyed by upper-case header.
+        std::deque<std::string>                   m_errors;
+        QueryHandler                              m_queryHandler;
+        std::string                               m_defaultResponse;
+        Clock::duration                           m_writeLatency;
+        Clock::duration                           m_responseLatency;
+
+        // Session
+        bool                      m_open;
+        bool                      m_linkLost;       // Set by `dropConnection()` until the next `open()`.
+        unsigned int              m_failedOpens;    // Opens that still fail.
+        size_t                    m_openCount;
+        std::string               m_resourceName;
+        Clock::duration           m_timeout;
+        char                      m_readTermination;
+        bool                      m_readTerminationEnabled;
+        char                      m_writeTermination;
+        std::deque<Message>       m_output;
+        size_t                    m_messageCount;
+        size_t                    m_triggerCount;
+        std::string               m_lastMessage;
+        std::string               m_unit;      // Reusable upper-case copy of the current unit.
+        std::string               m_answer;    // Reusable response being assembled.
+
+        // IEEE 488.2 status model
+        uint8_t           m_eventStatus;          // ESR
+        uint8_t           m_eventStatusEnable;    // ESE
+        uint8_t           m_serviceRequestEnable; // SRE
+        bool              m_serviceRequestEnabled;
+        bool              m_requestActive;        // The SRQ line is asserted.
+        bool              m_requestQueued;        // An SRQ event is waiting to be picked up.
+        Clock::time_point m_requestTime;          // When the queued SRQ was raised.
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_SIMULATED_TRANSPORT_HPP
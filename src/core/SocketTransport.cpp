@@ -0,0 +1,476 @@
+#include "SocketTransport.hpp"
+
+#include "Exceptions.hpp"
+#include "ResponseParser.hpp"
+#include "../utils/utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace cvisa {
+
+    namespace {
+        // Large enough for a full response line of most instruments.
+        const size_t s_receiveBufferSize = 65536;
+
+        // VISA's default I/O timeout, used until the session configures one.
+        const unsigned int s_defaultTimeout_ms = 2000;
+
+#ifdef _WIN32
+        typedef WSAPOLLFD PollDescriptor;
+        typedef int       IoResult;
+
+        const SocketTransport::NativeSocket s_invalidSocket = INVALID_SOCKET;
+
+        // Winsock must be initialized once per process before the first call.
+        void startup() {
+            struct Winsock {
+                Winsock() {
+                    WSADATA data;
+                    WSAStartup(MAKEWORD(2, 2), &data);
+                }
+                ~Winsock() { WSACleanup(); }
+            };
+            static Winsock winsock;
+        }
+
+        int  lastError() { return WSAGetLastError(); }
+        bool isInterrupted(int error) { return error == WSAEINTR; }
+        bool isInProgress(int error) { return error == WSAEWOULDBLOCK || error == WSAEINPROGRESS; }
+        bool isTimeout(int error) { return error == WSAETIMEDOUT || error == WSAEWOULDBLOCK; }
+        std::string errorText(int error) { return "Winsock error " + utils::to_string(error); }
+
+        void closeSocket(SocketTransport::NativeSocket socket) { closesocket(socket); }
+        int  pollSocket(PollDescriptor& descriptor, int timeout_ms) { return WSAPoll(&descriptor, 1, timeout_ms); }
+
+        bool setBlocking(SocketTransport::NativeSocket socket, bool blocking) {
+            u_long mode = blocking ? 0 : 1;
+            return ioctlsocket(socket, FIONBIO, &mode) == 0;
+        }
+
+        void setSendTimeout(SocketTransport::NativeSocket socket, unsigned int timeout_ms) {
+            DWORD value = timeout_ms;
+            setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+#else
+        typedef pollfd  PollDescriptor;
+        typedef ssize_t IoResult;
+
+        const SocketTransport::NativeSocket s_invalidSocket = -1;
+
+#ifdef MSG_NOSIGNAL
+        // A peer that closed the connection must raise an error, not SIGPIPE.
+        const int s_sendFlags = MSG_NOSIGNAL;
+#else
+        const int s_sendFlags = 0;
+#endif
+
+        void startup() {}
+
+        int  lastError() { return errno; }
+        bool isInterrupted(int error) { return error == EINTR; }
+        bool isInProgress(int error) { return error == EINPROGRESS; }
+        bool isTimeout(int error) { return error == EAGAIN || error == EWOULDBLOCK; }
+        std::string errorText(int error) { return std::strerror(error); }
+
+        void closeSocket(SocketTransport::NativeSocket socket) { ::close(socket); }
+        int  pollSocket(PollDescriptor& descriptor, int timeout_ms) { return ::poll(&descriptor, 1, timeout_ms); }
+
+        bool setBlocking(SocketTransport::NativeSocket socket, bool blocking) {
+            int flags = fcntl(socket, F_GETFL, 0);
+            if (flags < 0) return false;
+            return fcntl(socket, F_SETFL, blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK)) == 0;
+        }
+
+        void setSendTimeout(SocketTransport::NativeSocket socket, unsigned int timeout_ms) {
+            timeval value;
+            value.tv_sec  = static_cast<time_t>(timeout_ms / 1000);
+            value.tv_usec = static_cast<suseconds_t>((timeout_ms % 1000) * 1000);
+            setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value));
+        }
+#endif
+
+        std::string upperCase(std::string text) {
+            std::transform(text.begin(), text.end(), text.begin(), utils::toUpper);
+            return text;
+        }
+
+        bool isNumber(const std::string& text) {
+            return !text.empty() && std::all_of(text.begin(), text.end(), utils::isDigit);
+        }
+
+        // Connects a socket, giving up after `timeout_ms` instead of the system's TCP timeout.
+        bool connectWithTimeout(SocketTransport::NativeSocket socket, const sockaddr* address, size_t length, unsigned int timeout_ms, int& error) {
+            if (!setBlocking(socket, false)) {
+                error = lastError();
+                return false;
+            }
+            if (::connect(socket, address, static_cast<socklen_t>(length)) != 0) {
+                error = lastError();
+                if (!isInProgress(error)) return false;
+
+                PollDescriptor descriptor;
+                descriptor.fd      = socket;
+                descriptor.events  = POLLOUT;
+                descriptor.revents = 0;
+                int ready;
+                do {
+                    ready = pollSocket(descriptor, static_cast<int>(timeout_ms));
+                } while (ready < 0 && isInterrupted(lastError()));
+                if (ready <= 0) {
+                    error = ready == 0 ? 0 : lastError();
+                    return false;
+                }
+
+                socklen_t size = sizeof(error);
+                if (getsockopt(socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &size) != 0 || error != 0) return false;
+            }
+            error = 0;
+            return setBlocking(socket, true);
+        }
+    }    // namespace
+
+    SocketTransport::SocketTransport()
+        : m_socket(s_invalidSocket),
+          m_open(false),
+          m_timeout_ms(s_defaultTimeout_ms),
+          m_readTermination('\n'),
+          m_readTerminationEnabled(true),
+          m_writeTermination('\n'),
+          m_buffer(s_receiveBufferSize),
+          m_begin(0),
+          m_end(0) {}
+
+    SocketTransport::~SocketTransport() { close(); }
+
+    // --- Resource Strings ---
+
+    bool SocketTransport::parseResource(const std::string& resourceName, std::string& host, uint16_t& port) {
+        // TCPIP[board]::host::port::SOCKET; the host may be an IPv6 address containing "::".
+        size_t hostBegin = resourceName.find("::");
+        size_t suffix    = resourceName.rfind("::");
+        size_t portBegin = suffix == std::string::npos || suffix == 0 ? std::string::npos : resourceName.rfind("::", suffix - 1);
+        if (hostBegin == std::string::npos || portBegin == std::string::npos || portBegin <= hostBegin) return false;
+
+        std::string interfaceName = upperCase(resourceName.substr(0, hostBegin));
+        std::string portText      = resourceName.substr(portBegin + 2, suffix - portBegin - 2);
+        if (interfaceName.compare(0, 5, "TCPIP") != 0) return false;
+        if (interfaceName.size() > 5 && !isNumber(interfaceName.substr(5))) return false;
+        if (upperCase(resourceName.substr(suffix + 2)) != "SOCKET") return false;
+        if (!isNumber(portText) || portText.size() > 5) return false;
+
+        unsigned long number = std::stoul(portText);
+        std::string   name   = resourceName.substr(hostBegin + 2, portBegin - hostBegin - 2);
+        if (number == 0 || number > 65535 || name.empty()) return false;
+        host = name;
+        port = static_cast<uint16_t>(number);
+        return true;
+    }
+
+    bool SocketTransport::isSocketResource(const std::string& resourceName) {
+        std::string host;
+        uint16_t    port;
+        return parseResource(resourceName, host, port);
+    }
+
+    // --- Session ---
+
+    void SocketTransport::open(const std::string& resourceName) {
+        close();
+        std::string host;
+        uint16_t    port = 0;
+        if (!parseResource(resourceName, host, port)) {
+            throw ConnectionException("Not a TCPIP socket resource: " + resourceName);
+        }
+        startup();
+
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+        addrinfo*   addresses = nullptr;
+        std::string service   = utils::to_string(port);
+        int         status    = getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses);
+        if (status != 0) {
+            throw ConnectionException("Failed to connect to instrument: " + resourceName + " (cannot resolve " + host + ": " + gai_strerror(status) + ")");
+        }
+
+        NativeSocket socket = s_invalidSocket;
+        int          error  = 0;
+        for (addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+            socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (socket == s_invalidSocket) {
+                error = lastError();
+                continue;
+            }
+            if (connectWithTimeout(socket, address->ai_addr, address->ai_addrlen, m_timeout_ms, error)) break;
+            closeSocket(socket);
+            socket = s_invalidSocket;
+        }
+        freeaddrinfo(addresses);
+        if (socket == s_invalidSocket) {
+            throw ConnectionException("Failed to connect to instrument: " + resourceName + " (" + (error == 0 ? std::string("timed out") : errorText(error)) + ")");
+        }
+
+        // Send every command immediately instead of coalescing small segments.
+        int enable = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+        setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&enable), sizeof(enable));
+#ifdef SO_NOSIGPIPE
+        setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+        setSendTimeout(socket, m_timeout_ms);
+
+        m_socket       = socket;
+        m_open         = true;
+        m_resourceName = resourceName;
+        m_begin        = 0;
+        m_end          = 0;
+    }
+
+    void SocketTransport::close() {
+        if (m_open) {
+            closeSocket(m_socket);
+            m_socket = s_invalidSocket;
+            m_open   = false;
+        }
+        m_begin = 0;
+        m_end   = 0;
+    }
+
+    // --- Configuration ---
+
+    void SocketTransport::setTimeout(unsigned int timeout_ms) {
+        m_timeout_ms = timeout_ms;
+        if (m_open) setSendTimeout(m_socket, timeout_ms);
+    }
+
+    void SocketTransport::setReadTermination(char termChar, bool enable) {
+        m_readTermination        = termChar;
+        m_readTerminationEnabled = enable;
+    }
+
+    void SocketTransport::resetConfiguration() {
+        setTimeout(s_defaultTimeout_ms);
+        setReadTermination('\n', true);
+        m_writeTermination = '\n';
+    }
+
+    // --- I/O ---
+
+    size_t SocketTransport::write(const char* data, size_t size) {
+        if (!m_open) throw ConnectionException("Socket connection to " + m_resourceName + " is not open.");
+        const size_t parts = (size == 0 || data[size - 1] != m_writeTermination) ? 2 : 1;
+        size_t       total = size + parts - 1;
+        size_t       first = 0;
+
+        // The command and its terminator go out in one segment without concatenating them.
+#ifdef _WIN32
+        WSABUF buffers[2];
+        buffers[0].buf = const_cast<char*>(data);
+        buffers[0].len = static_cast<ULONG>(size);
+        buffers[1].buf = &m_writeTermination;
+        buffers[1].len = 1;
+#else
+        iovec buffers[2];
+        buffers[0].iov_base = const_cast<char*>(data);
+        buffers[0].iov_len  = size;
+        buffers[1].iov_base = &m_writeTermination;
+        buffers[1].iov_len  = 1;
+#endif
+        while (total > 0) {
+            size_t sent;
+#ifdef _WIN32
+            DWORD count = 0;
+            if (WSASend(m_socket, buffers + first, static_cast<DWORD>(parts - first), &count, 0, nullptr, nullptr) != 0) {
+#else
+            msghdr message;
+            std::memset(&message, 0, sizeof(message));
+            message.msg_iov    = buffers + first;
+            message.msg_iovlen = parts - first;
+            IoResult count     = sendmsg(m_socket, &message, s_sendFlags);
+            if (count < 0) {
+#endif
+                int error = lastError();
+                if (isInterrupted(error)) continue;
+                if (isTimeout(error)) throw TimeoutException("Socket write to " + m_resourceName + " timed out.");
+                fail("send");
+            }
+            sent = static_cast<size_t>(count);
+            total -= sent;
+
+            // Skip what was sent; a partial write resumes inside the current part.
+            while (first < parts && sent > 0) {
+#ifdef _WIN32
+                size_t length = buffers[first].len;
+#else
+                size_t length = buffers[first].iov_len;
+#endif
+                if (sent < length) {
+#ifdef _WIN32
+                    buffers[first].buf += sent;
+                    buffers[first].len -= static_cast<ULONG>(sent);
+#else
+                    buffers[first].iov_base = static_cast<char*>(buffers[first].iov_base) + sent;
+                    buffers[first].iov_len -= sent;
+#endif
+                    break;
+                }
+                sent -= length;
+                ++first;
+            }
+        }
+        return size;
+    }
+
+    size_t SocketTransport::read(char* buffer, size_t capacity, bool& end) {
+        if (!m_open) throw ConnectionException("Socket connection to " + m_resourceName + " is not open.");
+        end          = false;
+        size_t count = 0;
+        while (count < capacity) {
+            if (m_begin == m_end) {
+                // Large unterminated reads, e.g. block payloads, bypass the buffer.
+                if (!m_readTerminationEnabled && capacity - count >= m_buffer.size()) {
+                    count += receive(buffer + count, capacity - count);
+                    continue;
+                }
+                m_begin = 0;
+                m_end   = receive(m_buffer.data(), m_buffer.size());
+            }
+
+            size_t      length = std::min(capacity - count, m_end - m_begin);
+            const char* first  = m_buffer.data() + m_begin;
+            if (m_readTerminationEnabled) {
+                const void* term = std::memchr(first, m_readTermination, length);
+                if (term != nullptr) {
+                    length = static_cast<size_t>(static_cast<const char*>(term) - first) + 1;
+                    end    = true;
+                }
+            }
+            std::memcpy(buffer + count, first, length);
+            m_begin += length;
+            count += length;
+            if (end) break;
+        }
+        return count;
+    }
+
+    IoStatus SocketTransport::tryRead(char* buffer, size_t capacity, bool& end, size_t& count) {
+        count = 0;
+        try {
+            // An instrument that does not answer at all is the routine case; a response that stops midway still throws below.
+            if (m_open && m_begin == m_end && !waitReadable(m_timeout_ms)) return IoStatus(StatusCode::TIMEOUT, "recv");
+        } catch (const VisaException& error) {
+            return IoStatus::fromException(error);
+        }
+        return Transport::tryRead(buffer, capacity, end, count);
+    }
+
+    // --- Instrument Control & Status ---
+
+    void SocketTransport::clear() {
+        // A raw socket has no device clear; discard everything received so far.
+        if (!m_open) throw ConnectionException("Socket connection to " + m_resourceName + " is not open.");
+        m_begin = 0;
+        m_end   = 0;
+        while (waitReadable(0)) {
+            receive(m_buffer.data(), m_buffer.size());
+        }
+    }
+
+    uint8_t SocketTransport::readStatusByte() {
+        // Like VISA socket sessions, emulate the serial poll with *STB?.
+        write("*STB?", 5);
+        char   response[32];
+        bool   end                = false;
+        size_t count              = 0;
+        bool   terminationEnabled = m_readTerminationEnabled;
+        m_readTerminationEnabled  = true;
+        try {
+            count = read(response, sizeof(response), end);
+        } catch (...) {
+            m_readTerminationEnabled = terminationEnabled;
+            throw;
+        }
+        m_readTerminationEnabled = terminationEnabled;
+
+        long long value = ResponseParser::parseInteger(response, response + count);
+        if (value < 0 || value > 255) {
+            throw CommandException("Invalid response for *STB?: " + std::string(response, count));
+        }
+        return static_cast<uint8_t>(value);
+    }
+
+    void SocketTransport::assertTrigger() {
+        // Like VISA socket sessions, emulate the group execute trigger with *TRG.
+        write("*TRG", 4);
+    }
+
+    // --- Service Requests ---
+
+    void SocketTransport::enableServiceRequest() { throw VisaException("Service requests are not available on raw socket connections."); }
+
+    bool SocketTransport::waitForServiceRequest(unsigned int timeout_ms) {
+        (void)timeout_ms;
+        throw VisaException("Service requests are not available on raw socket connections.");
+    }
+
+    // --- Private Helpers ---
+
+    size_t SocketTransport::receive(char* buffer, size_t capacity) {
+        if (!waitReadable(m_timeout_ms)) {
+            throw TimeoutException("Socket read from " + m_resourceName + " timed out after " + utils::to_string(m_timeout_ms) + " ms.");
+        }
+        for (;;) {
+#ifdef _WIN32
+            IoResult count = recv(m_socket, buffer, static_cast<int>(std::min<size_t>(capacity, 0x7fffffff)), 0);
+#else
+            IoResult count = recv(m_socket, buffer, capacity, 0);
+#endif
+            if (count > 0) return static_cast<size_t>(count);
+            if (count == 0) {
+                close();
+                throw ConnectionException("Connection to " + m_resourceName + " was closed by the instrument.");
+            }
+            if (!isInterrupted(lastError())) fail("recv");
+        }
+    }
+
+    bool SocketTransport::waitReadable(unsigned int timeout_ms) {
+        PollDescriptor descriptor;
+        descriptor.fd      = m_socket;
+        descriptor.events  = POLLIN;
+        descriptor.revents = 0;
+        for (;;) {
+            int ready = pollSocket(descriptor, static_cast<int>(timeout_ms));
+            if (ready > 0) return true;
+            if (ready == 0) return false;
+            if (!isInterrupted(lastError())) fail("poll");
+        }
+    }
+
+    void SocketTransport::fail(const char* functionName) {
+        std::string text = errorText(lastError());
+        close();
+        throw ConnectionException(std::string(functionName) + " failed on " + m_resourceName + ": " + text);
+    }
+
+}    // namespace cvisa
@@ -0,0 +1,124 @@
+#ifndef CVISA_SOCKET_TRANSPORT_HPP
+#define CVISA_SOCKET_TRANSPORT_HPP
+
+#include "Transport.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cvisa {
+
+    /**
+     * @class SocketTransport
+     * @brief A `Transport` that talks to LAN instruments over a raw TCP socket.
+     *
+     * Serves `TCPIP[board]::host::port::SOCKET` resources (e.g.,
+     * "TCPIP0::192.168.1.20::5025::SOCKET") without the vendor VISA stack,
+     * which saves its per-call overhead on every command. `VISACom::connect()`
+     * selects it for such resources unless `enableNativeSockets(false)` was
+     * called.
+     *
+     * - Nagle's algorithm is disabled (`TCP_NODELAY`), so short commands are
+     *   sent immediately instead of waiting for an acknowledgement.
+     * - A command and its termination character are sent with one
+     *   scatter/gather write, without copying the command.
+     * - Responses are received into a session-owned buffer and handed out up
+     *   to the termination character, so a line costs about one `recv()`.
+     *
+     * A raw socket has no END indicator and no service requests: read
+     * termination is enabled with '\n' by default, `readStatusByte()` sends
+     * `*STB?` and `assertTrigger()` sends `*TRG` like VISA does for socket
+     * sessions, and the SRQ functions throw
+     * `VisaException`, which makes `SCPIBase` fall back to polling. Without
+     * END, indefinite-length (`#0`) binary blocks are rejected. A device
+     * clear discards buffered input. Uses POSIX sockets or Winsock.
+     */
+    class SocketTransport : public Transport {
+      public:
+#ifdef _WIN32
+        typedef std::uintptr_t NativeSocket;    // SOCKET
+#else
+        typedef int NativeSocket;
+#endif
+
+        SocketTransport();
+
+        /**
+         * @brief Destructor. Closes the connection if it is open.
+         */
+        ~SocketTransport();
+
+        SocketTransport(const SocketTransport&)            = delete;
+        SocketTransport& operator=(const SocketTransport&) = delete;
+
+        /**
+         * @brief Splits a `TCPIP[board]::host::port::SOCKET` resource string.
+         *
+         * Matching is case-insensitive.
+         *
+         * @param resourceName The resource string.
+         * @param host Receives the host name or address.
+         * @param port Receives the port.
+         * @return True if `resourceName` is a valid socket resource.
+         */
+        static bool parseResource(const std::string& resourceName, std::string& host, uint16_t& port);
+
+        /**
+         * @brief Returns true if `resourceName` is a `::SOCKET` resource.
+         */
+        static bool isSocketResource(const std::string& resourceName);
+
+        void open(const std::string& resourceName) override;
+        void close() override;
+        bool isOpen() const override { return m_open; }
+
+        void setTimeout(unsigned int timeout_ms) override;
+        void setReadTermination(char termChar, bool enable) override;
+        bool isReadTerminationEnabled() const override { return m_readTerminationEnabled; }
+        bool signalsEnd() const override { return false; }
+        void setWriteTermination(char termChar) override { m_writeTermination = termChar; }
+        void resetConfiguration() override;
+
+        /**
+         * @brief Sends a message followed by the write termination character.
+         *
+         * The terminator is omitted if the message already ends with it.
+         */
+        size_t   write(const char* data, size_t size) override;
+        size_t   read(char* buffer, size_t capacity, bool& end) override;
+        IoStatus tryRead(char* buffer, size_t capacity, bool& end, size_t& count) override;
+
+        void    clear() override;
+        uint8_t readStatusByte() override;
+        void    assertTrigger() override;
+
+        void enableServiceRequest() override;
+        void disableServiceRequest() override {}
+        void discardServiceRequests() override {}
+        bool waitForServiceRequest(unsigned int timeout_ms) override;
+
+      private:
+        // Receives at least one byte, waiting up to the timeout.
+        size_t receive(char* buffer, size_t capacity);
+        // Waits until the socket is readable. Returns false on timeout.
+        bool waitReadable(unsigned int timeout_ms);
+        // Closes the connection and throws `ConnectionException` for a failed call.
+        [[noreturn]] void fail(const char* functionName);
+
+        NativeSocket      m_socket;
+        bool              m_open;
+        std::string       m_resourceName;
+        unsigned int      m_timeout_ms;
+        char              m_readTermination;
+        bool              m_readTerminationEnabled;
+        char              m_writeTermination;
+        std::vector<char> m_buffer;    // Received bytes not yet read are [m_begin, m_end).
+        size_t            m_begin;
+        size_t            m_end;
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_SOCKET_TRANSPORT_HPP
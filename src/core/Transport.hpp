@@ -0,0 +1,186 @@
+#ifndef CVISA_TRANSPORT_HPP
+#define CVISA_TRANSPORT_HPP
+
+#include "Exceptions.hpp"
+#include "Logger.hpp"
+#include "Result.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cvisa {
+
+    /**
+     * @class Transport
+     * @brief The byte-level link between a `VISACom` session and an instrument.
+     *
+     * `VISACom` implements message handling, block transfers, service request
+     * logic, locking and logging on top of this interface; a transport only
+     * moves bytes and exposes the bus-level operations of IEEE 488.2. The
+     * default is `VisaTransport`, which calls the vendor VISA library.
+     * `SimulatedTransport` answers from a script instead, so drivers can be
+     * exercised without hardware.
+     *
+     * Transports are not thread-safe; `VISACom` only calls them while holding
+     * its I/O lock. Errors are reported by throwing the exceptions in
+     * `Exceptions.hpp`: `ConnectionException` when the link cannot be opened
+     * or is lost, `TimeoutException` when an operation times out and
+     * `VisaException` for anything else, including unsupported operations.
+     * `tryWrite()` and `tryRead()` report the same failures as an `IoStatus`;
+     * transports override them where a routine failure such as a timeout can
+     * be detected without throwing.
+     */
+    class Transport {
+      public:
+        virtual ~Transport() {}
+
+        // --- Session ---
+        /**
+         * @brief Opens the link to an instrument.
+         * @param resourceName The resource string (e.g., "GPIB0::5::INSTR").
+         * @throws ConnectionException if the link cannot be opened.
+         */
+        virtual void open(const std::string& resourceName) = 0;
+
+        /**
+         * @brief Closes the link. Safe to call if it is not open.
+         */
+        virtual void close() = 0;
+
+        /**
+         * @brief Returns true if the link is open.
+         */
+        virtual bool isOpen() const = 0;
+
+        // --- Configuration ---
+        /**
+         * @brief Sets the I/O timeout.
+         */
+        virtual void setTimeout(unsigned int timeout_ms) = 0;
+
+        /**
+         * @brief Configures the character that ends a read.
+         * @param termChar The termination character.
+         * @param enable False to read until END or the buffer is full.
+         */
+        virtual void setReadTermination(char termChar, bool enable) = 0;
+
+        /**
+         * @brief Returns true if reads end at the termination character.
+         */
+        virtual bool isReadTerminationEnabled() const = 0;
+
+        /**
+         * @brief Returns false if the link has no END indicator, so a read with
+         * termination disabled only ends when the buffer is full.
+         */
+        virtual bool signalsEnd() const { return true; }
+
+        /**
+         * @brief Configures the character that ends a written message and asserts END with it.
+         */
+        virtual void setWriteTermination(char termChar) = 0;
+
+        /**
+         * @brief Restores the timeout and terminations of a newly opened link.
+         */
+        virtual void resetConfiguration() = 0;
+
+        /**
+         * @brief Passes the session's verbosity on to the transport's own logging.
+         */
+        virtual void setLogLevel(LogLevel level) { (void)level; }
+
+        // --- I/O ---
+        /**
+         * @brief Writes a message.
+         * @return The number of bytes written.
+         */
+        virtual size_t write(const char* data, size_t size) = 0;
+
+        /**
+         * @brief Reads up to `capacity` bytes of a response.
+         *
+         * @param buffer The destination memory.
+         * @param capacity The size of the destination memory in bytes.
+         * @param end Set to true if the read ended the message (END or the
+         * enabled termination character was received), false if it stopped
+         * because the buffer is full.
+         * @return The number of bytes read.
+         */
+        virtual size_t read(char* buffer, size_t capacity, bool& end) = 0;
+
+        /**
+         * @brief Writes a message without throwing.
+         * @param written Receives the number of bytes written.
+         * @return The status of the write.
+         */
+        virtual IoStatus tryWrite(const char* data, size_t size, size_t& written) {
+            written = 0;
+            try {
+                written = write(data, size);
+            } catch (const VisaException& error) {
+                return IoStatus::fromException(error);
+            }
+            return IoStatus();
+        }
+
+        /**
+         * @brief Reads up to `capacity` bytes of a response without throwing.
+         * @param count Receives the number of bytes read.
+         * @return The status of the read. See `read()` for the other parameters.
+         */
+        virtual IoStatus tryRead(char* buffer, size_t capacity, bool& end, size_t& count) {
+            count = 0;
+            try {
+                count = read(buffer, capacity, end);
+            } catch (const VisaException& error) {
+                return IoStatus::fromException(error);
+            }
+            return IoStatus();
+        }
+
+        // --- Instrument Control & Status ---
+        /**
+         * @brief Sends a device clear.
+         */
+        virtual void clear() = 0;
+
+        /**
+         * @brief Reads the status byte with a serial poll.
+         */
+        virtual uint8_t readStatusByte() = 0;
+
+        /**
+         * @brief Sends a device trigger (e.g., GPIB Group Execute Trigger).
+         */
+        virtual void assertTrigger() = 0;
+
+        // --- Service Requests ---
+        /**
+         * @brief Starts queuing service requests.
+         * @throws VisaException if the transport has no service requests.
+         */
+        virtual void enableServiceRequest() = 0;
+
+        /**
+         * @brief Stops queuing service requests and discards pending ones.
+         */
+        virtual void disableServiceRequest() = 0;
+
+        /**
+         * @brief Discards queued service requests.
+         */
+        virtual void discardServiceRequests() = 0;
+
+        /**
+         * @brief Waits for the next service request.
+         * @return True if a request arrived, false on timeout.
+         */
+        virtual bool waitForServiceRequest(unsigned int timeout_ms) = 0;
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_TRANSPORT_HPP
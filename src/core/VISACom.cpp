@@ -1,17 +1,109 @@
 #include "Exceptions.hpp"
 #include "Logger.hpp"
 #include "VISACom.hpp"
-#include "utils.hpp"
+#include "../utils/utils.hpp"
+#ifndef CVISA_NO_SOCKETS
+#include "SocketTransport.hpp"
+#endif
+#ifndef CVISA_NO_VISA
+#include "VisaTransport.hpp"
+#endif
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <string>
 #include <thread>
 #include <utility>    // for std::move
 #include <vector>
-#include <visa.h>
 
 namespace cvisa {
 
+    constexpr uint8_t StatusByte::EAV;
+    constexpr uint8_t StatusByte::MAV;
+    constexpr uint8_t StatusByte::ESB;
+    constexpr uint8_t StatusByte::RQS;
+    constexpr uint8_t EventStatus::OPC;
+    constexpr uint8_t EventStatus::QYE;
+    constexpr uint8_t EventStatus::DDE;
+    constexpr uint8_t EventStatus::EXE;
+    constexpr uint8_t EventStatus::CME;
+    constexpr uint8_t EventStatus::PON;
+    constexpr uint8_t EventStatus::ERRORS;
+
+    namespace {
+        // VISA's default I/O timeout, which the other transports share. Bounds SRQ
+        // waits and adaptive timeouts when no timeout was configured.
+        const unsigned int s_visaDefaultTimeout_ms = 2000;
+
+        // Returns the transport `connect()` uses for a resource, or nullptr if none is built in.
+        std::unique_ptr<Transport> makeDefaultTransport(const std::string& resourceName, bool nativeSockets) {
+#ifndef CVISA_NO_SOCKETS
+            if (nativeSockets && SocketTransport::isSocketResource(resourceName)) {
+                return std::unique_ptr<Transport>(new SocketTransport());
+            }
+#else
+            (void)resourceName;
+            (void)nativeSockets;
+#endif
+#ifdef CVISA_NO_VISA
+            return std::unique_ptr<Transport>();
+#else
+            return std::unique_ptr<Transport>(new VisaTransport());
+#endif
+        }
+
+        // Returns a delay between half and all of `backoff_ms`, so that sessions
+        // that lost the same link do not retry in lockstep.
+        unsigned int jittered(unsigned int backoff_ms) {
+            unsigned int half  = backoff_ms / 2;
+            uint64_t     noise = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            return half + static_cast<unsigned int>((noise ^ (noise >> 17)) % (backoff_ms - half + 1));
+        }
+
+        // Sessions kept open by `disconnect()` for reuse (see `VISACom::setSessionPoolSize()`).
+        struct IdleSession {
+            std::string                resourceName;
+            bool                       nativeSockets;
+            std::unique_ptr<Transport> transport;
+        };
+
+        std::mutex              s_sessionPoolMutex;
+        std::deque<IdleSession> s_idleSessions;    // Oldest first.
+        size_t                  s_maxIdleSessions = 0;
+
+        // Takes an idle session for the resource, or returns nullptr.
+        std::unique_ptr<Transport> takeIdleSession(const std::string& resourceName, bool nativeSockets) {
+            std::lock_guard<std::mutex> lock(s_sessionPoolMutex);
+            for (auto it = s_idleSessions.begin(); it != s_idleSessions.end(); ++it) {
+                if (it->resourceName == resourceName && it->nativeSockets == nativeSockets) {
+                    std::unique_ptr<Transport> transport = std::move(it->transport);
+                    s_idleSessions.erase(it);
+                    if (transport->isOpen()) return transport;
+                    return std::unique_ptr<Transport>();
+                }
+            }
+            return std::unique_ptr<Transport>();
+        }
+
+        // Parks an open session. Returns false if pooling is disabled.
+        bool parkIdleSession(const std::string& resourceName, bool nativeSockets, std::unique_ptr<Transport>& transport) {
+            std::unique_ptr<Transport> evicted;
+            {
+                std::lock_guard<std::mutex> lock(s_sessionPoolMutex);
+                if (s_maxIdleSessions == 0) return false;
+                if (s_idleSessions.size() >= s_maxIdleSessions) {
+                    evicted = std::move(s_idleSessions.front().transport);
+                    s_idleSessions.pop_front();
+                }
+                IdleSession session = {resourceName, nativeSockets, std::move(transport)};
+                s_idleSessions.push_back(std::move(session));
+            }
+            if (evicted) evicted->close();
+            return true;
+        }
+    }    // namespace
+
     // --- Constructors and Destructor ---
 
     VISACom::VISACom()
@@ -21,23 +113,32 @@ namespace cvisa {
           m_read_termination_set(false),
           m_write_termination('\n'),
           m_write_termination_set(false),
-          m_resourceManagerHandle(VI_NULL),
-          m_instrumentHandle(VI_NULL),
+          m_defaultTransport(false),
+          m_nativeSocketsEnabled(true),
           m_logLevel(LogLevel::WARNING),
-          m_autoErrorCheckEnabled(false) {
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom default constructed.");
+          m_autoErrorCheckEnabled(false),
+          m_serviceRequestEnabled(false),
+          m_waitForServiceRequest(false),
+          m_sessionOpen(false),
+          m_autoReconnectEnabled(false),
+          m_reconnectAttempts(5),
+          m_reconnectBackoff_ms(20),
+          m_reconnectMaxBackoff_ms(2000),
+          m_reconnecting(false),
+          m_reconnectCount(0) {
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom default constructed.");
     }
 
     VISACom::VISACom(const std::string& resourceName) : VISACom() {
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom constructed with resource name.");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom constructed with resource name.");
         setAddress(resourceName);
         connect();
     }
 
     VISACom::VISACom(const std::string& resourceName, unsigned int timeout_ms, char read_termination) : VISACom() {
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName,
-                    "VISACom constructed with resource, timeout, and term "
-                    "char.");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName,
+                  "VISACom constructed with resource, timeout, and term "
+                  "char.");
         setAddress(resourceName);
         m_timeout_ms           = timeout_ms;
         m_timeout_ms_set       = true;
@@ -47,18 +148,20 @@ namespace cvisa {
     }
 
     VISACom::~VISACom() {
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom destructed.");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom destructed.");
+        stopCommandQueue();
         disconnect();
     }
 
     // --- Manual Connection Management ---
 
     void VISACom::setAddress(const std::string& resourceName) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
         if (isConnected()) {
-            Logger::log(m_logLevel, LogLevel::ERROR, m_resourceName, "Attempted to set resource while already connected.");
+            CVISA_LOG(m_logLevel, LogLevel::ERROR, m_resourceName, "Attempted to set resource while already connected.");
             throw ConnectionException("Cannot set resource while connected.");
         }
-        Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Setting resource to: " + resourceName);
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Setting resource to: " + resourceName);
         m_resourceName = resourceName;
     }
 
@@ -68,75 +171,197 @@ namespace cvisa {
     }
 
     void VISACom::connect() {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
         if (isConnected()) {
-            Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Connect called but already connected.");
+            CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Connect called but already connected.");
             return;
         }
-        Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Attempting to connect...");
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Attempting to connect...");
         if (m_resourceName.empty()) {
-            Logger::log(m_logLevel, LogLevel::ERROR, m_resourceName, "Connection failed: resource name is empty.");
+            CVISA_LOG(m_logLevel, LogLevel::ERROR, m_resourceName, "Connection failed: resource name is empty.");
             throw ConnectionException("Cannot connect: VISA resource name is not set.");
         }
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Resource name: " + m_resourceName);
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Resource name: " + m_resourceName);
 
-        ViStatus status = viOpenDefaultRM(&m_resourceManagerHandle);
-        if (status < VI_SUCCESS) {
-            Logger::log(m_logLevel, LogLevel::ERROR, m_resourceName, "Failed to open VISA Default Resource Manager.");
-            throw ConnectionException("Failed to open VISA Default Resource Manager.");
+        bool reused = false;
+        if (!m_transport || m_defaultTransport) {
+            m_transport = takeIdleSession(m_resourceName, m_nativeSocketsEnabled);
+            reused      = m_transport != nullptr;
+            if (!reused) m_transport = makeDefaultTransport(m_resourceName, m_nativeSocketsEnabled);
+            m_defaultTransport = true;
+            if (!m_transport) {
+                CVISA_LOG(m_logLevel, LogLevel::ERROR, m_resourceName, "Connection failed: no transport set and VISA support is not built in.");
+                throw ConnectionException("Cannot connect: cvisa was built without VISA support. Use setTransport() to provide a transport.");
+            }
         }
-
-        status = viOpen(m_resourceManagerHandle, const_cast<char*>(m_resourceName.c_str()), VI_NULL, VI_NULL, &m_instrumentHandle);
-        if (status < VI_SUCCESS) {
-            viClose(m_resourceManagerHandle);
-            m_resourceManagerHandle = VI_NULL;
-            Logger::log(m_logLevel, LogLevel::ERROR, m_resourceName, "Failed to connect to instrument: " + m_resourceName);
-            throw ConnectionException("Failed to connect to instrument: " + m_resourceName);
+        m_transport->setLogLevel(m_logLevel);
+        if (reused) {
+            // `applyConfiguration()` only sets what this session configured; the rest starts from the defaults.
+            try {
+                m_transport->resetConfiguration();
+            } catch (const VisaException&) {
+                m_transport->close();    // Opened again below.
+                reused = false;
+            }
+        }
+        if (reused) {
+            CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Reusing idle session for " + m_resourceName);
+        } else {
+            try {
+                m_transport->open(m_resourceName);
+            } catch (const ConnectionException&) {
+                CVISA_LOG(m_logLevel, LogLevel::ERROR, m_resourceName, "Failed to connect to instrument: " + m_resourceName);
+                throw;
+            }
         }
 
-        Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Successfully connected to " + m_resourceName);
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Successfully connected to " + m_resourceName);
+        m_sessionOpen = true;
         applyConfiguration();
+        invalidateCachedState();
     }
 
     void VISACom::disconnect() {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        m_sessionOpen = false;
         if (!isConnected()) {
             return;
         }
-        Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Disconnecting from " + m_resourceName);
-        if (m_instrumentHandle != VI_NULL) {
-            viClose(m_instrumentHandle);
-            m_instrumentHandle = VI_NULL;
-            Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Instrument handle closed.");
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Disconnecting from " + m_resourceName);
+        bool parked = false;
+        if (m_defaultTransport) {
+            try {
+                if (m_serviceRequestEnabled) m_transport->disableServiceRequest();
+                // The next owner must not read a response this session left behind.
+                m_transport->clear();
+                parked = parkIdleSession(m_resourceName, m_nativeSocketsEnabled, m_transport);
+            } catch (const VisaException&) {
+                // A session that cannot be reset is closed instead.
+            }
         }
-        if (m_resourceManagerHandle != VI_NULL) {
-            viClose(m_resourceManagerHandle);
-            m_resourceManagerHandle = VI_NULL;
-            Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Resource manager handle closed.");
+        // Closing the session also disables its events.
+        if (!parked) m_transport->close();
+        m_serviceRequestEnabled = false;
+        invalidateCachedState();
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Disconnection complete.");
+    }
+
+    bool VISACom::isConnected() const { return m_transport && m_transport->isOpen(); }
+
+    void VISACom::reconnect() {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (m_resourceName.empty()) throw ConnectionException("Cannot reconnect: VISA resource name is not set.");
+        if (!m_transport) {
+            connect();
+            return;
+        }
+        CVISA_LOG(m_logLevel, LogLevel::WARNING, m_resourceName, "Reconnecting to " + m_resourceName);
+
+        bool serviceRequests = m_serviceRequestEnabled;
+        m_reconnecting       = true;
+        try {
+            m_transport->close();
+            m_serviceRequestEnabled = false;
+            unsigned int backoff_ms = m_reconnectBackoff_ms;
+            for (unsigned int attempt = 1;; ++attempt) {
+                try {
+                    m_transport->open(m_resourceName);
+                    break;
+                } catch (const ConnectionException& e) {
+                    if (attempt >= m_reconnectAttempts) {
+                        CVISA_LOG(m_logLevel, LogLevel::ERROR, m_resourceName, "Reconnect failed: " + std::string(e.what()));
+                        throw ConnectionException("Failed to reconnect to " + m_resourceName + " after " + utils::to_string(attempt) + " attempts: " + e.what());
+                    }
+                    CVISA_LOG(m_logLevel, LogLevel::WARNING, m_resourceName, "Reconnect attempt " + utils::to_string(attempt) + " failed: " + e.what());
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(jittered(backoff_ms)));
+                backoff_ms = std::min(backoff_ms * 2, m_reconnectMaxBackoff_ms);
+            }
+
+            m_sessionOpen = true;
+            applyConfiguration();
+            if (serviceRequests) enableServiceRequest();
+            invalidateCachedState();
+            restoreInstrumentState();
+        } catch (...) {
+            m_reconnecting = false;
+            throw;
         }
-        Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Disconnection complete.");
+        m_reconnecting = false;
+        ++m_reconnectCount;
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Reconnected to " + m_resourceName);
+    }
+
+    void VISACom::enableAutoReconnect(bool enable, unsigned int maxAttempts, unsigned int backoff_ms, unsigned int maxBackoff_ms) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Automatic reconnect " + std::string(enable ? "enabled" : "disabled") + ".");
+        m_autoReconnectEnabled   = enable;
+        m_reconnectAttempts      = std::max(maxAttempts, 1u);
+        m_reconnectBackoff_ms    = backoff_ms;
+        m_reconnectMaxBackoff_ms = std::max(maxBackoff_ms, backoff_ms);
+    }
+
+    uint64_t VISACom::getReconnectCount() const {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        return m_reconnectCount;
     }
 
-    bool VISACom::isConnected() const { return m_instrumentHandle != VI_NULL; }
+    void VISACom::setTransport(std::unique_ptr<Transport> transport) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (isConnected()) {
+            CVISA_LOG(m_logLevel, LogLevel::ERROR, m_resourceName, "Attempted to replace the transport while connected.");
+            throw ConnectionException("Cannot replace the transport while connected.");
+        }
+        m_transport        = std::move(transport);
+        m_defaultTransport = false;
+    }
+
+    Transport* VISACom::getTransport() const { return m_transport.get(); }
+
+    void VISACom::enableNativeSockets(bool enable) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        m_nativeSocketsEnabled = enable;
+    }
 
     // --- Move Semantics ---
 
+    // Tasks still queued on `other` refer to `other`, so they are completed before
+    // any of its state is taken over.
     VISACom::VISACom(VISACom&& other) noexcept
-        : m_resourceName(std::move(other.m_resourceName)),
+        : m_resourceName((other.stopCommandQueue(), std::move(other.m_resourceName))),
           m_timeout_ms(other.m_timeout_ms),
           m_timeout_ms_set(other.m_timeout_ms_set),
           m_read_termination(other.m_read_termination),
           m_read_termination_set(other.m_read_termination_set),
           m_write_termination(other.m_write_termination),
           m_write_termination_set(other.m_write_termination_set),
-          m_resourceManagerHandle(other.m_resourceManagerHandle),
-          m_instrumentHandle(other.m_instrumentHandle),
-          m_logLevel(other.m_logLevel) {
-        other.m_resourceManagerHandle = VI_NULL;
-        other.m_instrumentHandle      = VI_NULL;
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom move constructed.");
+          m_transport(std::move(other.m_transport)),
+          m_defaultTransport(other.m_defaultTransport),
+          m_nativeSocketsEnabled(other.m_nativeSocketsEnabled),
+          m_logLevel(other.m_logLevel),
+          m_autoErrorCheckEnabled(other.m_autoErrorCheckEnabled),
+          m_readBuffer(std::move(other.m_readBuffer)),
+          m_serviceRequestEnabled(other.m_serviceRequestEnabled),
+          m_waitForServiceRequest(other.m_waitForServiceRequest),
+          m_metrics(std::move(other.m_metrics)),
+          m_adaptivePolicy(std::move(other.m_adaptivePolicy)),
+          m_sessionOpen(other.m_sessionOpen),
+          m_autoReconnectEnabled(other.m_autoReconnectEnabled),
+          m_reconnectAttempts(other.m_reconnectAttempts),
+          m_reconnectBackoff_ms(other.m_reconnectBackoff_ms),
+          m_reconnectMaxBackoff_ms(other.m_reconnectMaxBackoff_ms),
+          m_reconnecting(false),
+          m_reconnectCount(other.m_reconnectCount) {
+        other.m_serviceRequestEnabled = false;
+        other.m_sessionOpen           = false;
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom move constructed.");
     }
 
     VISACom& VISACom::operator=(VISACom&& other) noexcept {
         if (this != &other) {
+            stopCommandQueue();
+            other.stopCommandQueue();
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
             disconnect();
             m_resourceName                = std::move(other.m_resourceName);
             m_timeout_ms                  = other.m_timeout_ms;
@@ -145,12 +370,25 @@ namespace cvisa {
             m_read_termination_set        = other.m_read_termination_set;
             m_write_termination           = other.m_write_termination;
             m_write_termination_set       = other.m_write_termination_set;
-            m_resourceManagerHandle       = other.m_resourceManagerHandle;
-            m_instrumentHandle            = other.m_instrumentHandle;
+            m_transport                   = std::move(other.m_transport);
+            m_defaultTransport            = other.m_defaultTransport;
+            m_nativeSocketsEnabled        = other.m_nativeSocketsEnabled;
             m_logLevel                    = other.m_logLevel;
-            other.m_resourceManagerHandle = VI_NULL;
-            other.m_instrumentHandle      = VI_NULL;
-            Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom move assigned.");
+            m_autoErrorCheckEnabled       = other.m_autoErrorCheckEnabled;
+            m_readBuffer                  = std::move(other.m_readBuffer);
+            m_serviceRequestEnabled       = other.m_serviceRequestEnabled;
+            m_waitForServiceRequest       = other.m_waitForServiceRequest;
+            m_metrics                     = std::move(other.m_metrics);
+            m_adaptivePolicy              = std::move(other.m_adaptivePolicy);
+            m_sessionOpen                 = other.m_sessionOpen;
+            m_autoReconnectEnabled        = other.m_autoReconnectEnabled;
+            m_reconnectAttempts           = other.m_reconnectAttempts;
+            m_reconnectBackoff_ms         = other.m_reconnectBackoff_ms;
+            m_reconnectMaxBackoff_ms      = other.m_reconnectMaxBackoff_ms;
+            m_reconnectCount              = other.m_reconnectCount;
+            other.m_serviceRequestEnabled = false;
+            other.m_sessionOpen           = false;
+            CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "VISACom move assigned.");
         }
         return *this;
     }
@@ -158,206 +396,722 @@ namespace cvisa {
     // --- Core I/O Operations ---
 
     void VISACom::write(const std::string& command) {
-        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot write.");
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Writing command: " + command);
-        ViUInt32 returnCount = 0;
-        ViStatus status      = viWrite(m_instrumentHandle, (unsigned char*)command.c_str(), static_cast<ViUInt32>(command.length()), &returnCount);
-        checkStatus(status, "viWrite");
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected() && !recoverConnection()) throw ConnectionException("Not connected to an instrument. Cannot write.");
+        try {
+            writeOnce(command);
+        } catch (const ConnectionException&) {
+            if (!recoverConnection()) throw;
+            writeOnce(command);
+        }
+    }
+
+    void VISACom::writeOnce(const std::string& command) {
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Writing command: " + command);
+        MetricsScope scope(m_metrics, SessionMetrics::WRITE);
+        uint64_t     start       = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+        size_t       returnCount = m_transport->write(command.data(), command.size());
+        if (start != 0) m_metrics.recordWrite(SessionMetrics::now() - start, returnCount);
+        scope.complete();
     }
 
     void VISACom::writeBinary(const std::vector<uint8_t>& data) {
-        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot write binary data.");
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Writing binary data of size: " + utils::to_string(data.size()));
-        ViUInt32 returnCount = 0;
-        ViStatus status      = viWrite(m_instrumentHandle, (unsigned char*)data.data(), static_cast<ViUInt32>(data.size()), &returnCount);
-        checkStatus(status, "viWrite (binary)");
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected() && !recoverConnection()) throw ConnectionException("Not connected to an instrument. Cannot write binary data.");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Writing binary data of size: " + utils::to_string(data.size()));
+        MetricsScope scope(m_metrics, SessionMetrics::WRITE);
+        uint64_t     start = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+        size_t       returnCount;
+        try {
+            returnCount = m_transport->write(reinterpret_cast<const char*>(data.data()), data.size());
+        } catch (const ConnectionException&) {
+            if (!recoverConnection()) throw;
+            returnCount = m_transport->write(reinterpret_cast<const char*>(data.data()), data.size());
+        }
+        if (start != 0) m_metrics.recordWrite(SessionMetrics::now() - start, returnCount);
+        scope.complete();
     }
 
     std::string VISACom::read(size_t bufferSize) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (m_readBuffer.size() < bufferSize) m_readBuffer.resize(bufferSize);
+        size_t returnCount = readInto(m_readBuffer.data(), bufferSize);
+        return std::string(m_readBuffer.data(), returnCount);
+    }
+
+    size_t VISACom::read(std::string& out, size_t bufferSize) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (m_readBuffer.size() < bufferSize) m_readBuffer.resize(bufferSize);
+        size_t returnCount = readInto(m_readBuffer.data(), bufferSize);
+        out.assign(m_readBuffer.data(), returnCount);
+        return returnCount;
+    }
+
+    size_t VISACom::readInto(char* buffer, size_t capacity) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
         if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot read.");
-        Logger::log(m_logLevel, LogLevel::DEBUG, "Reading data (buffer size: " + utils::to_string(bufferSize) + ")");
-        std::vector<char> buffer(bufferSize);
-        ViUInt32          returnCount = 0;
-        ViStatus          status      = viRead(m_instrumentHandle, (unsigned char*)buffer.data(), static_cast<ViUInt32>(buffer.size()), &returnCount);
-        checkStatus(status, "viRead");
-        std::string result(buffer.data(), returnCount);
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Read " + utils::to_string(returnCount) + " bytes: " + result);
-        return result;
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Reading data (buffer size: " + utils::to_string(capacity) + ")");
+        MetricsScope scope(m_metrics, SessionMetrics::READ);
+        uint64_t     start       = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+        bool         end         = false;
+        size_t       returnCount = m_transport->read(buffer, capacity, end);
+        if (start != 0) m_metrics.recordRead(SessionMetrics::now() - start, returnCount);
+        scope.complete();
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Read " + utils::to_string(returnCount) + " bytes: " + std::string(buffer, returnCount));
+        return returnCount;
     }
 
     std::vector<uint8_t> VISACom::readBinary(size_t bufferSize) {
-        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot read binary data.");
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Reading binary data (buffer size: " + utils::to_string(bufferSize) + ")");
-        std::vector<uint8_t> buffer(bufferSize);
-        ViUInt32             returnCount = 0;
-        ViStatus             status      = viRead(m_instrumentHandle, buffer.data(), static_cast<ViUInt32>(buffer.size()), &returnCount);
-        checkStatus(status, "viRead (binary)");
-        buffer.resize(returnCount);
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Read " + utils::to_string(returnCount) + " binary bytes.");
+        std::vector<uint8_t> buffer;
+        readBinary(buffer, bufferSize);
         return buffer;
     }
 
+    size_t VISACom::readBinary(std::vector<uint8_t>& out, size_t bufferSize) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot read binary data.");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Reading binary data (buffer size: " + utils::to_string(bufferSize) + ")");
+        out.resize(bufferSize);
+        MetricsScope scope(m_metrics, SessionMetrics::READ);
+        uint64_t     start       = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+        bool         end         = false;
+        size_t       returnCount = m_transport->read(reinterpret_cast<char*>(out.data()), out.size(), end);
+        if (start != 0) m_metrics.recordRead(SessionMetrics::now() - start, returnCount);
+        scope.complete();
+        out.resize(returnCount);
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Read " + utils::to_string(returnCount) + " binary bytes.");
+        return returnCount;
+    }
+
     std::string VISACom::query(const std::string& command, size_t bufferSize, unsigned int delay_ms) {
-        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot query.");
-        write(command);
-        if (delay_ms > 0) {
-            Logger::log(m_logLevel, LogLevel::DEBUG, "Delaying for " + utils::to_string(delay_ms) + "ms before reading.");
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        std::string response;
+        query(command, response, bufferSize, delay_ms);
+        return response;
+    }
+
+    size_t VISACom::query(const std::string& command, std::string& response, size_t bufferSize, unsigned int delay_ms) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected() && !recoverConnection()) throw ConnectionException("Not connected to an instrument. Cannot query.");
+        MetricsScope scope(m_metrics, SessionMetrics::QUERY);
+        for (unsigned int attempt = 0;; ++attempt) {
+            try {
+                prepareResponseWait(delay_ms);
+                writeOnce(command);
+                waitForResponse(delay_ms);
+                size_t returnCount = read(response, bufferSize);
+                scope.complete();
+                return returnCount;
+            } catch (const ConnectionException&) {
+                // The response was lost with the link; send the query again on the new session.
+                if (attempt > 0 || !recoverConnection()) throw;
+            }
+        }
+    }
+
+    size_t VISACom::queryMessage(const std::string& command, std::string& response, unsigned int delay_ms, size_t chunkSize) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected() && !recoverConnection()) throw ConnectionException("Not connected to an instrument. Cannot query.");
+        if (chunkSize == 0) chunkSize = 2048;
+        MetricsScope scope(m_metrics, SessionMetrics::QUERY);
+        for (unsigned int attempt = 0;; ++attempt) {
+            try {
+                prepareResponseWait(delay_ms);
+                writeOnce(command);
+                waitForResponse(delay_ms);
+                size_t returnCount = readMessage(response, chunkSize);
+                scope.complete();
+                return returnCount;
+            } catch (const ConnectionException&) {
+                // The response was lost with the link; send the query again on the new session.
+                if (attempt > 0 || !recoverConnection()) throw;
+            }
         }
-        return read(bufferSize);
+    }
+
+    IoStatus VISACom::tryWrite(const std::string& command) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected() && !tryRecoverConnection()) return IoStatus(StatusCode::CONNECTION, "write");
+        IoStatus status = tryWriteOnce(command);
+        if (status.code() == StatusCode::CONNECTION && tryRecoverConnection()) status = tryWriteOnce(command);
+        return status;
+    }
+
+    IoStatus VISACom::tryWriteOnce(const std::string& command) {
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Writing command: " + command);
+        MetricsScope scope(m_metrics, SessionMetrics::WRITE);
+        uint64_t     start   = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+        size_t       written = 0;
+        IoStatus     status  = m_transport->tryWrite(command.data(), command.size(), written);
+        if (!status) return status;
+        if (start != 0) m_metrics.recordWrite(SessionMetrics::now() - start, written);
+        scope.complete();
+        return status;
+    }
+
+    IoStatus VISACom::tryRead(std::string& out, size_t bufferSize) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected()) return IoStatus(StatusCode::CONNECTION, "read");
+        if (m_readBuffer.size() < bufferSize) m_readBuffer.resize(bufferSize);
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Reading data (buffer size: " + utils::to_string(bufferSize) + ")");
+        MetricsScope scope(m_metrics, SessionMetrics::READ);
+        uint64_t     start  = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+        bool         end    = false;
+        size_t       count  = 0;
+        IoStatus     status = m_transport->tryRead(m_readBuffer.data(), bufferSize, end, count);
+        if (!status) return status;
+        if (start != 0) m_metrics.recordRead(SessionMetrics::now() - start, count);
+        scope.complete();
+        out.assign(m_readBuffer.data(), count);
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Read " + utils::to_string(count) + " bytes: " + out);
+        return status;
+    }
+
+    IoStatus VISACom::tryQuery(const std::string& command, std::string& response, size_t bufferSize, unsigned int delay_ms) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected() && !tryRecoverConnection()) return IoStatus(StatusCode::CONNECTION, "query");
+        MetricsScope scope(m_metrics, SessionMetrics::QUERY);
+        for (unsigned int attempt = 0;; ++attempt) {
+            IoStatus status;
+            try {
+                // Only SRQ setup can throw here; it fails the same way on every call, so it is not a routine cost.
+                prepareResponseWait(delay_ms);
+                status = tryWriteOnce(command);
+                if (status) {
+                    waitForResponse(delay_ms);
+                    status = tryRead(response, bufferSize);
+                }
+            } catch (const VisaException& error) {
+                return IoStatus::fromException(error);
+            }
+            if (status) {
+                scope.complete();
+                return status;
+            }
+            // The response was lost with the link; send the query again on the new session.
+            if (status.code() != StatusCode::CONNECTION || attempt > 0 || !tryRecoverConnection()) return status;
+        }
+    }
+
+    IoStatus VISACom::tryAdaptiveQuery(const char* key, const std::string& command, std::string& response, size_t bufferSize, unsigned int delay_ms, bool idempotent) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected() && !tryRecoverConnection()) return IoStatus(StatusCode::CONNECTION, "query");
+        MetricsScope scope(m_metrics, SessionMetrics::QUERY);
+        unsigned int ceiling_ms  = sessionTimeout();
+        unsigned int applied_ms  = ceiling_ms;    // The timeout the transport currently uses.
+        unsigned int retries     = 0;
+        bool         reconnected = false;
+        IoStatus     status;
+        for (;;) {
+            AdaptivePolicy::Plan plan      = m_adaptivePolicy.plan(key, delay_ms, ceiling_ms);
+            uint64_t             writtenAt = 0;
+            uint64_t             readAt    = 0;
+            try {
+                if (plan.timeout_ms != applied_ms) {
+                    m_transport->setTimeout(plan.timeout_ms);
+                    applied_ms = plan.timeout_ms;
+                }
+                prepareResponseWait(plan.delay_ms);
+                status = tryWriteOnce(command);
+                if (status) {
+                    writtenAt = SessionMetrics::now();
+                    waitForResponse(plan.delay_ms);
+                    readAt = SessionMetrics::now();
+                    status = tryRead(response, bufferSize);
+                }
+            } catch (const VisaException& error) {
+                status = IoStatus::fromException(error);
+            }
+            if (status) {
+                uint64_t done = SessionMetrics::now();
+                m_adaptivePolicy.recordSuccess(key, plan, done - writtenAt, done - readAt);
+                break;
+            }
+
+            m_adaptivePolicy.recordFailure(key, delay_ms, status.code() == StatusCode::TIMEOUT);
+            if (status.code() == StatusCode::TIMEOUT) {
+                // Without the clear, a late response to this attempt would answer the next query.
+                bool cleared = true;
+                try {
+                    clear();
+                } catch (const VisaException&) {
+                    cleared = false;
+                }
+                if (!cleared || !idempotent || retries >= m_adaptivePolicy.maxRetries()) break;
+                CVISA_LOG(m_logLevel, LogLevel::WARNING, m_resourceName, "No response to \"" + command + "\" within " + utils::to_string(plan.timeout_ms) + " ms; sending it again.");
+                ++retries;
+                m_adaptivePolicy.recordRetry(key);
+                continue;
+            }
+            // The response was lost with the link; `reconnect()` restores the session timeout.
+            if (status.code() == StatusCode::CONNECTION && !reconnected && tryRecoverConnection()) {
+                reconnected = true;
+                applied_ms  = ceiling_ms;
+                continue;
+            }
+            break;
+        }
+
+        // Everything else runs with the session timeout.
+        if (applied_ms != ceiling_ms && isConnected()) {
+            try {
+                m_transport->setTimeout(ceiling_ms);
+            } catch (const VisaException& error) {
+                if (status) status = IoStatus::fromException(error);
+            }
+        }
+        if (status) scope.complete();
+        return status;
     }
 
     std::future<std::string> VISACom::queryAsync(const std::string& command, size_t bufferSize, unsigned int delay_ms) {
-        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot query asynchronously.");
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Starting asynchronous query.");
-        return std::async(std::launch::async, [this, command, bufferSize, delay_ms]() { return this->query(command, bufferSize, delay_ms); });
+        {
+            // Released before submitting: the queue may wait for its worker, whose queries take this lock.
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot query asynchronously.");
+        }
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Queueing asynchronous query.");
+        return submit([this, command, bufferSize, delay_ms]() { return this->query(command, bufferSize, delay_ms); });
+    }
+
+    void VISACom::queryPipeline(const std::vector<std::string>& commands, size_t depth, const PipelineCallback& callback, size_t chunkSize) {
+        // A command without a response would stall the pipeline until it times out.
+        for (const auto& command : commands) {
+            if (command.find('?') == std::string::npos) throw CommandException("Cannot pipeline \"" + command + "\": not a query.");
+        }
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot query.");
+        if (depth == 0) depth = 1;
+        if (chunkSize == 0) chunkSize = 2048;
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Pipelining " + utils::to_string(commands.size()) + " queries, depth " + utils::to_string(depth) + ".");
+        MetricsScope scope(m_metrics, SessionMetrics::PIPELINE);
+
+        std::string response;
+        size_t      sent     = 0;
+        size_t      received = 0;
+        try {
+            for (; received < commands.size(); ++received) {
+                while (sent < commands.size() && sent - received < depth) {
+                    write(commands[sent++]);
+                }
+                readMessage(response, chunkSize);
+                callback(received, response);
+            }
+        } catch (...) {
+            // Responses to queries already sent would answer the next query; discard them.
+            if (sent > received && isConnected()) {
+                CVISA_LOG(m_logLevel, LogLevel::WARNING, m_resourceName, "Pipeline failed with " + utils::to_string(sent - received) + " responses outstanding; clearing.");
+                try {
+                    clear();
+                } catch (const VisaException&) {
+                    // Report the original failure.
+                }
+            }
+            throw;
+        }
+        scope.complete();
+    }
+
+    std::vector<std::string> VISACom::queryPipeline(const std::vector<std::string>& commands, size_t depth, size_t chunkSize) {
+        std::vector<std::string> responses(commands.size());
+        queryPipeline(commands, depth, [&responses](size_t index, const std::string& response) { responses[index] = response; }, chunkSize);
+        return responses;
+    }
+
+    // --- IEEE 488.2 Block Transfers ---
+
+    size_t VISACom::readBlock(BlockAllocator allocate, void* destination, size_t elementSize, size_t chunkSize) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot read binary block.");
+        if (chunkSize == 0) chunkSize = 65536;
+        MetricsScope scope(m_metrics, SessionMetrics::READ);
+        uint64_t     start = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+
+        // Payload bytes may match the termination character, so read termination is
+        // suspended for the whole block and restored on every exit path.
+        struct TerminationGuard {
+            Transport& transport;
+            char       termChar;
+            bool       active;
+            TerminationGuard(Transport& t, char c, bool enabled) : transport(t), termChar(c), active(enabled) {
+                if (active) transport.setReadTermination(termChar, false);
+            }
+            void restore() {
+                if (active) {
+                    active = false;
+                    transport.setReadTermination(termChar, true);
+                }
+            }
+            ~TerminationGuard() {
+                try {
+                    restore();
+                } catch (...) {
+                    // Already unwinding from a failed read; the session reports its own error.
+                }
+            }
+        } guard(*m_transport, m_read_termination, m_transport->isReadTerminationEnabled());
+
+        // Header: '#', one digit n, then n digits giving the payload length.
+        char   header[2 + 9] = {0};
+        bool   end           = false;
+        size_t returnCount   = m_transport->read(header, 2, end);
+        if (returnCount != 2 || header[0] != '#' || header[1] < '0' || header[1] > '9') {
+            throw CommandException("Invalid IEEE 488.2 block header: expected '#<n>', got \"" + std::string(header, returnCount) + "\"");
+        }
+
+        const size_t digits   = static_cast<size_t>(header[1] - '0');
+        const bool   definite = digits > 0;
+        if (!definite && !m_transport->signalsEnd()) {
+            // Without termination, the payload would only end when the read timed out.
+            try {
+                m_transport->clear();
+            } catch (const VisaException&) {
+            }
+            throw CommandException("Indefinite-length (#0) blocks need an END indicator, which " + m_resourceName
+                                   + " does not have. Select a definite-length block format on the instrument.");
+        }
+        size_t       length   = 0;
+        size_t       got      = 0;
+        while (got < digits) {
+            returnCount = m_transport->read(header + 2 + got, digits - got, end);
+            if (returnCount == 0) throw CommandException("Invalid IEEE 488.2 block header: length field truncated.");
+            got += returnCount;
+        }
+        for (size_t i = 0; i < digits; ++i) {
+            char c = header[2 + i];
+            if (c < '0' || c > '9') throw CommandException("Invalid IEEE 488.2 block header: non-digit in length field.");
+            length = length * 10 + static_cast<size_t>(c - '0');
+        }
+        if (definite && length % elementSize != 0) {
+            throw CommandException("IEEE 488.2 block length " + utils::to_string(length) + " is not a multiple of the element size " + utils::to_string(elementSize) + ".");
+        }
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName,
+                  definite ? "Reading definite-length block of " + utils::to_string(length) + " bytes." : std::string("Reading indefinite-length block."));
+
+        size_t received = 0;
+        if (definite) {
+            char* base = allocate(destination, length);
+            while (received < length) {
+                if (end) throw CommandException("IEEE 488.2 block truncated: END received after " + utils::to_string(received) + " bytes.");
+                size_t request = std::min(chunkSize, length - received);
+                received += m_transport->read(base + received, request, end);
+            }
+        } else {
+            // Indefinite length: the payload runs until NL^END.
+            while (!end) {
+                char* base = allocate(destination, received + chunkSize);
+                received += m_transport->read(base + received, chunkSize, end);
+            }
+            char* base = allocate(destination, received);
+            if (received > 0 && base[received - 1] == '\n') --received;
+            if (received % elementSize != 0) {
+                throw CommandException("IEEE 488.2 block length " + utils::to_string(received) + " is not a multiple of the element size " + utils::to_string(elementSize) + ".");
+            }
+        }
+
+        // Discard the message terminator that follows a definite-length payload.
+        guard.restore();
+        char trailer[16];
+        for (int i = 0; !end && i < 4; ++i) {
+            m_transport->read(trailer, sizeof(trailer), end);
+        }
+
+        if (start != 0) m_metrics.recordRead(SessionMetrics::now() - start, 2 + digits + received);
+        scope.complete();
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Read binary block of " + utils::to_string(received) + " bytes.");
+        return received;
+    }
+
+    size_t VISACom::readMessage(std::string& out, size_t chunkSize) {
+        out.clear();
+        bool end = false;
+        while (!end) {
+            size_t   offset = out.size();
+            uint64_t start  = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+            out.resize(offset + chunkSize);
+            size_t returnCount = m_transport->read(&out[offset], chunkSize, end);
+            out.resize(offset + returnCount);
+            if (start != 0) m_metrics.recordRead(SessionMetrics::now() - start, returnCount);
+        }
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Read " + utils::to_string(out.size()) + " bytes: " + out);
+        return out.size();
     }
 
     // --- Instrument Control & Status ---
 
     void VISACom::clear() {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
         if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot clear.");
-        Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Clearing instrument interface.");
-        ViStatus status = viClear(m_instrumentHandle);
-        checkStatus(status, "viClear");
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Clearing instrument interface.");
+        m_transport->clear();
+        invalidateCachedState();
     }
 
     uint8_t VISACom::readStatusByte() {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
         if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot read status byte.");
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Reading status byte.");
-        ViUInt16 statusByte = 0;
-        ViStatus status     = viReadSTB(m_instrumentHandle, &statusByte);
-        checkStatus(status, "viReadSTB");
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Status byte received: " + utils::to_string(statusByte));
-        return static_cast<uint8_t>(statusByte);
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Reading status byte.");
+        uint8_t statusByte = m_transport->readStatusByte();
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Status byte received: " + utils::to_string(static_cast<int>(statusByte)));
+        return statusByte;
+    }
+
+    void VISACom::assertTrigger() {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot assert trigger.");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Asserting trigger.");
+        m_transport->assertTrigger();
+        // A trigger applies pending levels, so cached settings are stale.
+        invalidateCachedState();
+    }
+
+    // --- Service Requests ---
+
+    void VISACom::enableServiceRequest() {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot enable service requests.");
+        if (m_serviceRequestEnabled) {
+            return;
+        }
+        m_transport->enableServiceRequest();
+        m_serviceRequestEnabled = true;
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Service request events enabled.");
+    }
+
+    void VISACom::disableServiceRequest() {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!m_serviceRequestEnabled || !isConnected()) {
+            m_serviceRequestEnabled = false;
+            return;
+        }
+        m_serviceRequestEnabled = false;
+        m_transport->disableServiceRequest();
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Service request events disabled.");
+    }
+
+    bool VISACom::isServiceRequestEnabled() const { return m_serviceRequestEnabled; }
+
+    bool VISACom::waitForStatus(uint8_t mask, unsigned int timeout_ms, uint8_t* statusByte) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (!isConnected()) throw ConnectionException("Not connected to an instrument. Cannot wait for a service request.");
+        enableServiceRequest();
+
+        uint64_t                              start    = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        for (;;) {
+            std::chrono::steady_clock::duration remaining = deadline - std::chrono::steady_clock::now();
+            unsigned int wait_ms = remaining.count() > 0 ? static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count()) : 0;
+
+            if (!m_transport->waitForServiceRequest(wait_ms)) {
+                if (start != 0) m_metrics.recordWait(SessionMetrics::now() - start);
+                return false;
+            }
+
+            // The serial poll acknowledges the request and clears RQS.
+            uint8_t stb = readStatusByte();
+            if (stb & mask) {
+                if (statusByte != nullptr) {
+                    *statusByte = stb;
+                }
+                if (start != 0) m_metrics.recordWait(SessionMetrics::now() - start);
+                return true;
+            }
+            CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Ignoring service request with status byte " + utils::to_string(static_cast<int>(stb)) + ".");
+        }
+    }
+
+    void VISACom::setWaitForServiceRequest(bool enable) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        if (enable && isConnected()) {
+            enableServiceRequest();
+        }
+        m_waitForServiceRequest = enable;
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, std::string("Pre-read delays ") + (enable ? "wait for service requests." : "use fixed sleeps."));
+    }
+
+    bool VISACom::isWaitingForServiceRequest() const { return m_waitForServiceRequest; }
+
+    void VISACom::discardServiceRequests() {
+        if (!m_serviceRequestEnabled) {
+            return;
+        }
+        m_transport->discardServiceRequests();
+        readStatusByte();
+    }
+
+    void VISACom::prepareResponseWait(unsigned int delay_ms) {
+        if (m_waitForServiceRequest && delay_ms > 0) {
+            enableServiceRequest();
+            discardServiceRequests();
+        }
+    }
+
+    void VISACom::waitForResponse(unsigned int delay_ms) {
+        if (delay_ms == 0) {
+            return;
+        }
+        if (m_waitForServiceRequest) {
+            // waitForStatus() records the wait.
+            // Bound the wait by the I/O timeout; the read that follows reports a real timeout.
+            unsigned int limit = sessionTimeout();
+            if (!waitForStatus(StatusByte::MAV, limit)) {
+                CVISA_LOG(m_logLevel, LogLevel::WARNING, m_resourceName, "No service request within " + utils::to_string(limit) + " ms; reading anyway.");
+            }
+            return;
+        }
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Delaying for " + utils::to_string(delay_ms) + "ms before reading.");
+        uint64_t start = m_metrics.isRecording() ? SessionMetrics::now() : 0;
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        if (start != 0) m_metrics.recordWait(SessionMetrics::now() - start);
     }
 
     // --- Configuration ---
 
     void VISACom::setVerbose(LogLevel level) {
-        Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Changing log level.");
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Changing log level.");
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
         m_logLevel = level;
+        if (m_transport) m_transport->setLogLevel(level);
     }
 
     void VISACom::enableAutoErrorCheck(bool enable) {
-        Logger::log(m_logLevel, LogLevel::INFO, m_resourceName, "Automatic error checking " + std::string(enable ? "enabled" : "disabled") + ".");
+        CVISA_LOG(m_logLevel, LogLevel::INFO, m_resourceName, "Automatic error checking " + std::string(enable ? "enabled" : "disabled") + ".");
         m_autoErrorCheckEnabled = enable;
     }
 
     void VISACom::setTimeout(unsigned int timeout_ms) {
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Setting timeout to " + utils::to_string(timeout_ms) + " ms.");
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Setting timeout to " + utils::to_string(timeout_ms) + " ms.");
         m_timeout_ms     = timeout_ms;
         m_timeout_ms_set = true;
         applyTimeout();
     }
 
     void VISACom::setReadTermination(char term_char, bool enable) {
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName,
-                    "Setting read termination character to '" + std::string(1, term_char) + "' with enable=" + utils::to_string(enable));
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName,
+                  "Setting read termination character to '" + std::string(1, term_char) + "' with enable=" + utils::to_string(enable));
         m_read_termination     = term_char;
         m_read_termination_set = enable;
         if (isConnected()) {
             if (m_read_termination_set) {
                 applyReadTermination();
             } else {
-                ViStatus status = viSetAttribute(m_instrumentHandle, VI_ATTR_TERMCHAR_EN, VI_FALSE);
-                checkStatus(status, "viSetAttribute (Disable VI_ATTR_TERMCHAR_EN)");
+                m_transport->setReadTermination(m_read_termination, false);
             }
         }
     }
 
     void VISACom::setWriteTermination(char term_char) {
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Setting write termination character to '" + std::string(1, term_char) + "'.");
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Setting write termination character to '" + std::string(1, term_char) + "'.");
         m_write_termination     = term_char;
         m_write_termination_set = true;
         applyWriteTermination();
     }
 
-    // --- Static Utilities ---
+    // --- Metrics ---
 
-    std::vector<std::string> VISACom::findResources(const std::string& query) {
-        ViSession rmSession = VI_NULL;
-        ViStatus  status    = viOpenDefaultRM(&rmSession);
-        if (status < VI_SUCCESS) {
-            throw VisaException("Could not open VISA Default Resource Manager to find resources.");
-        }
+    void VISACom::enableMetrics(bool enable) { m_metrics.setEnabled(enable); }
 
-        ViFindList               findList;
-        ViUInt32                 returnCount = 0;
-        char                     instrumentDescription[VI_FIND_BUFLEN];
-        std::vector<std::string> resources;
+    bool VISACom::isMetricsEnabled() const { return m_metrics.isEnabled(); }
 
-        status = viFindRsrc(rmSession, const_cast<char*>(query.c_str()), &findList, &returnCount, instrumentDescription);
-        if (status < VI_SUCCESS) {
-            viClose(rmSession);
-            if (status == VI_ERROR_RSRC_NFOUND) return {};
-            throw VisaException("Failed to find VISA resources.");
-        }
+    MetricsSnapshot VISACom::getMetrics() const { return m_metrics.snapshot(m_resourceName); }
 
-        resources.emplace_back(instrumentDescription);
-        for (ViUInt32 i = 1; i < returnCount; ++i) {
-            status = viFindNext(findList, instrumentDescription);
-            if (status < VI_SUCCESS) break;
-            resources.emplace_back(instrumentDescription);
-        }
+    void VISACom::resetMetrics() { m_metrics.reset(); }
+
+    // --- Adaptive Timeouts ---
+
+    void VISACom::enableAdaptiveTimeouts(bool enable, unsigned int maxRetries, unsigned int minTimeout_ms, double margin) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        m_adaptivePolicy.configure(maxRetries, minTimeout_ms, margin);
+        m_adaptivePolicy.setEnabled(enable);
+    }
+
+    bool VISACom::isAdaptiveTimeoutEnabled() const {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        return m_adaptivePolicy.isEnabled();
+    }
+
+    void VISACom::enableAdaptiveDelays(bool enable) {
+        std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+        m_adaptivePolicy.setAdaptiveDelays(enable);
+    }
+
+    std::vector<LatencyEstimate> VISACom::getLatencyEstimates() const { return m_adaptivePolicy.estimates(sessionTimeout()); }
+
+    void VISACom::resetLatencyEstimates() { m_adaptivePolicy.reset(); }
+
+    // --- Static Utilities ---
+
+    std::vector<std::string> VISACom::findResources(const std::string& query, bool refresh) {
+#ifdef CVISA_NO_VISA
+        (void)query;
+        (void)refresh;
+        throw VisaException("Cannot find resources: cvisa was built without VISA support.");
+#else
+        return ResourceManager::findResources(query, refresh);
+#endif
+    }
 
-        viClose(findList);
-        viClose(rmSession);
+    void VISACom::setSessionPoolSize(size_t maxIdleSessions) {
+        std::deque<IdleSession> evicted;
+        {
+            std::lock_guard<std::mutex> lock(s_sessionPoolMutex);
+            s_maxIdleSessions = maxIdleSessions;
+            while (s_idleSessions.size() > maxIdleSessions) {
+                evicted.push_back(std::move(s_idleSessions.front()));
+                s_idleSessions.pop_front();
+            }
+        }
+        for (auto& session : evicted) session.transport->close();
+    }
 
-        return resources;
+    size_t VISACom::idleSessionCount() {
+        std::lock_guard<std::mutex> lock(s_sessionPoolMutex);
+        return s_idleSessions.size();
     }
 
     // --- Private Helpers ---
 
+    bool VISACom::recoverConnection() {
+        if (!m_autoReconnectEnabled || !m_sessionOpen || m_reconnecting) return false;
+        reconnect();
+        return true;
+    }
+
+    bool VISACom::tryRecoverConnection() {
+        try {
+            return recoverConnection();
+        } catch (const VisaException&) {
+            return false;
+        }
+    }
+
+    unsigned int VISACom::sessionTimeout() const { return m_timeout_ms_set ? m_timeout_ms : s_visaDefaultTimeout_ms; }
+
     void VISACom::applyTimeout() {
         if (!isConnected() || !m_timeout_ms_set) return;
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Applying timeout: " + utils::to_string(m_timeout_ms) + " ms.");
-        ViStatus status = viSetAttribute(m_instrumentHandle, VI_ATTR_TMO_VALUE, m_timeout_ms);
-        checkStatus(status, "viSetAttribute (Timeout)");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Applying timeout: " + utils::to_string(m_timeout_ms) + " ms.");
+        m_transport->setTimeout(m_timeout_ms);
     }
 
     void VISACom::applyReadTermination() {
         if (!isConnected() || !m_read_termination_set) return;
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Applying read termination char '" + std::string(1, m_read_termination) + "' with enable=true");
-        ViStatus status;
-        status = viSetAttribute(m_instrumentHandle, VI_ATTR_TERMCHAR, static_cast<ViInt8>(m_read_termination));
-        checkStatus(status, "viSetAttribute (VI_ATTR_TERMCHAR for Read)");
-        status = viSetAttribute(m_instrumentHandle, VI_ATTR_TERMCHAR_EN, VI_TRUE);
-        checkStatus(status, "viSetAttribute (VI_ATTR_TERMCHAR_EN for Read)");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Applying read termination char '" + std::string(1, m_read_termination) + "' with enable=true");
+        m_transport->setReadTermination(m_read_termination, true);
     }
 
     void VISACom::applyWriteTermination() {
         if (!isConnected() || !m_write_termination_set) return;
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Applying write termination char '" + std::string(1, m_write_termination) + "'.");
-        ViStatus status;
-        status = viSetAttribute(m_instrumentHandle, VI_ATTR_TERMCHAR, static_cast<ViInt8>(m_write_termination));
-        checkStatus(status, "viSetAttribute (VI_ATTR_TERMCHAR for Write)");
-        status = viSetAttribute(m_instrumentHandle, VI_ATTR_SEND_END_EN, VI_TRUE);
-        checkStatus(status, "viSetAttribute (VI_ATTR_SEND_END_EN for Write)");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Applying write termination char '" + std::string(1, m_write_termination) + "'.");
+        m_transport->setWriteTermination(m_write_termination);
     }
 
     void VISACom::applyConfiguration() {
-        Logger::log(m_logLevel, LogLevel::DEBUG, m_resourceName, "Applying stored configurations.");
+        CVISA_LOG(m_logLevel, LogLevel::DEBUG, m_resourceName, "Applying stored configurations.");
         applyTimeout();
         applyReadTermination();
         applyWriteTermination();
     }
 
-    void VISACom::checkStatus(ViStatus status, const std::string& functionName) {
-        if (status < VI_SUCCESS) {
-            char errorBuffer[256] = {0};
-            viStatusDesc(m_resourceManagerHandle, status, errorBuffer);
-            std::string errorMessage = "VISA Error in " + functionName + ": " + errorBuffer + " (Status: " + utils::to_string(status) + ")";
-            Logger::log(m_logLevel, LogLevel::ERROR, m_resourceName, errorMessage);
-            if (status == VI_ERROR_TMO) throw TimeoutException(errorMessage);
-            if (status == VI_ERROR_RSRC_NFOUND || status == VI_ERROR_RSRC_LOCKED || status == VI_ERROR_CONN_LOST) {
-                throw ConnectionException(errorMessage);
-            } else if (status == VI_ERROR_INV_EXPR || status == VI_ERROR_NLISTENERS) {
-                throw CommandException(errorMessage);
-            } else {
-                throw VisaException(errorMessage);
-            }
-        }
-    }
-
 }    // namespace cvisa
@@ -1,20 +1,64 @@
 #ifndef CVISA_VISA_INTERFACE_HPP
 #define CVISA_VISA_INTERFACE_HPP
 
+#include "AdaptivePolicy.hpp"
+#include "CommandQueue.hpp"
 #include "Logger.hpp"
+#include "Metrics.hpp"
+#include "Result.hpp"
+#include "Transport.hpp"
+#include "../utils/utils.hpp"
 
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
-// Forward-declare VISA types to avoid including visa.h in a public header.
-using ViSession = unsigned long;
-using ViStatus  = long;
-
 namespace cvisa {
 
+    /**
+     * @enum ByteOrder
+     * @brief Byte order of multi-byte values inside a binary block.
+     *
+     * IEEE 488.2 instruments default to big-endian ("normal") transfers; many
+     * also offer a little-endian ("swapped") mode, e.g. via `FORM:BORD SWAP`.
+     */
+    enum class ByteOrder {
+        BIG,       // Most significant byte first (network order).
+        LITTLE     // Least significant byte first.
+    };
+
+    /**
+     * @brief Bits of the IEEE 488.2 status byte (STB) and service request enable register (SRE).
+     */
+    struct StatusByte {
+        static constexpr uint8_t EAV = 0x04;    // Error queue not empty (SCPI-99; not on older instruments).
+        static constexpr uint8_t MAV = 0x10;    // Message available in the output queue.
+        static constexpr uint8_t ESB = 0x20;    // Event status summary (ESR & ESE is non-zero).
+        static constexpr uint8_t RQS = 0x40;    // Requesting service (only reported by a serial poll).
+    };
+
+    /**
+     * @brief Bits of the IEEE 488.2 standard event status register (ESR) and its enable register (ESE).
+     */
+    struct EventStatus {
+        static constexpr uint8_t OPC = 0x01;    // Operation complete (set by *OPC).
+        static constexpr uint8_t QYE = 0x04;    // Query error.
+        static constexpr uint8_t DDE = 0x08;    // Device-dependent error.
+        static constexpr uint8_t EXE = 0x10;    // Execution error.
+        static constexpr uint8_t CME = 0x20;    // Command error.
+        static constexpr uint8_t PON = 0x80;    // Power on.
+
+        static constexpr uint8_t ERRORS = QYE | DDE | EXE | CME;    // All error bits.
+    };
+
     /**
      * @class VISACom
      * @brief A C++11 compliant RAII wrapper for the VISA C API with flexible
@@ -23,6 +67,16 @@ namespace cvisa {
      * This class encapsulates a VISA session. It can be constructed with a VISA
      * resource string for immediate connection (RAII-style) or constructed empty
      * for manual connection management.
+     *
+     * All I/O methods are thread-safe: a per-session lock guarantees that the
+     * write and read halves of a query are never interleaved with another
+     * thread's traffic. Asynchronous requests are executed in submission order
+     * by a single per-session worker thread.
+     *
+     * Bytes are moved by a `Transport`. Unless one is installed with
+     * `setTransport()`, `connect()` opens a `SocketTransport` for
+     * `TCPIP::host::port::SOCKET` resources and a `VisaTransport` on the vendor
+     * VISA library for everything else.
      */
     class VISACom {
       protected:
@@ -35,9 +89,10 @@ namespace cvisa {
         char         m_write_termination;
         bool         m_write_termination_set;
 
-        // VISA handles
-        ViSession m_resourceManagerHandle;
-        ViSession m_instrumentHandle;
+        // The link to the instrument. Created on the first `connect()` if not set.
+        std::unique_ptr<Transport> m_transport;
+        bool                       m_defaultTransport;        // Chosen by `connect()` for the resource string.
+        bool                       m_nativeSocketsEnabled;    // `connect()` may choose a `SocketTransport`.
 
         // Logging
         LogLevel m_logLevel;
@@ -45,6 +100,36 @@ namespace cvisa {
         // Error Checking
         bool m_autoErrorCheckEnabled;
 
+        // Session-owned receive buffer. It only grows, so steady-state reads
+        // do not touch the heap.
+        std::vector<char> m_readBuffer;
+
+        // Serializes all I/O on this session. Recursive so that composite
+        // operations (e.g., a query) can hold it across their write and read.
+        mutable std::recursive_mutex m_ioMutex;
+
+        // Worker that executes asynchronous requests in FIFO order.
+        CommandQueue m_commandQueue;
+
+        // Service requests
+        bool m_serviceRequestEnabled;    // SRQ events are queued for this session.
+        bool m_waitForServiceRequest;    // Pre-read delays wait for an SRQ instead of sleeping.
+
+        // Per-command call counts, byte counts and latencies.
+        SessionMetrics m_metrics;
+
+        // Per-command timeouts, pre-read delays and retries learned from latency.
+        AdaptivePolicy m_adaptivePolicy;
+
+        // Reconnection
+        bool         m_sessionOpen;               // Between `connect()` and `disconnect()`, even if the link was lost.
+        bool         m_autoReconnectEnabled;      // I/O reconnects after a `ConnectionException`.
+        unsigned int m_reconnectAttempts;         // Opens per `reconnect()`, including the first.
+        unsigned int m_reconnectBackoff_ms;       // Delay after the first failed open; doubles per attempt.
+        unsigned int m_reconnectMaxBackoff_ms;    // Upper bound for the delay.
+        bool         m_reconnecting;              // Set while `reconnect()` runs, which must not recurse.
+        uint64_t     m_reconnectCount;            // Successful reconnects.
+
       public:
         // --- Constructors and Destructor ---
         /**
@@ -142,7 +227,8 @@ namespace cvisa {
          *
          * When enabled, the driver will query the instrument's error queue
          * (SYST:ERR?) after every `write` or `query` operation and throw an
-         * exception if an error is reported.
+         * exception if an error is reported. `SCPIBase::setErrorCheckMode()`
+         * selects cheaper strategies for drivers.
          *
          * @param enable True to enable automatic error checking, false to disable.
          */
@@ -180,6 +266,74 @@ namespace cvisa {
          */
         bool isConnected() const;
 
+        /**
+         * @brief Re-opens the session after the link to the instrument was lost.
+         *
+         * Closes the transport and opens it again, retrying with an exponential
+         * backoff and jitter as set by `enableAutoReconnect()`. Once open, the
+         * stored configuration (timeout, termination characters) and SRQ events
+         * are restored, `invalidateCachedState()` runs, and derived classes
+         * replay their instrument state via `restoreInstrumentState()`.
+         *
+         * @throws ConnectionException if no resource name is set or every attempt fails.
+         */
+        void reconnect();
+
+        /**
+         * @brief Enables or disables reconnecting transparently after a lost link.
+         *
+         * While enabled, a write or query that fails with a `ConnectionException`
+         * between `connect()` and `disconnect()` calls `reconnect()` and is
+         * executed once more on the new session. A query is repeated as a whole,
+         * since its response was lost with the link. A plain `read()` reconnects
+         * on the next write but still throws, and a failed reconnect throws
+         * `ConnectionException` as before; the next call tries again.
+         *
+         * @param enable True to reconnect automatically, false to throw immediately.
+         * @param maxAttempts Opens per reconnect, including the first (at least 1).
+         * @param backoff_ms Delay after the first failed open. Doubles per attempt;
+         * each delay is randomized between half and all of its value.
+         * @param maxBackoff_ms Upper bound for the delay.
+         */
+        void enableAutoReconnect(bool enable = true, unsigned int maxAttempts = 5, unsigned int backoff_ms = 20, unsigned int maxBackoff_ms = 2000);
+
+        /**
+         * @brief Returns the number of successful reconnects of this session.
+         */
+        uint64_t getReconnectCount() const;
+
+        /**
+         * @brief Installs the transport used by the next `connect()`.
+         *
+         * Replaces the default `VisaTransport`, e.g. with a `SimulatedTransport`
+         * to run a driver without hardware or a VISA installation:
+         *
+         * ```cpp
+         * Agilent66xxA psu;
+         * psu.setTransport(std::unique_ptr<Transport>(new SimulatedTransport()));
+         * psu.connect("SIM::PSU");
+         * ```
+         *
+         * @param transport The transport. The session takes ownership.
+         * @throws ConnectionException if the interface is connected.
+         */
+        void setTransport(std::unique_ptr<Transport> transport);
+
+        /**
+         * @brief Returns the session's transport, or nullptr before the first `connect()`.
+         */
+        Transport* getTransport() const;
+
+        /**
+         * @brief Selects whether `connect()` talks to `::SOCKET` resources directly.
+         *
+         * Enabled by default: such resources are opened with a `SocketTransport`,
+         * which bypasses the VISA stack. Disable it to use the vendor's socket
+         * implementation instead. Takes effect on the next `connect()` and has no
+         * effect on transports installed with `setTransport()`.
+         */
+        void enableNativeSockets(bool enable = true);
+
         // --- Core I/O Operations ---
         /**
          * @brief Writes a command string to the instrument.
@@ -215,6 +369,42 @@ namespace cvisa {
          */
         virtual std::string read(size_t bufferSize = 2048);
 
+        /**
+         * @brief Reads a string-based response into a caller-owned string.
+         *
+         * The response is received into the session's read buffer and copied
+         * into `out`, which is sized to the response rather than to
+         * `bufferSize`: a short response fits a fresh string without a heap
+         * allocation, and a reused string stops allocating once it has held
+         * the longest response. This makes it the preferred overload for tight
+         * polling loops.
+         *
+         * @param out The string that receives the response. Its previous
+         * contents are replaced.
+         * @param bufferSize The maximum number of bytes to read.
+         * @return The number of bytes read.
+         * @throws ConnectionException if the interface is not connected.
+         * @throws TimeoutException if the read operation times out.
+         * @throws CommandException on other VISA communication errors.
+         */
+        size_t read(std::string& out, size_t bufferSize = 2048);
+
+        /**
+         * @brief Reads raw bytes directly into caller-provided memory.
+         *
+         * No intermediate buffer is used: the data is delivered by VISA
+         * straight into `buffer`. Reading stops after `capacity` bytes or when
+         * a termination character is encountered if one has been configured.
+         *
+         * @param buffer The destination memory.
+         * @param capacity The size of the destination memory in bytes.
+         * @return The number of bytes read.
+         * @throws ConnectionException if the interface is not connected.
+         * @throws TimeoutException if the read operation times out.
+         * @throws CommandException on other VISA communication errors.
+         */
+        size_t readInto(char* buffer, size_t capacity);
+
         /**
          * @brief Reads a block of binary data from the instrument.
          *
@@ -231,6 +421,22 @@ namespace cvisa {
          */
         virtual std::vector<uint8_t> readBinary(size_t bufferSize = 4096);
 
+        /**
+         * @brief Reads a block of binary data into a caller-owned vector.
+         *
+         * The vector is resized to the number of bytes received. Its capacity
+         * is reused across calls, so no allocation happens once it has grown to
+         * `bufferSize`.
+         *
+         * @param out The vector that receives the data.
+         * @param bufferSize The maximum number of bytes to read.
+         * @return The number of bytes read.
+         * @throws ConnectionException if the interface is not connected.
+         * @throws TimeoutException if the read operation times out.
+         * @throws CommandException on other VISA communication errors.
+         */
+        size_t readBinary(std::vector<uint8_t>& out, size_t bufferSize = 4096);
+
         /**
          * @brief Performs a query: writes a command and reads the response.
          *
@@ -245,18 +451,214 @@ namespace cvisa {
          */
         virtual std::string query(const std::string& command, size_t bufferSize = 2048, unsigned int delay_ms = 0);
 
+        /**
+         * @brief Performs a query and stores the response in a caller-owned string.
+         *
+         * This is the allocation-free counterpart of `query()`: both the
+         * command and the response buffers are owned by the caller and can be
+         * reused from one call to the next.
+         *
+         * @param command The SCPI query string to send.
+         * @param response The string that receives the response.
+         * @param bufferSize The maximum number of bytes to expect in the response.
+         * @param delay_ms An optional delay in milliseconds to wait between the
+         * write and read operations.
+         * @return The number of bytes read.
+         * @throws ConnectionException if the interface is not connected.
+         * @throws TimeoutException if the read operation times out.
+         * @throws CommandException on other VISA communication errors.
+         */
+        size_t query(const std::string& command, std::string& response, size_t bufferSize = 2048, unsigned int delay_ms = 0);
+
+        /**
+         * @brief Writes a command without throwing.
+         *
+         * The non-throwing counterpart of `write()`, for polling loops in which
+         * failures such as a missing instrument are routine. Failures are
+         * returned instead of thrown, and their description is only formatted
+         * if `IoStatus::description()` is called.
+         *
+         * @param command The command string to send.
+         * @return The status of the write.
+         */
+        IoStatus tryWrite(const std::string& command);
+
+        /**
+         * @brief Reads a response without throwing.
+         *
+         * @param out The string that receives the response. Unchanged on failure.
+         * @param bufferSize The maximum number of bytes to read.
+         * @return The status of the read; `StatusCode::TIMEOUT` if no response arrived in time.
+         */
+        IoStatus tryRead(std::string& out, size_t bufferSize = 2048);
+
+        /**
+         * @brief Performs a query without throwing.
+         *
+         * Behaves like `query(command, response, ...)`, including the pre-read
+         * delay and one retry after an automatic reconnect, but returns failures
+         * as an `IoStatus`.
+         *
+         * @code
+         * std::string response;
+         * if (!instrument.tryQuery("MEAS:VOLT?", response)) {
+         *     // Not answering this cycle.
+         * }
+         * @endcode
+         *
+         * @param command The SCPI query string to send.
+         * @param response The string that receives the response. Unchanged on failure.
+         * @param bufferSize The maximum number of bytes to expect in the response.
+         * @param delay_ms An optional delay in milliseconds between the write and the read.
+         * @return The status of the query.
+         */
+        IoStatus tryQuery(const std::string& command, std::string& response, size_t bufferSize = 2048, unsigned int delay_ms = 0);
+
         /**
          * @brief Performs a query asynchronously.
          *
+         * The query is appended to the session's request queue and executed by
+         * its worker thread. Futures are fulfilled in submission order, and
+         * callers on any number of threads may submit concurrently.
+         *
          * @param command The SCPI query string to send.
          * @param bufferSize The maximum number of bytes for the response.
          * @param delay_ms Optional delay between write and read.
          * @return A `std::future<std::string>` that will hold the instrument's
-         * response.
+         * response. If the session is disconnected before the query runs, the
+         * future throws `ConnectionException`.
          * @throws ConnectionException if the interface is not connected.
          */
         virtual std::future<std::string> queryAsync(const std::string& command, size_t bufferSize = 2048, unsigned int delay_ms = 0);
 
+        /**
+         * @brief Receives the responses of `queryPipeline()`.
+         *
+         * Called with the position of the query in the command list and its
+         * response, including the terminator. The response buffer is reused for
+         * the next response.
+         */
+        typedef std::function<void(size_t index, const std::string& response)> PipelineCallback;
+
+        /**
+         * @brief Sends queries back to back with up to `depth` responses outstanding.
+         *
+         * `query()` leaves the bus idle while the instrument prepares each
+         * response. A pipeline writes the next queries while earlier responses
+         * are still pending, so their round trips overlap. Instruments that
+         * buffer their input and output (most LAN and USBTMC instruments)
+         * answer in order, and responses are matched to queries by position.
+         * Each response is framed like a `read()`: it ends at the termination
+         * character set with `setReadTermination()` or at END, so the
+         * instrument must terminate its responses and each command must
+         * produce exactly one.
+         *
+         * The session lock is held and `callback` is called with it held.
+         * Keep `depth` within the instrument's buffer sizes. If a query fails
+         * or `callback` throws while responses are still outstanding, the
+         * instrument is cleared (`clear()`) before the exception propagates,
+         * so the next query is not answered by a pipelined one.
+         *
+         * @param commands The queries, in order.
+         * @param depth The maximum number of queries awaiting a response. 1
+         * behaves like calling `query()` for each command; 0 is treated as 1.
+         * @param callback Receives each response as soon as it has been read.
+         * @param chunkSize The read size; longer responses are read in several chunks.
+         * @throws ConnectionException if the interface is not connected.
+         * @throws CommandException if a command is not a query (has no '?'),
+         * before anything is sent, or on a communication error.
+         * @throws TimeoutException if a response does not arrive in time.
+         */
+        void queryPipeline(const std::vector<std::string>& commands, size_t depth, const PipelineCallback& callback, size_t chunkSize = 2048);
+
+        /**
+         * @brief Sends queries back to back and returns their responses in order.
+         *
+         * See the callback overload for the requirements.
+         */
+        std::vector<std::string> queryPipeline(const std::vector<std::string>& commands, size_t depth = 8, size_t chunkSize = 2048);
+
+        /**
+         * @brief Runs an arbitrary operation on the session's worker thread.
+         *
+         * The task is queued behind all previously submitted asynchronous
+         * requests. This allows multi-step sequences (e.g., a driver method
+         * call) to be issued asynchronously while keeping per-session
+         * ordering.
+         *
+         * @tparam F A callable taking no arguments.
+         * @param task The operation to run.
+         * @return A future holding the task's result or exception.
+         */
+        template <typename F>
+        std::future<typename std::result_of<F()>::type> submit(F task) {
+            return m_commandQueue.submit(std::move(task));
+        }
+
+        // --- IEEE 488.2 Block Transfers ---
+        /**
+         * @brief Reads an IEEE 488.2 block (`#<n><len><payload>`) into a vector.
+         *
+         * The header is parsed first, the destination is sized once to the
+         * announced payload length and the payload is then read in chunks
+         * straight into the destination memory. Read termination is suspended
+         * for the duration of the transfer, so payload bytes that happen to
+         * match the termination character do not cut the block short. The
+         * indefinite-length form (`#0<payload>`) is also accepted; it is read
+         * until the instrument asserts END. Transports without END (native
+         * `::SOCKET` sessions) reject it, since its end cannot be detected.
+         *
+         * When `T` is wider than one byte, the payload is decoded in place from
+         * the given byte order into host order.
+         *
+         * @tparam T The element type (e.g., `uint8_t`, `int16_t`, `float`).
+         * @param values The vector that receives the decoded elements.
+         * @param order The byte order used by the instrument.
+         * @param chunkSize The maximum number of bytes requested per `viRead`.
+         * @return The number of elements received.
+         * @throws ConnectionException if the interface is not connected.
+         * @throws TimeoutException if the read operation times out.
+         * @throws CommandException if the header is malformed, the payload
+         * length is not a multiple of `sizeof(T)`, or the block is
+         * indefinite-length on a transport without END.
+         */
+        template <typename T>
+        size_t readDefiniteLengthBlock(std::vector<T>& values, ByteOrder order = ByteOrder::BIG, size_t chunkSize = 65536) {
+            static_assert(std::is_arithmetic<T>::value, "Binary blocks can only be decoded into arithmetic types.");
+            size_t bytes = readBlock(&resizeBlockStorage<T>, &values, sizeof(T), chunkSize);
+            values.resize(bytes / sizeof(T));
+            if (sizeof(T) > 1 && (order == ByteOrder::LITTLE) != utils::isLittleEndianHost()) {
+                utils::swapByteOrder(values.data(), values.size());
+            }
+            return values.size();
+        }
+
+        /**
+         * @brief Sends a query and reads its IEEE 488.2 block response.
+         *
+         * @tparam T The element type (e.g., `uint8_t`, `int16_t`, `float`).
+         * @param command The SCPI query string to send (e.g., "CURV?").
+         * @param values The vector that receives the decoded elements.
+         * @param order The byte order used by the instrument.
+         * @param delay_ms An optional delay in milliseconds to wait between the
+         * write and read operations.
+         * @return The number of elements received.
+         * @throws ConnectionException if the interface is not connected.
+         * @throws TimeoutException if the read operation times out.
+         * @throws CommandException if the response is not a valid block.
+         */
+        template <typename T>
+        size_t queryBinaryBlock(const std::string& command, std::vector<T>& values, ByteOrder order = ByteOrder::BIG, unsigned int delay_ms = 0) {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            MetricsScope                          scope(m_metrics, SessionMetrics::QUERY);
+            prepareResponseWait(delay_ms);
+            write(command);
+            waitForResponse(delay_ms);
+            size_t count = readDefiniteLengthBlock(values, order);
+            scope.complete();
+            return count;
+        }
+
         // --- Instrument Control & Status ---
         /**
          * @brief Clears the communication interface of the instrument.
@@ -286,16 +688,329 @@ namespace cvisa {
          */
         uint8_t readStatusByte();
 
+        /**
+         * @brief Triggers the instrument with a bus-level trigger.
+         *
+         * Sends a GPIB Group Execute Trigger (or the bus's equivalent, `*TRG` on
+         * socket sessions) with `viAssertTrigger`. Unlike a trigger command, it
+         * is not parsed by the instrument, so it fires with less latency.
+         *
+         * @throws ConnectionException if the interface is not connected.
+         * @throws VisaException on a VISA communication error.
+         */
+        void assertTrigger();
+
+        // --- Service Requests ---
+        /**
+         * @brief Starts queuing service request (SRQ) events for this session.
+         *
+         * The instrument only asserts SRQ for the conditions selected in its
+         * service request enable register (`*SRE`); see `SCPIBase` for helpers
+         * that program it.
+         *
+         * @throws ConnectionException if the interface is not connected.
+         * @throws VisaException if the interface does not support SRQ events.
+         */
+        void enableServiceRequest();
+
+        /**
+         * @brief Stops queuing SRQ events and discards any pending ones.
+         */
+        void disableServiceRequest();
+
+        /**
+         * @brief Returns true if SRQ events are queued for this session.
+         */
+        bool isServiceRequestEnabled() const;
+
+        /**
+         * @brief Waits for a service request whose status byte has any of the given bits set.
+         *
+         * Blocks on the VISA event queue instead of polling, so it returns as soon
+         * as the instrument asserts SRQ. Each SRQ is acknowledged with a serial poll,
+         * which also clears RQS. Requests for other reasons are skipped. SRQ events
+         * are enabled on first use.
+         *
+         * @param mask The status byte bits to wait for (e.g., `StatusByte::MAV`).
+         * @param timeout_ms The maximum time to wait in milliseconds.
+         * @param statusByte If not null, receives the status byte of the matching request.
+         * @return True if a matching request arrived, false on timeout.
+         * @throws ConnectionException if the interface is not connected.
+         * @throws VisaException on a VISA communication error.
+         */
+        bool waitForStatus(uint8_t mask, unsigned int timeout_ms, uint8_t* statusByte = nullptr);
+
+        /**
+         * @brief Makes pre-read delays wait for a service request instead of sleeping.
+         *
+         * When enabled, a query with a non-zero `delay_ms` no longer sleeps for
+         * that fixed time. It waits until the instrument reports a message
+         * available (MAV) through SRQ, bounded by the session timeout, and then
+         * reads. The instrument must request service on MAV (`*SRE 16`);
+         * `SCPIBase::useServiceRequestForQueries()` configures both sides.
+         *
+         * @param enable True to wait for SRQ, false to restore fixed sleeps.
+         * @throws VisaException if SRQ events cannot be enabled.
+         */
+        void setWaitForServiceRequest(bool enable);
+
+        /**
+         * @brief Returns true if pre-read delays wait for a service request.
+         */
+        bool isWaitingForServiceRequest() const;
+
+        // --- Metrics ---
+        /**
+         * @brief Starts or stops collecting per-command metrics.
+         *
+         * While enabled, every operation records its call count, bytes written and
+         * read, and the time spent writing, waiting and reading, keyed by the
+         * driver command template (e.g., "VOLT %f"). Raw I/O through `write()`,
+         * `read()` and `query()` is grouped under "(write)", "(read)" and
+         * "(query)". Collection is disabled by default.
+         *
+         * @param enable True to collect metrics, false to stop. Accumulated
+         * statistics are kept until `resetMetrics()`.
+         */
+        void enableMetrics(bool enable = true);
+
+        /**
+         * @brief Returns true if per-command metrics are being collected.
+         */
+        bool isMetricsEnabled() const;
+
+        /**
+         * @brief Returns a copy of the accumulated metrics.
+         *
+         * Does not wait for I/O in progress, so it can be called from a
+         * monitoring thread at any rate. Use `MetricsSnapshot::toJson()` or
+         * `toPrometheus()` to export the result.
+         */
+        MetricsSnapshot getMetrics() const;
+
+        /**
+         * @brief Discards the accumulated metrics.
+         */
+        void resetMetrics();
+
+        // --- Adaptive Timeouts ---
+        /**
+         * @brief Derives each driver query's timeout from its observed latency.
+         *
+         * While enabled, queries issued as driver commands (`SCPIBase::executeCommand()`,
+         * `queryAndParse()`, `tryQuery()`, ...) run with a timeout learned per
+         * command template by an `AdaptivePolicy`: a few times the command's
+         * 99th-percentile latency, never below `minTimeout_ms` and never above
+         * the session timeout set by `setTimeout()`. A fast status query on an
+         * instrument that stopped answering therefore fails after milliseconds
+         * rather than after the session timeout. Each timeout doubles the
+         * command's next timeout until it succeeds again.
+         *
+         * Every query that times out is followed by a device clear, so a late
+         * response cannot answer the next query. An idempotent query is then
+         * sent again up to `maxRetries` times. Queries marked as not idempotent
+         * in their `SCPICommand` (e.g., `*ESR?`, which clears the register) are
+         * not repeated. Other operations keep the session timeout. Timing is
+         * independent of `enableMetrics()`.
+         *
+         * @param enable True to adapt timeouts, false to use the session timeout.
+         * Learned latencies are kept until `resetLatencyEstimates()`.
+         * @param maxRetries Times a timed-out idempotent query is sent again.
+         * @param minTimeout_ms The shortest timeout used.
+         * @param margin The factor between a command's 99th-percentile latency and its timeout.
+         */
+        void enableAdaptiveTimeouts(bool enable = true, unsigned int maxRetries = 1, unsigned int minTimeout_ms = 20, double margin = 3.0);
+
+        /**
+         * @brief Returns true if driver queries use learned timeouts.
+         */
+        bool isAdaptiveTimeoutEnabled() const;
+
+        /**
+         * @brief Shortens the fixed pre-read delays of adaptive queries to what the instrument needs.
+         *
+         * While a command's response is already waiting when its delay ends, the
+         * delay is shortened by a quarter per call; any failure restores the
+         * delay of its `SCPICommand`. Only use this with instruments that hold a
+         * read until the response is ready, as IEEE 488.2 instruments do.
+         * Takes effect while `enableAdaptiveTimeouts()` is active.
+         *
+         * @param enable True to adapt delays, false to use the declared ones.
+         */
+        void enableAdaptiveDelays(bool enable = true);
+
+        /**
+         * @brief Returns the learned latency, timeout and delay of every adaptive command.
+         *
+         * Can be called from any thread without waiting for I/O.
+         */
+        std::vector<LatencyEstimate> getLatencyEstimates() const;
+
+        /**
+         * @brief Discards the learned latencies; commands start over with the session timeout.
+         */
+        void resetLatencyEstimates();
+
         // --- Static Utilities ---
-        static std::vector<std::string> findResources(const std::string& query = "?*INSTR");
+        /**
+         * @brief Finds connected VISA resources matching a query.
+         *
+         * Results are cached per query by the shared `ResourceManager`. Pass
+         * `refresh = true` to enumerate the buses again, e.g. after hot-plugging
+         * an instrument.
+         *
+         * @param query The VISA resource expression (default: all instruments).
+         * @param refresh If true, bypasses and updates the discovery cache.
+         * @return The matching resource strings.
+         * @throws VisaException if the resources cannot be enumerated.
+         */
+        static std::vector<std::string> findResources(const std::string& query = "?*INSTR", bool refresh = false);
+
+        /**
+         * @brief Keeps up to `maxIdleSessions` sessions open after `disconnect()` for reuse.
+         *
+         * With a non-zero size, `disconnect()` (and so destroying a driver) parks
+         * a transport that `connect()` created instead of closing it, and a later
+         * `connect()` to the same resource takes it over without `viOpen()` or a
+         * new TCP connection. The oldest idle session is closed when the pool is
+         * full. A session is cleared before it is parked, so no pending response
+         * reaches the next owner, and a reused session starts with the
+         * transport's default timeout and terminations for anything its new
+         * owner did not set. A session whose clear fails is closed instead.
+         * Transports installed with `setTransport()` are never pooled.
+         *
+         * @param maxIdleSessions The pool capacity. 0 (the default) closes all
+         * idle sessions and disables pooling.
+         */
+        static void setSessionPoolSize(size_t maxIdleSessions);
+
+        /**
+         * @brief Returns the number of idle sessions in the pool.
+         */
+        static size_t idleSessionCount();
+
+      protected:
+        /**
+         * @brief Runs all pending asynchronous requests and stops the worker.
+         *
+         * Derived classes whose state is used by queued tasks should call this
+         * from their destructor, before that state is destroyed.
+         */
+        void stopCommandQueue() { m_commandQueue.stop(); }
+
+        /**
+         * @brief Prepares a wait for a service request caused by the next command.
+         *
+         * Discards stale SRQ events and clears RQS with a serial poll, so that a
+         * following `waitForStatus()` only sees requests raised after this call.
+         * Only does work if SRQ events are enabled.
+         */
+        void discardServiceRequests();
+
+        /**
+         * @brief Called before writing a query that has a pre-read delay.
+         */
+        void prepareResponseWait(unsigned int delay_ms);
+
+        /**
+         * @brief Waits between writing a query and reading its response.
+         *
+         * Sleeps for `delay_ms`, or waits for MAV through SRQ if
+         * `setWaitForServiceRequest(true)` is active.
+         */
+        void waitForResponse(unsigned int delay_ms);
+
+        /**
+         * @brief Sends a query and reads its whole response, however long.
+         *
+         * Unlike `query()`, which reads at most `bufferSize` bytes, the response
+         * is read in chunks until the transport reports END (or the read
+         * termination character), so compound responses of batches and command
+         * chains are never truncated or split.
+         *
+         * @param command The command to send.
+         * @param response The string that receives the response.
+         * @param delay_ms An optional delay in milliseconds between the write and the read.
+         * @param chunkSize The number of bytes requested per read.
+         * @return The number of bytes read.
+         * @throws ConnectionException if the interface is not connected.
+         * @throws VisaException on a communication error.
+         */
+        size_t queryMessage(const std::string& command, std::string& response, unsigned int delay_ms = 0, size_t chunkSize = 2048);
+
+        /**
+         * @brief A query with the timeout and delay of `m_adaptivePolicy`.
+         *
+         * Records the latency of a successful call under `key` and sends a
+         * timed-out idempotent query again as configured by
+         * `enableAdaptiveTimeouts()`. The instrument is cleared after every
+         * timeout, including the last, and the session timeout is restored
+         * before returning.
+         *
+         * @param key The command template the latency is recorded under. Must
+         * outlive the session, such as an `SCPICommand` string literal.
+         * @param command The formatted command.
+         * @param response The string that receives the response.
+         * @param bufferSize The size of the read buffer.
+         * @param delay_ms The command's declared pre-read delay.
+         * @param idempotent True if the query may be sent again after a timeout.
+         * @return The status of the last attempt.
+         */
+        IoStatus tryAdaptiveQuery(const char* key, const std::string& command, std::string& response, size_t bufferSize, unsigned int delay_ms, bool idempotent);
+
+        /**
+         * @brief Called when the instrument state may no longer match what the session wrote.
+         *
+         * Runs after connecting, after disconnecting and after a device clear.
+         * Derived classes that cache instrument state override it to drop that
+         * state. The default does nothing.
+         */
+        virtual void invalidateCachedState() {}
+
+        /**
+         * @brief Called by `reconnect()` once the new session is open and configured.
+         *
+         * Derived classes replay instrument settings the session relies on, in
+         * case the instrument was power-cycled. The default does nothing.
+         */
+        virtual void restoreInstrumentState() {}
 
       private:
+        // --- Block Transfer Helpers ---
+        // Grows the destination to hold at least `bytes` bytes and returns its storage.
+        typedef char* (*BlockAllocator)(void* destination, size_t bytes);
+
+        template <typename T>
+        static char* resizeBlockStorage(void* destination, size_t bytes) {
+            std::vector<T>& values = *static_cast<std::vector<T>*>(destination);
+            values.resize((bytes + sizeof(T) - 1) / sizeof(T));
+            return reinterpret_cast<char*>(values.data());
+        }
+
+        size_t readBlock(BlockAllocator allocate, void* destination, size_t elementSize, size_t chunkSize);
+
+        // Reads one complete response (up to END or the termination character) into `out`.
+        size_t readMessage(std::string& out, size_t chunkSize);
+
+        // Writes `command` once, without reconnecting on a lost link. Queries use
+        // these and reconnect themselves, so one query runs at most one reconnect.
+        void     writeOnce(const std::string& command);
+        IoStatus tryWriteOnce(const std::string& command);
+
+        // --- Reconnection Helpers ---
+        // Reconnects if automatic reconnects are enabled and the session should be open.
+        bool recoverConnection();
+        // `recoverConnection()` for the non-throwing API: a failed reconnect returns false.
+        bool tryRecoverConnection();
+
         // --- Configuration Helpers ---
+        // The configured timeout, or the transports' default if none was set.
+        unsigned int sessionTimeout() const;
+
         void applyTimeout();
         void applyReadTermination();
         void applyWriteTermination();
 
-        void checkStatus(ViStatus status, const std::string& functionName);
         void applyConfiguration();
     };
 
@@ -0,0 +1,192 @@
+#include "VisaTransport.hpp"
+
+#include "Exceptions.hpp"
+#include "../utils/utils.hpp"
+
+#include <string>
+#include <visa.h>
+
+namespace cvisa {
+
+    VisaTransport::VisaTransport()
+        : m_resourceManagerHandle(VI_NULL), m_instrumentHandle(VI_NULL), m_logLevel(LogLevel::WARNING), m_readTerminationEnabled(false) {}
+
+    VisaTransport::~VisaTransport() { close(); }
+
+    // --- Session ---
+
+    void VisaTransport::open(const std::string& resourceName) {
+        close();
+        m_resourceName           = resourceName;
+        m_resourceManager        = ResourceManager::acquire();
+        m_resourceManagerHandle  = m_resourceManager->handle();
+        m_readTerminationEnabled = false;
+
+        ViStatus status = viOpen(m_resourceManagerHandle, const_cast<char*>(resourceName.c_str()), VI_NULL, VI_NULL, &m_instrumentHandle);
+        if (status < VI_SUCCESS) {
+            m_instrumentHandle      = VI_NULL;
+            m_resourceManagerHandle = VI_NULL;
+            m_resourceManager.reset();
+            throw ConnectionException("Failed to connect to instrument: " + resourceName);
+        }
+    }
+
+    void VisaTransport::close() {
+        if (m_instrumentHandle != VI_NULL) {
+            // Closing the session also disables its events.
+            viClose(m_instrumentHandle);
+            m_instrumentHandle = VI_NULL;
+        }
+        m_resourceManager.reset();
+        m_resourceManagerHandle = VI_NULL;
+    }
+
+    bool VisaTransport::isOpen() const { return m_instrumentHandle != VI_NULL; }
+
+    // --- Configuration ---
+
+    void VisaTransport::setTimeout(unsigned int timeout_ms) {
+        ViStatus status = viSetAttribute(m_instrumentHandle, VI_ATTR_TMO_VALUE, timeout_ms);
+        checkStatus(status, "viSetAttribute (Timeout)");
+    }
+
+    void VisaTransport::setReadTermination(char termChar, bool enable) {
+        ViStatus status;
+        if (enable) {
+            status = viSetAttribute(m_instrumentHandle, VI_ATTR_TERMCHAR, static_cast<ViInt8>(termChar));
+            checkStatus(status, "viSetAttribute (VI_ATTR_TERMCHAR for Read)");
+        }
+        status = viSetAttribute(m_instrumentHandle, VI_ATTR_TERMCHAR_EN, enable ? VI_TRUE : VI_FALSE);
+        checkStatus(status, "viSetAttribute (VI_ATTR_TERMCHAR_EN for Read)");
+        m_readTerminationEnabled = enable;
+    }
+
+    void VisaTransport::setWriteTermination(char termChar) {
+        ViStatus status;
+        status = viSetAttribute(m_instrumentHandle, VI_ATTR_TERMCHAR, static_cast<ViInt8>(termChar));
+        checkStatus(status, "viSetAttribute (VI_ATTR_TERMCHAR for Write)");
+        status = viSetAttribute(m_instrumentHandle, VI_ATTR_SEND_END_EN, VI_TRUE);
+        checkStatus(status, "viSetAttribute (VI_ATTR_SEND_END_EN for Write)");
+    }
+
+    void VisaTransport::resetConfiguration() {
+        // The VISA defaults: 2 s timeout, '\n' as the termination character, reads end only at END.
+        setTimeout(2000);
+        setWriteTermination('\n');
+        setReadTermination('\n', false);
+    }
+
+    // --- I/O ---
+
+    size_t VisaTransport::write(const char* data, size_t size) {
+        ViUInt32 returnCount = 0;
+        ViStatus status      = viWrite(m_instrumentHandle, reinterpret_cast<unsigned char*>(const_cast<char*>(data)), static_cast<ViUInt32>(size), &returnCount);
+        checkStatus(status, "viWrite");
+        return returnCount;
+    }
+
+    size_t VisaTransport::read(char* buffer, size_t capacity, bool& end) {
+        ViUInt32 returnCount = 0;
+        ViStatus status      = viRead(m_instrumentHandle, reinterpret_cast<unsigned char*>(buffer), static_cast<ViUInt32>(capacity), &returnCount);
+        checkStatus(status, "viRead");
+        end = status != VI_SUCCESS_MAX_CNT;
+        return returnCount;
+    }
+
+    IoStatus VisaTransport::tryWrite(const char* data, size_t size, size_t& written) {
+        ViUInt32 returnCount = 0;
+        ViStatus status      = viWrite(m_instrumentHandle, reinterpret_cast<unsigned char*>(const_cast<char*>(data)), static_cast<ViUInt32>(size), &returnCount);
+        written              = returnCount;
+        return toStatus(status, "viWrite");
+    }
+
+    IoStatus VisaTransport::tryRead(char* buffer, size_t capacity, bool& end, size_t& count) {
+        ViUInt32 returnCount = 0;
+        ViStatus status      = viRead(m_instrumentHandle, reinterpret_cast<unsigned char*>(buffer), static_cast<ViUInt32>(capacity), &returnCount);
+        count                = returnCount;
+        end                  = status != VI_SUCCESS_MAX_CNT;
+        return toStatus(status, "viRead");
+    }
+
+    // --- Instrument Control & Status ---
+
+    void VisaTransport::clear() {
+        ViStatus status = viClear(m_instrumentHandle);
+        checkStatus(status, "viClear");
+    }
+
+    uint8_t VisaTransport::readStatusByte() {
+        ViUInt16 statusByte = 0;
+        ViStatus status     = viReadSTB(m_instrumentHandle, &statusByte);
+        checkStatus(status, "viReadSTB");
+        return static_cast<uint8_t>(statusByte);
+    }
+
+    void VisaTransport::assertTrigger() {
+        ViStatus status = viAssertTrigger(m_instrumentHandle, VI_TRIG_PROT_DEFAULT);
+        checkStatus(status, "viAssertTrigger");
+    }
+
+    // --- Service Requests ---
+
+    void VisaTransport::enableServiceRequest() {
+        ViStatus status = viEnableEvent(m_instrumentHandle, VI_EVENT_SERVICE_REQ, VI_QUEUE, VI_NULL);
+        checkStatus(status, "viEnableEvent (Service Request)");
+    }
+
+    void VisaTransport::disableServiceRequest() {
+        ViStatus status = viDisableEvent(m_instrumentHandle, VI_EVENT_SERVICE_REQ, VI_QUEUE);
+        checkStatus(status, "viDisableEvent (Service Request)");
+        viDiscardEvents(m_instrumentHandle, VI_EVENT_SERVICE_REQ, VI_QUEUE);
+    }
+
+    void VisaTransport::discardServiceRequests() { viDiscardEvents(m_instrumentHandle, VI_EVENT_SERVICE_REQ, VI_QUEUE); }
+
+    bool VisaTransport::waitForServiceRequest(unsigned int timeout_ms) {
+        ViEventType eventType = 0;
+        ViEvent     event     = VI_NULL;
+        ViStatus    status    = viWaitOnEvent(m_instrumentHandle, VI_EVENT_SERVICE_REQ, timeout_ms, &eventType, &event);
+        if (status == VI_ERROR_TMO) {
+            return false;
+        }
+        checkStatus(status, "viWaitOnEvent (Service Request)");
+        viClose(event);
+        return true;
+    }
+
+    // --- Private Helpers ---
+
+    void VisaTransport::checkStatus(ViStatus status, const char* functionName) {
+        if (status < VI_SUCCESS) {
+            std::string errorMessage = describeStatus(functionName, status);
+            CVISA_LOG(m_logLevel, LogLevel::ERROR, m_resourceName, errorMessage);
+            toStatus(status, functionName).throwIfError();
+        }
+    }
+
+    IoStatus VisaTransport::toStatus(ViStatus status, const char* functionName) const {
+        if (status >= VI_SUCCESS) return IoStatus();
+        StatusCode code = StatusCode::VISA;
+        if (status == VI_ERROR_TMO) {
+            code = StatusCode::TIMEOUT;
+        } else if (status == VI_ERROR_RSRC_NFOUND || status == VI_ERROR_RSRC_LOCKED || status == VI_ERROR_CONN_LOST) {
+            code = StatusCode::CONNECTION;
+        } else if (status == VI_ERROR_INV_EXPR || status == VI_ERROR_NLISTENERS) {
+            code = StatusCode::COMMAND;
+        }
+        return IoStatus(code, functionName, status, &VisaTransport::describeStatus);
+    }
+
+    std::string VisaTransport::describeStatus(const char* functionName, long status) {
+        char errorBuffer[256] = {0};
+        try {
+            // The status may be described long after its session closed; the shared resource manager outlives it.
+            std::shared_ptr<ResourceManager> resourceManager = ResourceManager::acquire();
+            viStatusDesc(resourceManager->handle(), static_cast<ViStatus>(status), errorBuffer);
+        } catch (const VisaException&) {
+            // Without a resource manager, the status code alone has to do.
+        }
+        return std::string("VISA Error in ") + functionName + ": " + errorBuffer + " (Status: " + utils::to_string(status) + ")";
+    }
+
+}    // namespace cvisa
@@ -0,0 +1,90 @@
+#ifndef CVISA_VISA_TRANSPORT_HPP
+#define CVISA_VISA_TRANSPORT_HPP
+
+#include "ResourceManager.hpp"
+#include "Transport.hpp"
+
+#include <memory>
+#include <string>
+
+// Forward-declare VISA types to avoid including visa.h in a public header.
+using ViSession = unsigned long;
+using ViStatus  = long;
+
+namespace cvisa {
+
+    /**
+     * @class VisaTransport
+     * @brief A `Transport` on top of the vendor VISA library.
+     *
+     * Opens an instrument session through the shared `ResourceManager` and
+     * maps VISA error codes to the library's exceptions. This is the transport
+     * `VISACom` uses unless another one is installed with `setTransport()`.
+     * Only available if the library is built with VISA support.
+     */
+    class VisaTransport : public Transport {
+      public:
+        VisaTransport();
+
+        /**
+         * @brief Destructor. Closes the session if it is open.
+         */
+        ~VisaTransport();
+
+        VisaTransport(const VisaTransport&)            = delete;
+        VisaTransport& operator=(const VisaTransport&) = delete;
+
+        void open(const std::string& resourceName) override;
+        void close() override;
+        bool isOpen() const override;
+
+        void setTimeout(unsigned int timeout_ms) override;
+        void setReadTermination(char termChar, bool enable) override;
+        bool isReadTerminationEnabled() const override { return m_readTerminationEnabled; }
+        void setWriteTermination(char termChar) override;
+        void resetConfiguration() override;
+        void setLogLevel(LogLevel level) override { m_logLevel = level; }
+
+        size_t write(const char* data, size_t size) override;
+        size_t read(char* buffer, size_t capacity, bool& end) override;
+
+        // Failures are returned as the raw ViStatus; `viStatusDesc` only runs if the description is requested.
+        IoStatus tryWrite(const char* data, size_t size, size_t& written) override;
+        IoStatus tryRead(char* buffer, size_t capacity, bool& end, size_t& count) override;
+
+        void    clear() override;
+        uint8_t readStatusByte() override;
+        void    assertTrigger() override;
+
+        void enableServiceRequest() override;
+        void disableServiceRequest() override;
+        void discardServiceRequests() override;
+        bool waitForServiceRequest(unsigned int timeout_ms) override;
+
+        /**
+         * @brief Returns the raw VISA instrument session, or 0 if not open.
+         *
+         * For vendor-specific attributes the transport does not expose.
+         */
+        ViSession handle() const { return m_instrumentHandle; }
+
+      private:
+        void checkStatus(ViStatus status, const char* functionName);
+        IoStatus toStatus(ViStatus status, const char* functionName) const;
+
+        // Formats a failed ViStatus like `checkStatus()`; an `IoStatus::Describer`.
+        static std::string describeStatus(const char* functionName, long status);
+
+        // The resource manager is shared by all sessions of the process;
+        // `m_resourceManagerHandle` caches its raw handle.
+        std::shared_ptr<ResourceManager> m_resourceManager;
+        ViSession                        m_resourceManagerHandle;
+        ViSession                        m_instrumentHandle;
+        std::string                      m_resourceName;
+        LogLevel                         m_logLevel;
+        bool                             m_readTerminationEnabled;    // VI_ATTR_TERMCHAR_EN, off when a session opens.
+    };
+
+}    // namespace cvisa
+
+#endif    // CVISA_VISA_TRANSPORT_HPP
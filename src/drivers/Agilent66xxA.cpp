@@ -2,12 +2,58 @@
 
 #include "../core/Exceptions.hpp"
 
+#include <chrono>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 namespace cvisa {
     namespace drivers {
 
+        namespace {
+            // Compile-time table of every command defined by the driver.
+            constexpr SCPICommandEntry s_agilent66xxACommands[] = {
+                {"SET_VOLTAGE", Agilent66xxA::Commands::SET_VOLTAGE()},
+                {"GET_VOLTAGE_SET", Agilent66xxA::Commands::GET_VOLTAGE_SET()},
+                {"MEAS_VOLTAGE", Agilent66xxA::Commands::MEAS_VOLTAGE()},
+                {"SET_CURRENT", Agilent66xxA::Commands::SET_CURRENT()},
+                {"GET_CURRENT_SET", Agilent66xxA::Commands::GET_CURRENT_SET()},
+                {"MEAS_CURRENT", Agilent66xxA::Commands::MEAS_CURRENT()},
+                {"SET_OUTPUT", Agilent66xxA::Commands::SET_OUTPUT()},
+                {"GET_OUTPUT_STATE", Agilent66xxA::Commands::GET_OUTPUT_STATE()},
+                {"CLEAR_PROTECTION", Agilent66xxA::Commands::CLEAR_PROTECTION()},
+                {"SET_OVP", Agilent66xxA::Commands::SET_OVP()},
+                {"GET_OVP", Agilent66xxA::Commands::GET_OVP()},
+                {"SET_OCP", Agilent66xxA::Commands::SET_OCP()},
+                {"GET_OCP", Agilent66xxA::Commands::GET_OCP()},
+                {"SET_DISPLAY_ENABLED", Agilent66xxA::Commands::SET_DISPLAY_ENABLED()},
+                {"GET_DISPLAY_ENABLED", Agilent66xxA::Commands::GET_DISPLAY_ENABLED()},
+                {"DISPLAY_TEXT", Agilent66xxA::Commands::DISPLAY_TEXT()},
+                {"GET_DISPLAY_TEXT", Agilent66xxA::Commands::GET_DISPLAY_TEXT()},
+                {"INITIATE", Agilent66xxA::Commands::INITIATE()},
+                {"ABORT", Agilent66xxA::Commands::ABORT()},
+                {"SET_TRIGGER_SOURCE_BUS", Agilent66xxA::Commands::SET_TRIGGER_SOURCE_BUS()},
+                {"TRIGGER", Agilent66xxA::Commands::TRIGGER()},
+                {"SET_TRIGGERED_VOLTAGE", Agilent66xxA::Commands::SET_TRIGGERED_VOLTAGE()},
+                {"GET_TRIGGERED_VOLTAGE", Agilent66xxA::Commands::GET_TRIGGERED_VOLTAGE()},
+                {"SET_TRIGGERED_CURRENT", Agilent66xxA::Commands::SET_TRIGGERED_CURRENT()},
+                {"GET_TRIGGERED_CURRENT", Agilent66xxA::Commands::GET_TRIGGERED_CURRENT()},
+            };
+
+            // Command templates are checked against the argument types the driver passes.
+            static_assert(commandAccepts<double>(Agilent66xxA::Commands::SET_VOLTAGE()), "SET_VOLTAGE does not match its argument type.");
+            static_assert(commandAccepts<double>(Agilent66xxA::Commands::SET_CURRENT()), "SET_CURRENT does not match its argument type.");
+            static_assert(commandAccepts<const char*>(Agilent66xxA::Commands::SET_OUTPUT()), "SET_OUTPUT does not match its argument type.");
+            static_assert(commandAccepts<double>(Agilent66xxA::Commands::SET_OVP()), "SET_OVP does not match its argument type.");
+            static_assert(commandAccepts<const char*>(Agilent66xxA::Commands::SET_OCP()), "SET_OCP does not match its argument type.");
+            static_assert(commandAccepts<const char*>(Agilent66xxA::Commands::SET_DISPLAY_ENABLED()), "SET_DISPLAY_ENABLED does not match its argument type.");
+            static_assert(commandAccepts<const char*>(Agilent66xxA::Commands::DISPLAY_TEXT()), "DISPLAY_TEXT does not match its argument type.");
+            static_assert(commandAccepts<double>(Agilent66xxA::Commands::SET_TRIGGERED_VOLTAGE()), "SET_TRIGGERED_VOLTAGE does not match its argument type.");
+            static_assert(commandAccepts<double>(Agilent66xxA::Commands::SET_TRIGGERED_CURRENT()), "SET_TRIGGERED_CURRENT does not match its argument type.");
+        }    // namespace
+
+        SCPICommandTable Agilent66xxA::Commands::table() { return SCPICommandTable(s_agilent66xxACommands); }
+
         // --- Output Subsystem ---
         void Agilent66xxA::setVoltage(double voltage) { executeCommand(Commands::SET_VOLTAGE(), voltage); }
 
@@ -27,6 +73,27 @@ namespace cvisa {
 
         void Agilent66xxA::clearProtection() { executeCommand(Commands::CLEAR_PROTECTION()); }
 
+        Agilent66xxA::Status Agilent66xxA::getStatus() {
+            std::lock_guard<std::recursive_mutex> lock(m_ioMutex);
+            SCPIBatch&                            batch = m_statusBatch;
+            if (batch.empty()) {
+                batch.add(Commands::GET_VOLTAGE_SET())
+                    .add(Commands::GET_CURRENT_SET())
+                    .add(Commands::MEAS_VOLTAGE())
+                    .add(Commands::MEAS_CURRENT())
+                    .add(Commands::GET_OUTPUT_STATE());
+            }
+            executeBatch(batch);
+
+            Status status;
+            status.voltageSetting = batch.get<double>(0);
+            status.currentSetting = batch.get<double>(1);
+            status.voltage        = batch.get<double>(2);
+            status.current        = batch.get<double>(3);
+            status.outputEnabled  = batch.get<bool>(4);
+            return status;
+        }
+
         // --- Over-Voltage Protection ---
         void Agilent66xxA::setOverVoltageProtection(double level) { executeCommand(Commands::SET_OVP(), level); }
 
@@ -63,5 +130,69 @@ namespace cvisa {
 
         double Agilent66xxA::getTriggeredCurrent() { return queryAndParse<double>(Commands::GET_TRIGGERED_CURRENT()); }
 
+        void Agilent66xxA::runSequence(const std::vector<SequenceStep>& steps, TriggerMethod method) { executeSequence(steps, method, nullptr); }
+
+        size_t Agilent66xxA::runSequence(const std::vector<SequenceStep>& steps, std::vector<SequenceReading>& readings, TriggerMethod method) {
+            readings.clear();
+            readings.reserve(steps.size());
+            executeSequence(steps, method, &readings);
+            return readings.size();
+        }
+
+        void Agilent66xxA::executeSequence(const std::vector<SequenceStep>& steps, TriggerMethod method, std::vector<SequenceReading>* readings) {
+            if (steps.empty()) {
+                return;
+            }
+            SCPIBatch batch = createBatch();
+
+            // Measures the step that is ending; its results are read after execution.
+            auto addMeasurement = [&]() {
+                if (readings != nullptr) {
+                    batch.add(Commands::MEAS_VOLTAGE()).add(Commands::MEAS_CURRENT());
+                }
+            };
+            auto addPreload = [&](const SequenceStep& step) {
+                batch.add(Commands::SET_TRIGGERED_VOLTAGE(), step.voltage).add(Commands::SET_TRIGGERED_CURRENT(), step.current).add(Commands::INITIATE());
+            };
+            auto execute = [&]() {
+                if (!batch.empty()) {
+                    executeBatch(batch);
+                    if (readings != nullptr && batch.queryCount() == 2) {
+                        SequenceReading reading = {batch.get<double>(0), batch.get<double>(1)};
+                        readings->push_back(reading);
+                    }
+                    batch.clear();
+                }
+            };
+
+            batch.add(Commands::SET_TRIGGER_SOURCE_BUS());
+            addPreload(steps[0]);
+            execute();
+
+            std::chrono::steady_clock::time_point stepStart = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < steps.size(); ++i) {
+                if (i > 0) {
+                    std::this_thread::sleep_until(stepStart);
+                    addMeasurement();
+                }
+                if (method == TriggerMethod::GROUP_EXECUTE) {
+                    // The bus trigger is not part of a message: measure before it, pre-load after it.
+                    execute();
+                    assertTrigger();
+                } else {
+                    batch.add(method == TriggerMethod::COMMON_COMMAND ? SCPICommons::TRG() : Commands::TRIGGER());
+                }
+                if (i + 1 < steps.size()) {
+                    addPreload(steps[i + 1]);
+                }
+                execute();
+                stepStart += std::chrono::milliseconds(steps[i].dwell_ms);
+            }
+
+            std::this_thread::sleep_until(stepStart);
+            addMeasurement();
+            execute();
+        }
+
     }    // namespace drivers
 }    // namespace cvisa
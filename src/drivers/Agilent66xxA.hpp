@@ -2,10 +2,12 @@
 #define CVISA_DRIVER_AGILENT_66XXA_HPP
 
 #include "../core/SCPIBase.hpp"
+#include "../core/SCPIBatch.hpp"
 #include "../core/SCPICommand.hpp"
 
 #include <map>
 #include <string>
+#include <vector>
 
 namespace cvisa {
     namespace drivers {
@@ -27,6 +29,43 @@ namespace cvisa {
          */
         class Agilent66xxA : public SCPIBase {
           public:
+            /**
+             * @brief A snapshot of the output's programmed and measured state.
+             */
+            struct Status {
+                double voltageSetting;    // Programmed voltage in Volts.
+                double currentSetting;    // Programmed current in Amperes.
+                double voltage;           // Measured voltage in Volts.
+                double current;           // Measured current in Amperes.
+                bool   outputEnabled;     // True if the output is on.
+            };
+
+            /**
+             * @brief One step of a triggered output sequence.
+             */
+            struct SequenceStep {
+                double       voltage;     // Output voltage in Volts.
+                double       current;     // Output current in Amperes.
+                unsigned int dwell_ms;    // Time until the next step is triggered.
+            };
+
+            /**
+             * @brief The output measured at the end of a sequence step.
+             */
+            struct SequenceReading {
+                double voltage;    // Measured voltage in Volts.
+                double current;    // Measured current in Amperes.
+            };
+
+            /**
+             * @brief How `runSequence()` fires each step.
+             */
+            enum class TriggerMethod {
+                TRIGGER_COMMAND,    // "TRIGGER:IMMEDIATE" in the step's message.
+                COMMON_COMMAND,     // "*TRG" in the step's message.
+                GROUP_EXECUTE       // A bus trigger (GPIB GET) with `assertTrigger()`.
+            };
+
             /**
              * @brief Default constructor. Creates a disconnected driver.
              */
@@ -99,6 +138,17 @@ namespace cvisa {
              */
             void clearProtection();
 
+            /**
+             * @brief Reads the settings, measurements and output state in one round trip.
+             *
+             * Sends all five queries as a single compound message instead of one
+             * message per value. The message is built once and its buffers are
+             * reused, so polling the status does not allocate.
+             *
+             * @return The output status.
+             */
+            Status getStatus();
+
             // --- Over-Voltage Protection ---
             /**
              * @brief Sets the overvoltage protection (OVP) level.
@@ -195,69 +245,127 @@ namespace cvisa {
              */
             double getTriggeredCurrent();
 
+            /**
+             * @brief Steps the output through a voltage/current profile with bus triggers.
+             *
+             * The first step's levels are loaded as triggered levels before the
+             * sequence starts. Each step is then fired by a trigger, and the next
+             * step's triggered levels are pre-loaded and the trigger system is
+             * re-armed (`INIT`) while the current step dwells. The trigger and the
+             * pre-load travel in one compound message, so a step costs one bus
+             * message instead of a voltage and a current write, and the output
+             * changes when the trigger is parsed rather than between two writes.
+             * Steps are scheduled from the start of the sequence, so host delays
+             * do not accumulate.
+             *
+             * Selects the bus trigger source. Blocks for the sum of the dwell
+             * times; the session lock is only held while messages are exchanged.
+             *
+             * @param steps The steps to run, in order.
+             * @param method How to fire the triggers.
+             * @throws VisaException if a command fails.
+             */
+            void runSequence(const std::vector<SequenceStep>& steps, TriggerMethod method = TriggerMethod::TRIGGER_COMMAND);
+
+            /**
+             * @brief Runs a sequence and measures the output at the end of each step.
+             *
+             * The measurement of a step is sent in the same message as the trigger
+             * of the next step, ahead of it, so measuring adds no bus messages
+             * with the `TRIGGER_COMMAND` and `COMMON_COMMAND` methods. Steps that
+             * dwell for less than the measurement time are stretched.
+             *
+             * @param steps The steps to run, in order.
+             * @param readings Receives one reading per step. Cleared first.
+             * @param method How to fire the triggers.
+             * @return The number of readings.
+             * @throws VisaException if a command fails.
+             */
+            size_t runSequence(const std::vector<SequenceStep>& steps, std::vector<SequenceReading>& readings,
+                               TriggerMethod method = TriggerMethod::TRIGGER_COMMAND);
+
             // --- Command Definitions ---
             struct Commands {
                 // --- Output Commands ---
-                static SCPICommand SET_VOLTAGE() {
-                    return SCPICommand("SOURCE:VOLTAGE:LEVEL:IMMEDIATE:AMPLITUDE %f", CommandType::WRITE, ResponseType::NONE, 0, "Set output voltage.");
+                static constexpr SCPICommand SET_VOLTAGE() {
+                    return SCPICommand("SOURCE:VOLTAGE:LEVEL:IMMEDIATE:AMPLITUDE %f", CommandType::WRITE, ResponseType::NONE, 0, "Set output voltage.").asCachedSetting();
                 }
-                static SCPICommand GET_VOLTAGE_SET() {
-                    return SCPICommand("SOURCE:VOLTAGE:LEVEL:IMMEDIATE:AMPLITUDE?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get output voltage setting.");
+                static constexpr SCPICommand GET_VOLTAGE_SET() {
+                    return SCPICommand("SOURCE:VOLTAGE:LEVEL:IMMEDIATE:AMPLITUDE?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get output voltage setting.")
+                        .asCachedSetting();
                 }
-                static SCPICommand MEAS_VOLTAGE() { return SCPICommand("MEASURE:VOLTAGE:DC?", CommandType::QUERY, ResponseType::DOUBLE, 50, "Measure voltage."); }
-                static SCPICommand SET_CURRENT() {
-                    return SCPICommand("SOURCE:CURRENT:LEVEL:IMMEDIATE:AMPLITUDE %f", CommandType::WRITE, ResponseType::NONE, 0, "Set output current.");
+                static constexpr SCPICommand MEAS_VOLTAGE() { return SCPICommand("MEASURE:VOLTAGE:DC?", CommandType::QUERY, ResponseType::DOUBLE, 50, "Measure voltage."); }
+                static constexpr SCPICommand SET_CURRENT() {
+                    return SCPICommand("SOURCE:CURRENT:LEVEL:IMMEDIATE:AMPLITUDE %f", CommandType::WRITE, ResponseType::NONE, 0, "Set output current.").asCachedSetting();
                 }
-                static SCPICommand GET_CURRENT_SET() {
-                    return SCPICommand("SOURCE:CURRENT:LEVEL:IMMEDIATE:AMPLITUDE?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get output current setting.");
+                static constexpr SCPICommand GET_CURRENT_SET() {
+                    return SCPICommand("SOURCE:CURRENT:LEVEL:IMMEDIATE:AMPLITUDE?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get output current setting.")
+                        .asCachedSetting();
                 }
-                static SCPICommand MEAS_CURRENT() { return SCPICommand("MEASURE:CURRENT:DC?", CommandType::QUERY, ResponseType::DOUBLE, 50, "Measure current."); }
-                static SCPICommand SET_OUTPUT() { return SCPICommand("OUTPUT:STATE %s", CommandType::WRITE, ResponseType::NONE, 0, "Set output state."); }
-                static SCPICommand GET_OUTPUT_STATE() { return SCPICommand("OUTPUT:STATE?", CommandType::QUERY, ResponseType::BOOLEAN, 0, "Get output state."); }
-                static SCPICommand CLEAR_PROTECTION() {
+                static constexpr SCPICommand MEAS_CURRENT() { return SCPICommand("MEASURE:CURRENT:DC?", CommandType::QUERY, ResponseType::DOUBLE, 50, "Measure current."); }
+                static constexpr SCPICommand SET_OUTPUT() { return SCPICommand("OUTPUT:STATE %s", CommandType::WRITE, ResponseType::NONE, 0, "Set output state."); }
+                static constexpr SCPICommand GET_OUTPUT_STATE() { return SCPICommand("OUTPUT:STATE?", CommandType::QUERY, ResponseType::BOOLEAN, 0, "Get output state."); }
+                static constexpr SCPICommand CLEAR_PROTECTION() {
                     return SCPICommand("OUTPUT:PROTECTION:CLEAR", CommandType::WRITE, ResponseType::NONE, 0, "Clear tripped protection.");
                 }
 
                 // --- Over-Voltage Protection ---
-                static SCPICommand SET_OVP() { return SCPICommand("SOURCE:VOLTAGE:PROTECTION:LEVEL %f", CommandType::WRITE, ResponseType::NONE, 0, "Set OVP level."); }
-                static SCPICommand GET_OVP() { return SCPICommand("SOURCE:VOLTAGE:PROTECTION:LEVEL?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get OVP level."); }
+                static constexpr SCPICommand SET_OVP() {
+                    return SCPICommand("SOURCE:VOLTAGE:PROTECTION:LEVEL %f", CommandType::WRITE, ResponseType::NONE, 0, "Set OVP level.").asCachedSetting();
+                }
+                static constexpr SCPICommand GET_OVP() {
+                    return SCPICommand("SOURCE:VOLTAGE:PROTECTION:LEVEL?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get OVP level.").asCachedSetting();
+                }
 
                 // --- Over-Current Protection ---
-                static SCPICommand SET_OCP() { return SCPICommand("SOURCE:CURRENT:PROTECTION:STATE %s", CommandType::WRITE, ResponseType::NONE, 0, "Set OCP state."); }
-                static SCPICommand GET_OCP() { return SCPICommand("SOURCE:CURRENT:PROTECTION:STATE?", CommandType::QUERY, ResponseType::BOOLEAN, 0, "Get OCP state."); }
+                static constexpr SCPICommand SET_OCP() { return SCPICommand("SOURCE:CURRENT:PROTECTION:STATE %s", CommandType::WRITE, ResponseType::NONE, 0, "Set OCP state."); }
+                static constexpr SCPICommand GET_OCP() { return SCPICommand("SOURCE:CURRENT:PROTECTION:STATE?", CommandType::QUERY, ResponseType::BOOLEAN, 0, "Get OCP state."); }
 
                 // --- Display Commands ---
-                static SCPICommand SET_DISPLAY_ENABLED() {
+                static constexpr SCPICommand SET_DISPLAY_ENABLED() {
                     return SCPICommand("DISPLAY:WINDOW:STATE %s", CommandType::WRITE, ResponseType::NONE, 0, "Set display state.");
                 }
-                static SCPICommand GET_DISPLAY_ENABLED() {
+                static constexpr SCPICommand GET_DISPLAY_ENABLED() {
                     return SCPICommand("DISPLAY:WINDOW:STATE?", CommandType::QUERY, ResponseType::BOOLEAN, 0, "Get display state.");
                 }
-                static SCPICommand DISPLAY_TEXT() { return SCPICommand("DISPLAY:WINDOW:TEXT:DATA \"%s\"", CommandType::WRITE, ResponseType::NONE, 0, "Display text."); }
-                static SCPICommand GET_DISPLAY_TEXT() {
+                static constexpr SCPICommand DISPLAY_TEXT() { return SCPICommand("DISPLAY:WINDOW:TEXT:DATA \"%s\"", CommandType::WRITE, ResponseType::NONE, 0, "Display text."); }
+                static constexpr SCPICommand GET_DISPLAY_TEXT() {
                     return SCPICommand("DISPLAY:WINDOW:TEXT:DATA?", CommandType::QUERY, ResponseType::STRING, 0, "Get displayed text.");
                 }
 
                 // --- Trigger Commands ---
-                static SCPICommand INITIATE() { return SCPICommand("INITIATE:IMMEDIATE", CommandType::WRITE, ResponseType::NONE, 0, "Initiate trigger system."); }
-                static SCPICommand ABORT() { return SCPICommand("ABORT", CommandType::WRITE, ResponseType::NONE, 0, "Abort trigger action."); }
-                static SCPICommand SET_TRIGGER_SOURCE_BUS() {
+                static constexpr SCPICommand INITIATE() { return SCPICommand("INITIATE:IMMEDIATE", CommandType::WRITE, ResponseType::NONE, 0, "Initiate trigger system."); }
+                static constexpr SCPICommand ABORT() { return SCPICommand("ABORT", CommandType::WRITE, ResponseType::NONE, 0, "Abort trigger action."); }
+                static constexpr SCPICommand SET_TRIGGER_SOURCE_BUS() {
                     return SCPICommand("TRIGGER:SOURCE BUS", CommandType::WRITE, ResponseType::NONE, 0, "Set trigger source to bus.");
                 }
-                static SCPICommand TRIGGER() { return SCPICommand("TRIGGER:IMMEDIATE", CommandType::WRITE, ResponseType::NONE, 0, "Generate a trigger."); }
-                static SCPICommand SET_TRIGGERED_VOLTAGE() {
-                    return SCPICommand("SOURCE:VOLTAGE:LEVEL:TRIGGERED:AMPLITUDE %f", CommandType::WRITE, ResponseType::NONE, 0, "Set triggered voltage level.");
+                static constexpr SCPICommand TRIGGER() { return SCPICommand("TRIGGER:IMMEDIATE", CommandType::WRITE, ResponseType::NONE, 0, "Generate a trigger."); }
+                static constexpr SCPICommand SET_TRIGGERED_VOLTAGE() {
+                    return SCPICommand("SOURCE:VOLTAGE:LEVEL:TRIGGERED:AMPLITUDE %f", CommandType::WRITE, ResponseType::NONE, 0, "Set triggered voltage level.")
+                        .asCachedSetting();
                 }
-                static SCPICommand GET_TRIGGERED_VOLTAGE() {
-                    return SCPICommand("SOURCE:VOLTAGE:LEVEL:TRIGGERED:AMPLITUDE?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get triggered voltage level.");
+                static constexpr SCPICommand GET_TRIGGERED_VOLTAGE() {
+                    return SCPICommand("SOURCE:VOLTAGE:LEVEL:TRIGGERED:AMPLITUDE?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get triggered voltage level.")
+                        .asCachedSetting();
                 }
-                static SCPICommand SET_TRIGGERED_CURRENT() {
-                    return SCPICommand("SOURCE:CURRENT:LEVEL:TRIGGERED:AMPLITUDE %f", CommandType::WRITE, ResponseType::NONE, 0, "Set triggered current level.");
+                static constexpr SCPICommand SET_TRIGGERED_CURRENT() {
+                    return SCPICommand("SOURCE:CURRENT:LEVEL:TRIGGERED:AMPLITUDE %f", CommandType::WRITE, ResponseType::NONE, 0, "Set triggered current level.")
+                        .asCachedSetting();
                 }
-                static SCPICommand GET_TRIGGERED_CURRENT() {
-                    return SCPICommand("SOURCE:CURRENT:LEVEL:TRIGGERED:AMPLITUDE?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get triggered current level.");
+                static constexpr SCPICommand GET_TRIGGERED_CURRENT() {
+                    return SCPICommand("SOURCE:CURRENT:LEVEL:TRIGGERED:AMPLITUDE?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get triggered current level.")
+                        .asCachedSetting();
                 }
+
+                // --- Introspection ---
+                static SCPICommandTable table();
             };
+
+          private:
+            // Runs `steps`, measuring into `readings` unless it is null.
+            void executeSequence(const std::vector<SequenceStep>& steps, TriggerMethod method, std::vector<SequenceReading>* readings);
+
+            SCPIBatch m_statusBatch;    // The queries of `getStatus()`, built on first use.
         };
 
         // --- Specialized Driver Aliases ---
@@ -0,0 +1,88 @@
+#include "DriverRegistry.hpp"
+
+#include "Agilent66xxA.hpp"
+#include "ThermalAirTA5000.hpp"
+#include "../core/ResponseParser.hpp"
+#include "../utils/utils.hpp"
+
+#include <cstring>
+
+namespace cvisa {
+    namespace drivers {
+
+        namespace {
+            // The built-in drivers. HP, Agilent and Keysight sold the 66xxA series under their own names.
+            constexpr DriverEntry s_builtInDrivers[] = {
+                {"HEWLETT-PACKARD", "66", &makeDriver<Agilent66xxA>},
+                {"Agilent Technologies", "66", &makeDriver<Agilent66xxA>},
+                {"Keysight Technologies", "66", &makeDriver<Agilent66xxA>},
+                {"MPI Thermal", "TA", &makeDriver<ThermalAirTA5000>},
+                {"inTEST Thermal Solutions", "TA", &makeDriver<ThermalAirTA5000>},
+            };
+
+            // True if [begin, end) equals `text`, ignoring case.
+            bool equalsIgnoringCase(const char* begin, const char* end, const char* text) {
+                size_t length = std::strlen(text);
+                if (static_cast<size_t>(end - begin) != length) return false;
+                for (size_t i = 0; i < length; ++i) {
+                    if (utils::toUpper(begin[i]) != utils::toUpper(text[i])) return false;
+                }
+                return true;
+            }
+
+            // True if [begin, end) starts with `prefix`, ignoring case.
+            bool startsWithIgnoringCase(const char* begin, const char* end, const char* prefix) {
+                size_t length = std::strlen(prefix);
+                return static_cast<size_t>(end - begin) >= length && equalsIgnoringCase(begin, begin + length, prefix);
+            }
+
+            // Finds the trimmed field that starts at `begin` and ends at the next ',' or `end`.
+            const char* nextField(const char* begin, const char* end, const char*& fieldBegin, const char*& fieldEnd) {
+                const char* comma = static_cast<const char*>(std::memchr(begin, ',', static_cast<size_t>(end - begin)));
+                fieldBegin        = begin;
+                fieldEnd          = comma != nullptr ? comma : end;
+                ResponseParser::trim(fieldBegin, fieldEnd);
+                return comma != nullptr ? comma + 1 : end;
+            }
+        }    // namespace
+
+        const DriverEntry* DriverRegistry::find(const std::string& identification, const DriverEntry* table, size_t count) {
+            const char* manufacturerBegin;
+            const char* manufacturerEnd;
+            const char* modelBegin;
+            const char* modelEnd;
+            const char* end  = identification.data() + identification.size();
+            const char* rest = nextField(identification.data(), end, manufacturerBegin, manufacturerEnd);
+            nextField(rest, end, modelBegin, modelEnd);
+
+            for (size_t i = 0; i < count; ++i) {
+                if (equalsIgnoringCase(manufacturerBegin, manufacturerEnd, table[i].manufacturer) && startsWithIgnoringCase(modelBegin, modelEnd, table[i].modelPrefix)) {
+                    return &table[i];
+                }
+            }
+            return nullptr;
+        }
+
+        const DriverEntry* DriverRegistry::find(const std::string& identification) { return find(identification, s_builtInDrivers, size()); }
+
+        std::unique_ptr<SCPIBase> DriverRegistry::create(const std::string& identification) { return create(identification, s_builtInDrivers); }
+
+        std::unique_ptr<SCPIBase> DriverRegistry::open(const std::string& resourceName) {
+            std::string identification;
+            {
+                SCPIBase probe;
+                probe.connect(resourceName);
+                identification = probe.IDN_Query();
+            }
+            std::unique_ptr<SCPIBase> driver = create(identification);
+            if (!driver) driver.reset(new SCPIBase());
+            driver->connect(resourceName);
+            return driver;
+        }
+
+        const DriverEntry* DriverRegistry::entries() { return s_builtInDrivers; }
+
+        size_t DriverRegistry::size() { return sizeof(s_builtInDrivers) / sizeof(s_builtInDrivers[0]); }
+
+    }    // namespace drivers
+}    // namespace cvisa
@@ -0,0 +1,116 @@
+#ifndef CVISA_DRIVER_REGISTRY_HPP
+#define CVISA_DRIVER_REGISTRY_HPP
+
+#include "../core/SCPIBase.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace cvisa {
+    namespace drivers {
+
+        /**
+         * @brief One entry of a driver table: the instruments a driver handles and how to create it.
+         */
+        struct DriverEntry {
+            const char* manufacturer;                 // The first `*IDN?` field, compared case-insensitively.
+            const char* modelPrefix;                  // The start of the second field; "" matches every model.
+            std::unique_ptr<SCPIBase> (*create)();    // Creates a disconnected driver.
+        };
+
+        /**
+         * @brief Creates a disconnected `Driver`; the factory of a `DriverEntry`.
+         */
+        template <typename Driver>
+        std::unique_ptr<SCPIBase> makeDriver() {
+            return std::unique_ptr<SCPIBase>(new Driver());
+        }
+
+        /**
+         * @class DriverRegistry
+         * @brief Picks the driver for an instrument from its `*IDN?` response.
+         *
+         * The built-in drivers are listed in a `constexpr` table, so choosing a
+         * driver is a scan of a few static entries instead of string matching in
+         * every application. The first entry whose manufacturer and model prefix
+         * match wins, so more specific entries come first.
+         *
+         * @code
+         * cvisa::InstrumentDiscovery discovery;
+         * for (const auto& instrument : discovery.discover()) {
+         *     std::unique_ptr<cvisa::drivers::SCPIBase> driver = cvisa::drivers::DriverRegistry::create(instrument.first);
+         *     if (driver) driver->connect(instrument.second);
+         * }
+         * @endcode
+         *
+         * Applications with their own drivers pass their own table, which may
+         * list the built-in ones as well:
+         *
+         * @code
+         * constexpr cvisa::drivers::DriverEntry s_rack[] = {
+         *     {"ACME", "DL", &cvisa::drivers::makeDriver<AcmeLoad>},
+         *     {"Keysight Technologies", "66", &cvisa::drivers::makeDriver<cvisa::drivers::Agilent66xxA>},
+         * };
+         * auto driver = cvisa::drivers::DriverRegistry::create(identification, s_rack);
+         * @endcode
+         */
+        class DriverRegistry {
+          public:
+            /**
+             * @brief Finds the entry for an identification in `table`.
+             *
+             * @param identification The `*IDN?` response ("manufacturer,model,serial,firmware").
+             * @param table The entries to search.
+             * @param count The number of entries.
+             * @return The first matching entry, or null.
+             */
+            static const DriverEntry* find(const std::string& identification, const DriverEntry* table, size_t count);
+
+            /**
+             * @brief Finds the entry for an identification among the built-in drivers.
+             */
+            static const DriverEntry* find(const std::string& identification);
+
+            /**
+             * @brief Creates the driver for an identification from `table`.
+             * @return A disconnected driver, or null if no entry matches.
+             */
+            template <size_t N>
+            static std::unique_ptr<SCPIBase> create(const std::string& identification, const DriverEntry (&table)[N]) {
+                const DriverEntry* entry = find(identification, table, N);
+                return entry != nullptr ? entry->create() : std::unique_ptr<SCPIBase>();
+            }
+
+            /**
+             * @brief Creates the built-in driver for an identification.
+             * @return A disconnected driver, or null if no built-in driver matches.
+             */
+            static std::unique_ptr<SCPIBase> create(const std::string& identification);
+
+            /**
+             * @brief Identifies the instrument at `resourceName` and connects the matching built-in driver.
+             *
+             * Opens the resource once for `*IDN?` and once for the driver; with
+             * `VISACom::setSessionPoolSize()`, the second open reuses the session.
+             * An instrument without a built-in driver gets a plain `SCPIBase`,
+             * which still offers the IEEE 488.2 common commands.
+             *
+             * @param resourceName The VISA resource string.
+             * @return A connected driver.
+             * @throws ConnectionException if the resource cannot be opened.
+             * @throws TimeoutException if the instrument does not answer `*IDN?`.
+             */
+            static std::unique_ptr<SCPIBase> open(const std::string& resourceName);
+
+            /// @return The built-in driver table.
+            static const DriverEntry* entries();
+
+            /// @return The number of entries of the built-in table.
+            static size_t size();
+        };
+
+    }    // namespace drivers
+}    // namespace cvisa
+
+#endif    // CVISA_DRIVER_REGISTRY_HPP
@@ -8,6 +8,25 @@
 namespace cvisa {
     namespace drivers {
 
+        namespace {
+            // Compile-time table of every command defined by the driver.
+            constexpr SCPICommandEntry s_powerSupplyCommands[] = {
+                {"SET_VOLTAGE", PowerSupply::Commands::SET_VOLTAGE()},
+                {"GET_VOLTAGE", PowerSupply::Commands::GET_VOLTAGE()},
+                {"SET_CURRENT", PowerSupply::Commands::SET_CURRENT()},
+                {"GET_CURRENT", PowerSupply::Commands::GET_CURRENT()},
+                {"SET_OUTPUT", PowerSupply::Commands::SET_OUTPUT()},
+                {"GET_OUTPUT", PowerSupply::Commands::GET_OUTPUT()},
+            };
+
+            // Command templates are checked against the argument types the driver passes.
+            static_assert(commandAccepts<double>(PowerSupply::Commands::SET_VOLTAGE()), "SET_VOLTAGE does not match its argument type.");
+            static_assert(commandAccepts<double>(PowerSupply::Commands::SET_CURRENT()), "SET_CURRENT does not match its argument type.");
+            static_assert(commandAccepts<int>(PowerSupply::Commands::SET_OUTPUT()), "SET_OUTPUT does not match its argument type.");
+        }    // namespace
+
+        SCPICommandTable PowerSupply::Commands::table() { return SCPICommandTable(s_powerSupplyCommands); }
+
         // --- High-Level Methods ---
         // All methods now use the static command definition methods.
 
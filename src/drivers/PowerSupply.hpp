@@ -76,12 +76,23 @@ namespace cvisa {
 
             // --- Command Definitions ---
             struct Commands {
-                static SCPICommand SET_VOLTAGE() { return SCPICommand("VOLT %f", CommandType::WRITE, ResponseType::NONE, 0, "Set output voltage."); }
-                static SCPICommand GET_VOLTAGE() { return SCPICommand("VOLT?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get output voltage."); }
-                static SCPICommand SET_CURRENT() { return SCPICommand("CURR %f", CommandType::WRITE, ResponseType::NONE, 0, "Set output current."); }
-                static SCPICommand GET_CURRENT() { return SCPICommand("CURR?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get output current."); }
-                static SCPICommand SET_OUTPUT() { return SCPICommand("OUTP %d", CommandType::WRITE, ResponseType::NONE, 0, "Set output state."); }
-                static SCPICommand GET_OUTPUT() { return SCPICommand("OUTP?", CommandType::QUERY, ResponseType::BOOLEAN, 0, "Get output state."); }
+                static constexpr SCPICommand SET_VOLTAGE() {
+                    return SCPICommand("VOLT %f", CommandType::WRITE, ResponseType::NONE, 0, "Set output voltage.").asCachedSetting();
+                }
+                static constexpr SCPICommand GET_VOLTAGE() {
+                    return SCPICommand("VOLT?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get output voltage.").asCachedSetting();
+                }
+                static constexpr SCPICommand SET_CURRENT() {
+                    return SCPICommand("CURR %f", CommandType::WRITE, ResponseType::NONE, 0, "Set output current.").asCachedSetting();
+                }
+                static constexpr SCPICommand GET_CURRENT() {
+                    return SCPICommand("CURR?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get output current.").asCachedSetting();
+                }
+                static constexpr SCPICommand SET_OUTPUT() { return SCPICommand("OUTP %d", CommandType::WRITE, ResponseType::NONE, 0, "Set output state."); }
+                static constexpr SCPICommand GET_OUTPUT() { return SCPICommand("OUTP?", CommandType::QUERY, ResponseType::BOOLEAN, 0, "Get output state."); }
+
+                // --- Introspection ---
+                static SCPICommandTable table();
             };
         };
 
@@ -1,8 +1,98 @@
 #include "ThermalAirTA5000.hpp"
 
+#include "../core/Exceptions.hpp"
+#include "../utils/utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
 namespace cvisa {
     namespace drivers {
 
+        namespace {
+            // Poll interval inside the window, and the longest poll interval during a ramp.
+            const long long s_soakPollInterval_ms    = 250;
+            const long long s_maxRampPollInterval_ms = 10000;
+
+            // Compile-time table of every command defined by the driver.
+            constexpr SCPICommandEntry s_thermalAirCommands[] = {
+                {"getTemperature", ThermalAirTA5000::Commands::getTemperature()},
+                {"getAirTemperature", ThermalAirTA5000::Commands::getAirTemperature()},
+                {"getDutTemperature", ThermalAirTA5000::Commands::getDutTemperature()},
+                {"setSetpoint", ThermalAirTA5000::Commands::setSetpoint()},
+                {"getSetpoint", ThermalAirTA5000::Commands::getSetpoint()},
+                {"setSoakTime", ThermalAirTA5000::Commands::setSoakTime()},
+                {"getSoakTime", ThermalAirTA5000::Commands::getSoakTime()},
+                {"setTemperatureWindow", ThermalAirTA5000::Commands::setTemperatureWindow()},
+                {"getTemperatureWindow", ThermalAirTA5000::Commands::getTemperatureWindow()},
+                {"setHeadDown", ThermalAirTA5000::Commands::setHeadDown()},
+                {"setHeadUp", ThermalAirTA5000::Commands::setHeadUp()},
+                {"getHeadState", ThermalAirTA5000::Commands::getHeadState()},
+                {"setFlowOn", ThermalAirTA5000::Commands::setFlowOn()},
+                {"setFlowOff", ThermalAirTA5000::Commands::setFlowOff()},
+                {"setFlowRate", ThermalAirTA5000::Commands::setFlowRate()},
+                {"getFlowRateSetting", ThermalAirTA5000::Commands::getFlowRateSetting()},
+                {"getFlowRateMeasured", ThermalAirTA5000::Commands::getFlowRateMeasured()},
+                {"getFlowRateLitersPerMin", ThermalAirTA5000::Commands::getFlowRateLitersPerMin()},
+                {"setDutControlModeOn", ThermalAirTA5000::Commands::setDutControlModeOn()},
+                {"setDutControlModeOff", ThermalAirTA5000::Commands::setDutControlModeOff()},
+                {"getDutControlMode", ThermalAirTA5000::Commands::getDutControlMode()},
+                {"setDutSensorType", ThermalAirTA5000::Commands::setDutSensorType()},
+                {"getDutSensorType", ThermalAirTA5000::Commands::getDutSensorType()},
+                {"setTrickleFlowOn", ThermalAirTA5000::Commands::setTrickleFlowOn()},
+                {"setTrickleFlowOff", ThermalAirTA5000::Commands::setTrickleFlowOff()},
+                {"getTrickleFlowState", ThermalAirTA5000::Commands::getTrickleFlowState()},
+                {"setLowerTemperatureLimit", ThermalAirTA5000::Commands::setLowerTemperatureLimit()},
+                {"getLowerTemperatureLimit", ThermalAirTA5000::Commands::getLowerTemperatureLimit()},
+                {"setUpperTemperatureLimit", ThermalAirTA5000::Commands::setUpperTemperatureLimit()},
+                {"getUpperTemperatureLimit", ThermalAirTA5000::Commands::getUpperTemperatureLimit()},
+                {"getErrorState", ThermalAirTA5000::Commands::getErrorState()},
+                {"setAirToDutMaxDifference", ThermalAirTA5000::Commands::setAirToDutMaxDifference()},
+                {"getAirToDutMaxDifference", ThermalAirTA5000::Commands::getAirToDutMaxDifference()},
+                {"getAuxiliaryCondition", ThermalAirTA5000::Commands::getAuxiliaryCondition()},
+                {"setCompressorOn", ThermalAirTA5000::Commands::setCompressorOn()},
+                {"setCompressorOff", ThermalAirTA5000::Commands::setCompressorOff()},
+                {"getCompressorState", ThermalAirTA5000::Commands::getCompressorState()},
+                {"setCycleCount", ThermalAirTA5000::Commands::setCycleCount()},
+                {"getCycleCount", ThermalAirTA5000::Commands::getCycleCount()},
+                {"startCycling", ThermalAirTA5000::Commands::startCycling()},
+                {"stopCycling", ThermalAirTA5000::Commands::stopCycling()},
+                {"getCyclingState", ThermalAirTA5000::Commands::getCyclingState()},
+                {"setDutAutoTuneMode", ThermalAirTA5000::Commands::setDutAutoTuneMode()},
+                {"getDutAutoTuneMode", ThermalAirTA5000::Commands::getDutAutoTuneMode()},
+                {"lockHead", ThermalAirTA5000::Commands::lockHead()},
+                {"unlockHead", ThermalAirTA5000::Commands::unlockHead()},
+                {"nextSetpoint", ThermalAirTA5000::Commands::nextSetpoint()},
+                {"setRampRate", ThermalAirTA5000::Commands::setRampRate()},
+                {"getRampRate", ThermalAirTA5000::Commands::getRampRate()},
+                {"getDynamicSetpoint", ThermalAirTA5000::Commands::getDynamicSetpoint()},
+                {"selectSetpoint", ThermalAirTA5000::Commands::selectSetpoint()},
+                {"getSelectedSetpoint", ThermalAirTA5000::Commands::getSelectedSetpoint()},
+                {"getTemperatureEventCondition", ThermalAirTA5000::Commands::getTemperatureEventCondition()},
+                {"setMaxTestTime", ThermalAirTA5000::Commands::setMaxTestTime()},
+                {"getMaxTestTime", ThermalAirTA5000::Commands::getMaxTestTime()},
+            };
+
+            // Command templates are checked against the argument types the driver passes.
+            static_assert(commandAccepts<double>(ThermalAirTA5000::Commands::setSetpoint()), "setSetpoint does not match its argument type.");
+            static_assert(commandAccepts<int>(ThermalAirTA5000::Commands::setSoakTime()), "setSoakTime does not match its argument type.");
+            static_assert(commandAccepts<double>(ThermalAirTA5000::Commands::setTemperatureWindow()), "setTemperatureWindow does not match its argument type.");
+            static_assert(commandAccepts<int>(ThermalAirTA5000::Commands::setFlowRate()), "setFlowRate does not match its argument type.");
+            static_assert(commandAccepts<int>(ThermalAirTA5000::Commands::setDutSensorType()), "setDutSensorType does not match its argument type.");
+            static_assert(commandAccepts<double>(ThermalAirTA5000::Commands::setLowerTemperatureLimit()), "setLowerTemperatureLimit does not match its argument type.");
+            static_assert(commandAccepts<int>(ThermalAirTA5000::Commands::setUpperTemperatureLimit()), "setUpperTemperatureLimit does not match its argument type.");
+            static_assert(commandAccepts<int>(ThermalAirTA5000::Commands::setAirToDutMaxDifference()), "setAirToDutMaxDifference does not match its argument type.");
+            static_assert(commandAccepts<int>(ThermalAirTA5000::Commands::setCycleCount()), "setCycleCount does not match its argument type.");
+            static_assert(commandAccepts<int>(ThermalAirTA5000::Commands::setDutAutoTuneMode()), "setDutAutoTuneMode does not match its argument type.");
+            static_assert(commandAccepts<double>(ThermalAirTA5000::Commands::setRampRate()), "setRampRate does not match its argument type.");
+            static_assert(commandAccepts<int>(ThermalAirTA5000::Commands::selectSetpoint()), "selectSetpoint does not match its argument type.");
+            static_assert(commandAccepts<int>(ThermalAirTA5000::Commands::setMaxTestTime()), "setMaxTestTime does not match its argument type.");
+        }    // namespace
+
+        SCPICommandTable ThermalAirTA5000::Commands::table() { return SCPICommandTable(s_thermalAirCommands); }
+
         double ThermalAirTA5000::getTemperature() { return queryAndParse<double>(Commands::getTemperature()); }
 
         double ThermalAirTA5000::getAirTemperature() { return queryAndParse<double>(Commands::getAirTemperature()); }
@@ -113,5 +203,110 @@ namespace cvisa {
 
         int ThermalAirTA5000::getMaxTestTime() { return queryAndParse<int>(Commands::getMaxTestTime()); }
 
+        // --- Soak Detection ---
+
+        ThermalAirTA5000::~ThermalAirTA5000() {
+            std::unique_lock<std::mutex> lock(m_soakMutex);
+            ++m_soakCancels;
+            m_soakWakeup.notify_all();
+            m_soakWakeup.wait(lock, [this]() { return m_activeSoaks == 0; });
+        }
+
+        void ThermalAirTA5000::cancelSoak() {
+            std::lock_guard<std::mutex> lock(m_soakMutex);
+            ++m_soakCancels;
+            m_soakWakeup.notify_all();
+        }
+
+        std::future<double> ThermalAirTA5000::waitForSoak(double setpoint, double window, unsigned int soakTime_ms, unsigned int timeout_ms) {
+            if (!(window > 0.0)) {
+                throw std::invalid_argument("waitForSoak requires a positive temperature window.");
+            }
+            // Read once up front, so a ramp-rate query failure surfaces immediately. RAMP? is not
+            // a cached setting, so this reads the rate of the selected setpoint from the instrument.
+            double rampRate = std::fabs(getRampRate()) / 60000.0;    // degrees Celsius per ms
+
+            unsigned int cancels;
+            {
+                std::lock_guard<std::mutex> lock(m_soakMutex);
+                cancels = m_soakCancels;
+                ++m_activeSoaks;    // Counted before the task starts, so the destructor waits for it.
+            }
+            // Releases the wait's claim on the driver when the task returns. Notifies under
+            // the lock, so the destructor cannot proceed before the task lets go of it.
+            struct ActiveSoak {
+                ThermalAirTA5000* driver;
+                ~ActiveSoak() {
+                    std::lock_guard<std::mutex> lock(driver->m_soakMutex);
+                    --driver->m_activeSoaks;
+                    driver->m_soakWakeup.notify_all();
+                }
+            };
+            try {
+                return std::async(std::launch::async, [this, cancels, setpoint, window, soakTime_ms, timeout_ms, rampRate]() {
+                    ActiveSoak active = {this};
+                    typedef std::chrono::steady_clock clock;
+                    const clock::time_point           deadline = clock::now() + std::chrono::milliseconds(timeout_ms);
+                    clock::time_point                 soakStart;
+                    bool                              soaking = false;
+                    clock::time_point                 lastTime;
+                    double                            lastTemperature = 0.0;
+                    bool                              havePrevious    = false;
+
+                    auto cancelled = [this, cancels]() { return m_soakCancels != cancels; };
+                    for (;;) {
+                        {
+                            std::lock_guard<std::mutex> lock(m_soakMutex);
+                            if (cancelled()) throw CommandException("Waiting for the soak at " + utils::to_string(setpoint) + " C was cancelled.");
+                        }
+                        double            temperature = getTemperature();
+                        clock::time_point now         = clock::now();
+                        double            outside     = std::fabs(temperature - setpoint) - window;
+
+                        long long interval_ms;
+                        if (outside <= 0.0) {
+                            if (!soaking) {
+                                soaking   = true;
+                                soakStart = now;
+                            }
+                            long long soaked_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - soakStart).count();
+                            if (soaked_ms >= static_cast<long long>(soakTime_ms)) {
+                                return temperature;
+                            }
+                            interval_ms = std::min<long long>(s_soakPollInterval_ms, soakTime_ms - soaked_ms);
+                        } else {
+                            soaking = false;
+                            // Predict the arrival from the faster of the configured and the observed rate.
+                            double rate = rampRate;
+                            if (havePrevious) {
+                                double elapsed_ms = std::chrono::duration<double, std::milli>(now - lastTime).count();
+                                if (elapsed_ms > 0.0) {
+                                    rate = std::max(rate, std::fabs(temperature - lastTemperature) / elapsed_ms);
+                                }
+                            }
+                            double arrival_ms = (rate > 0.0) ? outside / rate : static_cast<double>(s_maxRampPollInterval_ms);
+                            interval_ms       = static_cast<long long>(std::min(arrival_ms / 2.0, static_cast<double>(s_maxRampPollInterval_ms)));
+                            interval_ms       = std::max<long long>(interval_ms, s_soakPollInterval_ms);
+                        }
+                        lastTime        = now;
+                        lastTemperature = temperature;
+                        havePrevious    = true;
+
+                        if (now >= deadline) {
+                            throw TimeoutException("Temperature did not soak at " + utils::to_string(setpoint) + " C within " + utils::to_string(timeout_ms) +
+                                                   " ms (last reading " + utils::to_string(temperature) + " C).");
+                        }
+                        // Poll once more at the deadline so a soak completing just in time is not missed.
+                        std::unique_lock<std::mutex> lock(m_soakMutex);
+                        m_soakWakeup.wait_until(lock, std::min(now + std::chrono::milliseconds(interval_ms), deadline), cancelled);
+                    }
+                });
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_soakMutex);
+                --m_activeSoaks;
+                throw;
+            }
+        }
+
     }    // namespace drivers
 }    // namespace cvisa
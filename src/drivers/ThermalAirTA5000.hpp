@@ -4,6 +4,9 @@
 #include "../core/SCPIBase.hpp"
 #include "../core/SCPICommand.hpp"
 
+#include <condition_variable>
+#include <future>
+#include <mutex>
 #include <string>
 
 namespace cvisa {
@@ -42,6 +45,11 @@ namespace cvisa {
                 m_description = "MPI Thermal TA-5000";
             }
 
+            /**
+             * @brief Destructor. Cancels pending `waitForSoak()` calls and waits for them to end.
+             */
+            ~ThermalAirTA5000();
+
             // Public API
             /**
              * @brief Reads the main temperature.
@@ -358,79 +366,140 @@ namespace cvisa {
              */
             int getMaxTestTime();
 
+            // --- Soak Detection ---
+
+            /**
+             * @brief Waits in the background until the temperature has soaked at a setpoint.
+             *
+             * Polls the main temperature until it has stayed within `window` of
+             * `setpoint` for `soakTime_ms` without interruption; leaving the window
+             * restarts the soak. The setpoint itself is not written, so call
+             * `setSetpoint()` first.
+             *
+             * The poll interval adapts to the distance from the window: outside it,
+             * the next poll is scheduled halfway to the predicted arrival, using the
+             * faster of `getRampRate()` and the observed rate of change, so a long
+             * ramp costs a handful of queries. Inside the window the temperature is
+             * polled every 250 ms. Each poll takes the session lock for one query
+             * only, so other threads (or the returned future's owner) can keep
+             * using the driver, e.g. to set up power supplies during the ramp.
+             *
+             * The returned future's destructor waits for the wait to finish;
+             * `cancelSoak()` or destroying the driver ends it early.
+             *
+             * @param setpoint The target temperature in degrees Celsius.
+             * @param window The allowed deviation from `setpoint` in degrees Celsius.
+             * @param soakTime_ms How long the temperature must stay within the window.
+             * @param timeout_ms The maximum total wait, including the ramp.
+             * @return A future holding the last temperature read. It throws
+             * `TimeoutException` if the soak does not complete in time,
+             * `CommandException` if the wait is cancelled, or the exception of a
+             * failed query.
+             */
+            std::future<double> waitForSoak(double setpoint, double window, unsigned int soakTime_ms, unsigned int timeout_ms);
+
+            /**
+             * @brief Ends every pending `waitForSoak()` without waiting for it.
+             *
+             * A wait that is polling finishes its query first. Later calls of
+             * `waitForSoak()` are not affected.
+             */
+            void cancelSoak();
+
             struct Commands {
-                static SCPICommand getTemperature() { return SCPICommand("TEMP?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read main temperature."); }
-                static SCPICommand getAirTemperature() { return SCPICommand("TMPA?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read air temperature."); }
-                static SCPICommand getDutTemperature() { return SCPICommand("TMPD?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read DUT temperature."); }
-                static SCPICommand setSetpoint() { return SCPICommand("SETP %f", CommandType::WRITE, ResponseType::NONE, 0, "Set temperature setpoint."); }
-                static SCPICommand getSetpoint() { return SCPICommand("SETP?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read temperature setpoint."); }
-                static SCPICommand setSoakTime() { return SCPICommand("SOAK %d", CommandType::WRITE, ResponseType::NONE, 0, "Set soak time."); }
-                static SCPICommand getSoakTime() { return SCPICommand("SOAK?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read soak time."); }
-                static SCPICommand setTemperatureWindow() { return SCPICommand("WNDW %f", CommandType::WRITE, ResponseType::NONE, 0, "Set temperature window."); }
-                static SCPICommand getTemperatureWindow() { return SCPICommand("WNDW?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read temperature window."); }
-                static SCPICommand setHeadDown() { return SCPICommand("HEAD 1", CommandType::WRITE, ResponseType::NONE, 0, "Put thermal head down."); }
-                static SCPICommand setHeadUp() { return SCPICommand("HEAD 0", CommandType::WRITE, ResponseType::NONE, 0, "Put thermal head up."); }
-                static SCPICommand getHeadState() { return SCPICommand("HEAD?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read head state."); }
-                static SCPICommand setFlowOn() { return SCPICommand("FLOW 1", CommandType::WRITE, ResponseType::NONE, 0, "Turn air flow ON."); }
-                static SCPICommand setFlowOff() { return SCPICommand("FLOW 0", CommandType::WRITE, ResponseType::NONE, 0, "Turn air flow OFF."); }
-                static SCPICommand setFlowRate() { return SCPICommand("FLSE %d", CommandType::WRITE, ResponseType::NONE, 0, "Set air flow rate."); }
-                static SCPICommand getFlowRateSetting() { return SCPICommand("FLSE?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read air flow rate setting."); }
-                static SCPICommand getFlowRateMeasured() { return SCPICommand("FLWR?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read measured air flow rate."); }
-                static SCPICommand getFlowRateLitersPerMin() {
+                static constexpr SCPICommand getTemperature() { return SCPICommand("TEMP?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read main temperature."); }
+                static constexpr SCPICommand getAirTemperature() { return SCPICommand("TMPA?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read air temperature."); }
+                static constexpr SCPICommand getDutTemperature() { return SCPICommand("TMPD?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read DUT temperature."); }
+                static constexpr SCPICommand setSetpoint() { return SCPICommand("SETP %f", CommandType::WRITE, ResponseType::NONE, 0, "Set temperature setpoint."); }
+                static constexpr SCPICommand getSetpoint() { return SCPICommand("SETP?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read temperature setpoint."); }
+                static constexpr SCPICommand setSoakTime() { return SCPICommand("SOAK %d", CommandType::WRITE, ResponseType::NONE, 0, "Set soak time."); }
+                static constexpr SCPICommand getSoakTime() { return SCPICommand("SOAK?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read soak time."); }
+                static constexpr SCPICommand setTemperatureWindow() { return SCPICommand("WNDW %f", CommandType::WRITE, ResponseType::NONE, 0, "Set temperature window."); }
+                static constexpr SCPICommand getTemperatureWindow() { return SCPICommand("WNDW?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read temperature window."); }
+                static constexpr SCPICommand setHeadDown() { return SCPICommand("HEAD 1", CommandType::WRITE, ResponseType::NONE, 0, "Put thermal head down."); }
+                static constexpr SCPICommand setHeadUp() { return SCPICommand("HEAD 0", CommandType::WRITE, ResponseType::NONE, 0, "Put thermal head up."); }
+                static constexpr SCPICommand getHeadState() { return SCPICommand("HEAD?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read head state."); }
+                static constexpr SCPICommand setFlowOn() { return SCPICommand("FLOW 1", CommandType::WRITE, ResponseType::NONE, 0, "Turn air flow ON."); }
+                static constexpr SCPICommand setFlowOff() { return SCPICommand("FLOW 0", CommandType::WRITE, ResponseType::NONE, 0, "Turn air flow OFF."); }
+                static constexpr SCPICommand setFlowRate() {
+                    return SCPICommand("FLSE %d", CommandType::WRITE, ResponseType::NONE, 0, "Set air flow rate.").asCachedSetting();
+                }
+                static constexpr SCPICommand getFlowRateSetting() {
+                    return SCPICommand("FLSE?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read air flow rate setting.").asCachedSetting();
+                }
+                static constexpr SCPICommand getFlowRateMeasured() { return SCPICommand("FLWR?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read measured air flow rate."); }
+                static constexpr SCPICommand getFlowRateLitersPerMin() {
                     return SCPICommand("FLRL?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Read measured flow rate in l/min.");
                 }
-                static SCPICommand setDutControlModeOn() { return SCPICommand("DUTM 1", CommandType::WRITE, ResponseType::NONE, 0, "Turn DUT control mode ON."); }
-                static SCPICommand setDutControlModeOff() { return SCPICommand("DUTM 0", CommandType::WRITE, ResponseType::NONE, 0, "Turn AIR control mode ON."); }
-                static SCPICommand getDutControlMode() { return SCPICommand("DUTM?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read DUT mode state."); }
-                static SCPICommand setDutSensorType() { return SCPICommand("DSNS %d", CommandType::WRITE, ResponseType::NONE, 0, "Set DUT sensor type."); }
-                static SCPICommand getDutSensorType() { return SCPICommand("DSNS?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read DUT sensor type."); }
-                static SCPICommand setTrickleFlowOn() { return SCPICommand("TRKL 1", CommandType::WRITE, ResponseType::NONE, 0, "Turn trickle flow ON."); }
-                static SCPICommand setTrickleFlowOff() { return SCPICommand("TRKL 0", CommandType::WRITE, ResponseType::NONE, 0, "Turn trickle flow OFF."); }
-                static SCPICommand getTrickleFlowState() { return SCPICommand("TRKL?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read trickle flow setting."); }
-                static SCPICommand setLowerTemperatureLimit() {
-                    return SCPICommand("LLIM %f", CommandType::WRITE, ResponseType::NONE, 0, "Set lower air temperature limit.");
+                static constexpr SCPICommand setDutControlModeOn() { return SCPICommand("DUTM 1", CommandType::WRITE, ResponseType::NONE, 0, "Turn DUT control mode ON."); }
+                static constexpr SCPICommand setDutControlModeOff() { return SCPICommand("DUTM 0", CommandType::WRITE, ResponseType::NONE, 0, "Turn AIR control mode ON."); }
+                static constexpr SCPICommand getDutControlMode() { return SCPICommand("DUTM?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read DUT mode state."); }
+                static constexpr SCPICommand setDutSensorType() {
+                    return SCPICommand("DSNS %d", CommandType::WRITE, ResponseType::NONE, 0, "Set DUT sensor type.").asCachedSetting();
                 }
-                static SCPICommand getLowerTemperatureLimit() {
-                    return SCPICommand("LLIM?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get lower air temperature limit.");
+                static constexpr SCPICommand getDutSensorType() {
+                    return SCPICommand("DSNS?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read DUT sensor type.").asCachedSetting();
                 }
-                static SCPICommand setUpperTemperatureLimit() {
-                    return SCPICommand("ULIM %d", CommandType::WRITE, ResponseType::NONE, 0, "Set upper air temperature limit.");
+                static constexpr SCPICommand setTrickleFlowOn() { return SCPICommand("TRKL 1", CommandType::WRITE, ResponseType::NONE, 0, "Turn trickle flow ON."); }
+                static constexpr SCPICommand setTrickleFlowOff() { return SCPICommand("TRKL 0", CommandType::WRITE, ResponseType::NONE, 0, "Turn trickle flow OFF."); }
+                static constexpr SCPICommand getTrickleFlowState() { return SCPICommand("TRKL?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read trickle flow setting."); }
+                static constexpr SCPICommand setLowerTemperatureLimit() {
+                    return SCPICommand("LLIM %f", CommandType::WRITE, ResponseType::NONE, 0, "Set lower air temperature limit.").asCachedSetting();
                 }
-                static SCPICommand getUpperTemperatureLimit() {
-                    return SCPICommand("ULIM?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get upper air temperature limit.");
+                static constexpr SCPICommand getLowerTemperatureLimit() {
+                    return SCPICommand("LLIM?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get lower air temperature limit.").asCachedSetting();
                 }
-                static SCPICommand getErrorState() { return SCPICommand("EROR?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read system error state."); }
-                static SCPICommand setAirToDutMaxDifference() {
-                    return SCPICommand("ADMD %d", CommandType::WRITE, ResponseType::NONE, 0, "Set air-to-DUT max difference.");
+                static constexpr SCPICommand setUpperTemperatureLimit() {
+                    return SCPICommand("ULIM %d", CommandType::WRITE, ResponseType::NONE, 0, "Set upper air temperature limit.").asCachedSetting();
                 }
-                static SCPICommand getAirToDutMaxDifference() {
-                    return SCPICommand("ADMD?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get air-to-DUT max difference.");
+                static constexpr SCPICommand getUpperTemperatureLimit() {
+                    return SCPICommand("ULIM?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get upper air temperature limit.").asCachedSetting();
                 }
-                static SCPICommand getAuxiliaryCondition() { return SCPICommand("AUXC?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get auxiliary condition data."); }
-                static SCPICommand setCompressorOn() { return SCPICommand("COOL 1", CommandType::WRITE, ResponseType::NONE, 0, "Turn compressor on."); }
-                static SCPICommand setCompressorOff() { return SCPICommand("COOL 0", CommandType::WRITE, ResponseType::NONE, 0, "Turn compressor off."); }
-                static SCPICommand getCompressorState() { return SCPICommand("COOL?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get compressor state."); }
-                static SCPICommand setCycleCount() { return SCPICommand("CYCC %d", CommandType::WRITE, ResponseType::NONE, 0, "Set cycle count."); }
-                static SCPICommand getCycleCount() { return SCPICommand("CYCC?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get cycle count."); }
-                static SCPICommand startCycling() { return SCPICommand("CYCL 1", CommandType::WRITE, ResponseType::NONE, 0, "Start cycling."); }
-                static SCPICommand stopCycling() { return SCPICommand("CYCL 0", CommandType::WRITE, ResponseType::NONE, 0, "Stop cycling."); }
-                static SCPICommand getCyclingState() { return SCPICommand("CYCP?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get cycling state."); }
-                static SCPICommand setDutAutoTuneMode() { return SCPICommand("DUTN %d", CommandType::WRITE, ResponseType::NONE, 0, "Set DUT auto tune mode."); }
-                static SCPICommand getDutAutoTuneMode() { return SCPICommand("DUTN?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get DUT auto tune mode."); }
-                static SCPICommand lockHead() { return SCPICommand("HDLK 1", CommandType::WRITE, ResponseType::NONE, 0, "Lock test head."); }
-                static SCPICommand unlockHead() { return SCPICommand("HDLK 0", CommandType::WRITE, ResponseType::NONE, 0, "Unlock test head."); }
-                static SCPICommand nextSetpoint() { return SCPICommand("NEXT", CommandType::WRITE, ResponseType::NONE, 0, "Step to next setpoint."); }
-                static SCPICommand setRampRate() { return SCPICommand("RAMP %f", CommandType::WRITE, ResponseType::NONE, 0, "Set ramp rate."); }
-                static SCPICommand getRampRate() { return SCPICommand("RAMP?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get ramp rate."); }
-                static SCPICommand getDynamicSetpoint() { return SCPICommand("SETD?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get dynamic setpoint."); }
-                static SCPICommand selectSetpoint() { return SCPICommand("SETN %d", CommandType::WRITE, ResponseType::NONE, 0, "Select setpoint."); }
-                static SCPICommand getSelectedSetpoint() { return SCPICommand("SETN?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get selected setpoint."); }
-                static SCPICommand getTemperatureEventCondition() {
+                static constexpr SCPICommand getErrorState() { return SCPICommand("EROR?", CommandType::QUERY, ResponseType::INTEGER, 0, "Read system error state."); }
+                static constexpr SCPICommand setAirToDutMaxDifference() {
+                    return SCPICommand("ADMD %d", CommandType::WRITE, ResponseType::NONE, 0, "Set air-to-DUT max difference.").asCachedSetting();
+                }
+                static constexpr SCPICommand getAirToDutMaxDifference() {
+                    return SCPICommand("ADMD?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get air-to-DUT max difference.").asCachedSetting();
+                }
+                static constexpr SCPICommand getAuxiliaryCondition() { return SCPICommand("AUXC?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get auxiliary condition data."); }
+                static constexpr SCPICommand setCompressorOn() { return SCPICommand("COOL 1", CommandType::WRITE, ResponseType::NONE, 0, "Turn compressor on."); }
+                static constexpr SCPICommand setCompressorOff() { return SCPICommand("COOL 0", CommandType::WRITE, ResponseType::NONE, 0, "Turn compressor off."); }
+                static constexpr SCPICommand getCompressorState() { return SCPICommand("COOL?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get compressor state."); }
+                static constexpr SCPICommand setCycleCount() { return SCPICommand("CYCC %d", CommandType::WRITE, ResponseType::NONE, 0, "Set cycle count."); }
+                static constexpr SCPICommand getCycleCount() { return SCPICommand("CYCC?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get cycle count."); }
+                static constexpr SCPICommand startCycling() { return SCPICommand("CYCL 1", CommandType::WRITE, ResponseType::NONE, 0, "Start cycling."); }
+                static constexpr SCPICommand stopCycling() { return SCPICommand("CYCL 0", CommandType::WRITE, ResponseType::NONE, 0, "Stop cycling."); }
+                static constexpr SCPICommand getCyclingState() { return SCPICommand("CYCP?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get cycling state."); }
+                static constexpr SCPICommand setDutAutoTuneMode() { return SCPICommand("DUTN %d", CommandType::WRITE, ResponseType::NONE, 0, "Set DUT auto tune mode."); }
+                static constexpr SCPICommand getDutAutoTuneMode() { return SCPICommand("DUTN?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get DUT auto tune mode."); }
+                static constexpr SCPICommand lockHead() { return SCPICommand("HDLK 1", CommandType::WRITE, ResponseType::NONE, 0, "Lock test head."); }
+                static constexpr SCPICommand unlockHead() { return SCPICommand("HDLK 0", CommandType::WRITE, ResponseType::NONE, 0, "Unlock test head."); }
+                static constexpr SCPICommand nextSetpoint() { return SCPICommand("NEXT", CommandType::WRITE, ResponseType::NONE, 0, "Step to next setpoint."); }
+                static constexpr SCPICommand setRampRate() { return SCPICommand("RAMP %f", CommandType::WRITE, ResponseType::NONE, 0, "Set ramp rate."); }
+                static constexpr SCPICommand getRampRate() { return SCPICommand("RAMP?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get ramp rate."); }
+                static constexpr SCPICommand getDynamicSetpoint() { return SCPICommand("SETD?", CommandType::QUERY, ResponseType::DOUBLE, 0, "Get dynamic setpoint."); }
+                static constexpr SCPICommand selectSetpoint() { return SCPICommand("SETN %d", CommandType::WRITE, ResponseType::NONE, 0, "Select setpoint."); }
+                static constexpr SCPICommand getSelectedSetpoint() { return SCPICommand("SETN?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get selected setpoint."); }
+                static constexpr SCPICommand getTemperatureEventCondition() {
                     return SCPICommand("TECR?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get temperature event condition.");
                 }
-                static SCPICommand setMaxTestTime() { return SCPICommand("TTIM %d", CommandType::WRITE, ResponseType::NONE, 0, "Set max test time."); }
-                static SCPICommand getMaxTestTime() { return SCPICommand("TTIM?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get max test time."); }
+                static constexpr SCPICommand setMaxTestTime() {
+                    return SCPICommand("TTIM %d", CommandType::WRITE, ResponseType::NONE, 0, "Set max test time.").asCachedSetting();
+                }
+                static constexpr SCPICommand getMaxTestTime() {
+                    return SCPICommand("TTIM?", CommandType::QUERY, ResponseType::INTEGER, 0, "Get max test time.").asCachedSetting();
+                }
+
+                // --- Introspection ---
+                static SCPICommandTable table();
             };
+
+          private:
+            std::mutex              m_soakMutex;
+            std::condition_variable m_soakWakeup;         // Signalled by `cancelSoak()` and when a wait ends.
+            unsigned int            m_soakCancels = 0;    // Incremented by `cancelSoak()`; pending waits end when it changes.
+            unsigned int            m_activeSoaks = 0;    // Waits whose task has not returned yet.
         };
 
     }    // namespace drivers
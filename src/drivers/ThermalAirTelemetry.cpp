@@ -0,0 +1,239 @@
+#include "ThermalAirTelemetry.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace cvisa {
+    namespace drivers {
+
+        void ThermalAirSeries::clear() {
+            time.clear();
+            temperature.clear();
+            airTemperature.clear();
+            dutTemperature.clear();
+            flowRate.clear();
+            eventCondition.clear();
+        }
+
+        ThermalAirTelemetry::ThermalAirTelemetry(ThermalAirTA5000& chamber, size_t capacity)
+            : m_chamber(chamber),
+              m_capacity(std::max<size_t>(capacity, 1)),
+              m_time(m_capacity),
+              m_temperature(m_capacity),
+              m_airTemperature(m_capacity),
+              m_dutTemperature(m_capacity),
+              m_flowRate(m_capacity),
+              m_eventCondition(m_capacity),
+              m_head(0),
+              m_count(0),
+              m_sampleCount(0),
+              m_errorCount(0),
+              m_nextSubscriberId(1),
+              m_stopping(false) {
+            m_batch.add(ThermalAirTA5000::Commands::getTemperature())
+                .add(ThermalAirTA5000::Commands::getAirTemperature())
+                .add(ThermalAirTA5000::Commands::getDutTemperature())
+                .add(ThermalAirTA5000::Commands::getFlowRateMeasured())
+                .add(ThermalAirTA5000::Commands::getTemperatureEventCondition());
+        }
+
+        ThermalAirTelemetry::~ThermalAirTelemetry() { stop(); }
+
+        // --- Sampling ---
+
+        void ThermalAirTelemetry::start(unsigned int period_ms) {
+            std::lock_guard<std::mutex> lock(m_threadMutex);
+            if (m_thread.joinable()) {
+                throw std::logic_error("ThermalAirTelemetry is already running.");
+            }
+            m_stopping = false;
+            m_thread   = std::thread(&ThermalAirTelemetry::run, this, std::max(period_ms, 1u));
+        }
+
+        void ThermalAirTelemetry::stop() {
+            std::thread thread;
+            {
+                std::lock_guard<std::mutex> lock(m_threadMutex);
+                m_stopping = true;
+                thread     = std::move(m_thread);
+            }
+            m_wakeup.notify_all();
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+
+        bool ThermalAirTelemetry::isRunning() const {
+            std::lock_guard<std::mutex> lock(m_threadMutex);
+            return m_thread.joinable() && !m_stopping;
+        }
+
+        ThermalAirSample ThermalAirTelemetry::sampleOnce() {
+            ThermalAirSample sample;
+            {
+                std::lock_guard<std::mutex> lock(m_queryMutex);
+                m_chamber.executeBatch(m_batch);
+                sample.time           = std::chrono::steady_clock::now();
+                sample.temperature    = m_batch.get<double>(0);
+                sample.airTemperature = m_batch.get<double>(1);
+                sample.dutTemperature = m_batch.get<double>(2);
+                sample.flowRate       = m_batch.get<int>(3);
+                sample.eventCondition = m_batch.get<int>(4);
+            }
+            store(sample);
+
+            std::lock_guard<std::mutex> lock(m_subscriberMutex);
+            for (const auto& subscription : m_subscribers) {
+                // A failing subscriber, e.g. a full capture file, must not stop the others or the sampler.
+                try {
+                    subscription.callback(sample);
+                } catch (const std::exception& e) {
+                    recordError(e.what());
+                } catch (...) {
+                    recordError("Unknown exception in telemetry subscriber");
+                }
+            }
+            return sample;
+        }
+
+        void ThermalAirTelemetry::run(unsigned int period_ms) {
+            const std::chrono::milliseconds       period(period_ms);
+            std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+            for (;;) {
+                try {
+                    sampleOnce();
+                } catch (const std::exception& e) {
+                    recordError(e.what());
+                } catch (...) {
+                    recordError("Unknown exception while sampling");
+                }
+
+                // Keep a fixed rate, but skip ticks that have already passed.
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                next += period;
+                if (next <= now) {
+                    next += period * ((now - next) / period + 1);
+                }
+                std::unique_lock<std::mutex> lock(m_threadMutex);
+                if (m_wakeup.wait_until(lock, next, [this]() { return m_stopping; })) {
+                    return;
+                }
+            }
+        }
+
+        void ThermalAirTelemetry::recordError(const char* message) {
+            std::lock_guard<std::mutex> lock(m_dataMutex);
+            ++m_errorCount;
+            m_lastError = message;
+        }
+
+        // --- Ring Buffer ---
+
+        void ThermalAirTelemetry::store(const ThermalAirSample& sample) {
+            std::lock_guard<std::mutex> lock(m_dataMutex);
+            m_time[m_head]           = sample.time;
+            m_temperature[m_head]    = sample.temperature;
+            m_airTemperature[m_head] = sample.airTemperature;
+            m_dutTemperature[m_head] = sample.dutTemperature;
+            m_flowRate[m_head]       = sample.flowRate;
+            m_eventCondition[m_head] = sample.eventCondition;
+            m_head                   = (m_head + 1) % m_capacity;
+            m_count                  = std::min(m_count + 1, m_capacity);
+            ++m_sampleCount;
+        }
+
+        size_t ThermalAirTelemetry::snapshot(ThermalAirSeries& series, size_t maxSamples) const {
+            series.clear();
+            std::lock_guard<std::mutex> lock(m_dataMutex);
+            size_t                      count = std::min(m_count, maxSamples);
+            size_t                      first = (m_head + m_capacity - count) % m_capacity;
+            // The samples are [first, first + count) modulo the capacity: at most two contiguous runs.
+            size_t firstRun = std::min(count, m_capacity - first);
+            auto   copy     = [&](size_t begin, size_t length) {
+                series.time.insert(series.time.end(), m_time.begin() + begin, m_time.begin() + begin + length);
+                series.temperature.insert(series.temperature.end(), m_temperature.begin() + begin, m_temperature.begin() + begin + length);
+                series.airTemperature.insert(series.airTemperature.end(), m_airTemperature.begin() + begin, m_airTemperature.begin() + begin + length);
+                series.dutTemperature.insert(series.dutTemperature.end(), m_dutTemperature.begin() + begin, m_dutTemperature.begin() + begin + length);
+                series.flowRate.insert(series.flowRate.end(), m_flowRate.begin() + begin, m_flowRate.begin() + begin + length);
+                series.eventCondition.insert(series.eventCondition.end(), m_eventCondition.begin() + begin, m_eventCondition.begin() + begin + length);
+            };
+            copy(first, firstRun);
+            copy(0, count - firstRun);
+            return count;
+        }
+
+        bool ThermalAirTelemetry::latest(ThermalAirSample& sample) const {
+            std::lock_guard<std::mutex> lock(m_dataMutex);
+            if (m_count == 0) {
+                return false;
+            }
+            size_t last           = (m_head + m_capacity - 1) % m_capacity;
+            sample.time           = m_time[last];
+            sample.temperature    = m_temperature[last];
+            sample.airTemperature = m_airTemperature[last];
+            sample.dutTemperature = m_dutTemperature[last];
+            sample.flowRate       = m_flowRate[last];
+            sample.eventCondition = m_eventCondition[last];
+            return true;
+        }
+
+        void ThermalAirTelemetry::clear() {
+            std::lock_guard<std::mutex> lock(m_dataMutex);
+            m_head  = 0;
+            m_count = 0;
+        }
+
+        uint64_t ThermalAirTelemetry::sampleCount() const {
+            std::lock_guard<std::mutex> lock(m_dataMutex);
+            return m_sampleCount;
+        }
+
+        uint64_t ThermalAirTelemetry::errorCount() const {
+            std::lock_guard<std::mutex> lock(m_dataMutex);
+            return m_errorCount;
+        }
+
+        std::string ThermalAirTelemetry::lastError() const {
+            std::lock_guard<std::mutex> lock(m_dataMutex);
+            return m_lastError;
+        }
+
+        // --- Subscribers ---
+
+        size_t ThermalAirTelemetry::subscribe(Subscriber subscriber) {
+            std::lock_guard<std::mutex> lock(m_subscriberMutex);
+            Subscription                subscription = {m_nextSubscriberId++, std::move(subscriber)};
+            m_subscribers.push_back(std::move(subscription));
+            return m_subscribers.back().id;
+        }
+
+        void ThermalAirTelemetry::unsubscribe(size_t id) {
+            std::lock_guard<std::mutex> lock(m_subscriberMutex);
+            m_subscribers.erase(std::remove_if(m_subscribers.begin(), m_subscribers.end(), [id](const Subscription& subscription) { return subscription.id == id; }),
+                                m_subscribers.end());
+        }
+
+        size_t ThermalAirTelemetry::recordTo(CaptureWriter& writer) {
+            if (writer.channelCount() != 5) {
+                throw std::invalid_argument("ThermalAirTelemetry: the capture file needs the five channels of captureChannels().");
+            }
+            return subscribe([&writer](const ThermalAirSample& sample) {
+                const double values[5] = {sample.temperature, sample.airTemperature, sample.dutTemperature, static_cast<double>(sample.flowRate),
+                                          static_cast<double>(sample.eventCondition)};
+                writer.append(sample.time, values);
+            });
+        }
+
+        std::vector<CaptureChannel> ThermalAirTelemetry::captureChannels() {
+            std::vector<CaptureChannel> channels;
+            channels.push_back({"temperature", ThermalAirTA5000::Commands::getTemperature().command});
+            channels.push_back({"airTemperature", ThermalAirTA5000::Commands::getAirTemperature().command});
+            channels.push_back({"dutTemperature", ThermalAirTA5000::Commands::getDutTemperature().command});
+            channels.push_back({"flowRate", ThermalAirTA5000::Commands::getFlowRateMeasured().command});
+            channels.push_back({"eventCondition", ThermalAirTA5000::Commands::getTemperatureEventCondition().command});
+            return channels;
+        }
+
+    }    // namespace drivers
+}    // namespace cvisa
@@ -0,0 +1,249 @@
+#ifndef CVISA_DRIVER_THERMAL_AIR_TELEMETRY_HPP
+#define CVISA_DRIVER_THERMAL_AIR_TELEMETRY_HPP
+
+#include "ThermalAirTA5000.hpp"
+
+#include "../core/CaptureFile.hpp"
+#include "../core/SCPIBatch.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cvisa {
+    namespace drivers {
+
+        /**
+         * @struct ThermalAirSample
+         * @brief One telemetry reading of a TA-5000.
+         */
+        struct ThermalAirSample {
+            std::chrono::steady_clock::time_point time;              // When the response was received.
+            double                                temperature;       // Main temperature (TEMP?), in degrees Celsius.
+            double                                airTemperature;    // Air temperature (TMPA?), in degrees Celsius.
+            double                                dutTemperature;    // DUT temperature (TMPD?), in degrees Celsius.
+            int                                   flowRate;          // Measured main nozzle flow (FLWR?), in scfm.
+            int                                   eventCondition;    // Temperature event condition register (TECR?).
+        };
+
+        /**
+         * @struct ThermalAirSeries
+         * @brief A time series of telemetry readings, one vector per channel.
+         *
+         * Every vector has `size()` elements, oldest first, so a channel can be
+         * handed to plotting or statistics code without gathering it from samples.
+         */
+        struct ThermalAirSeries {
+            std::vector<std::chrono::steady_clock::time_point> time;
+            std::vector<double>                                temperature;
+            std::vector<double>                                airTemperature;
+            std::vector<double>                                dutTemperature;
+            std::vector<int>                                   flowRate;
+            std::vector<int>                                   eventCondition;
+
+            /// @return The number of samples.
+            size_t size() const { return time.size(); }
+
+            /**
+             * @brief Removes all samples, keeping the allocated buffers.
+             */
+            void clear();
+        };
+
+        /**
+         * @class ThermalAirTelemetry
+         * @brief Samples a TA-5000 in the background into a fixed-capacity ring buffer.
+         *
+         * Every tick reads the main, air and DUT temperatures, the measured flow
+         * rate and the temperature event condition register with a single
+         * compound query (`SCPIBase::executeBatch()`), instead of five separate
+         * round trips. Samples are timestamped and stored column by column in a
+         * ring that overwrites the oldest sample when it is full.
+         *
+         * Consumers read `snapshot()` or `latest()`, or `subscribe()` to every new
+         * sample; none of them touches the bus, so any number of consumers cost
+         * one query per tick. The sampler shares the driver's session lock, so
+         * the driver stays usable from other threads while it runs.
+         *
+         * @code
+         * ThermalAirTA5000    chamber("GPIB0::12::INSTR");
+         * ThermalAirTelemetry telemetry(chamber, 36000);
+         * telemetry.start(100);    // 10 samples per second, one hour of history.
+         * // ...
+         * ThermalAirSeries series;
+         * telemetry.snapshot(series);
+         * @endcode
+         *
+         * The sampler must be destroyed (or stopped) before its driver.
+         */
+        class ThermalAirTelemetry {
+          public:
+            typedef std::function<void(const ThermalAirSample& sample)> Subscriber;
+
+            /**
+             * @brief Creates a stopped sampler for a connected driver.
+             * @param chamber The driver to sample. Must outlive the sampler.
+             * @param capacity The number of samples kept (at least 1).
+             */
+            explicit ThermalAirTelemetry(ThermalAirTA5000& chamber, size_t capacity = 4096);
+
+            /**
+             * @brief Destructor. Stops the sampler thread.
+             */
+            ~ThermalAirTelemetry();
+
+            ThermalAirTelemetry(const ThermalAirTelemetry&)            = delete;
+            ThermalAirTelemetry& operator=(const ThermalAirTelemetry&) = delete;
+
+            /**
+             * @brief Starts sampling every `period_ms` on a background thread.
+             *
+             * Ticks are scheduled at a fixed rate; a tick that is missed because
+             * a query took longer than the period is skipped, not queued. Query and
+             * subscriber errors are counted (`errorCount()`) and sampling continues.
+             *
+             * @param period_ms The sampling period in milliseconds (at least 1).
+             */
+            void start(unsigned int period_ms);
+
+            /**
+             * @brief Stops sampling and joins the sampler thread. Samples are kept.
+             */
+            void stop();
+
+            /**
+             * @brief Returns true while the sampler thread runs.
+             */
+            bool isRunning() const;
+
+            /**
+             * @brief Takes one sample on the calling thread.
+             *
+             * Useful for sampling on an external trigger. Subscribers are notified
+             * as for background samples; exceptions thrown by subscribers are
+             * counted in `errorCount()` instead of propagating.
+             *
+             * @return The new sample.
+             * @throws VisaException if the query fails.
+             */
+            ThermalAirSample sampleOnce();
+
+            /**
+             * @brief Copies the buffered samples into `series`, oldest first.
+             *
+             * `series` keeps its capacity, so polling into the same object does
+             * not allocate.
+             *
+             * @param series Receives the samples.
+             * @param maxSamples The number of most recent samples to copy.
+             * @return The number of samples copied.
+             */
+            size_t snapshot(ThermalAirSeries& series, size_t maxSamples = static_cast<size_t>(-1)) const;
+
+            /**
+             * @brief Returns the most recent sample.
+             * @param sample Receives the sample.
+             * @return False if no sample has been taken yet.
+             */
+            bool latest(ThermalAirSample& sample) const;
+
+            /**
+             * @brief Calls `subscriber` with every new sample, on the sampling thread.
+             *
+             * Subscribers run after the sample is stored and must not call
+             * `subscribe()`, `unsubscribe()` or `stop()`.
+             *
+             * @return An id for `unsubscribe()`.
+             */
+            size_t subscribe(Subscriber subscriber);
+
+            /**
+             * @brief Removes a subscriber.
+             */
+            void unsubscribe(size_t id);
+
+            /**
+             * @brief Appends every new sample to a capture file.
+             *
+             * Subscribes a callback that writes the sample into the memory-mapped
+             * file on the sampling thread, which costs a copy and never waits for
+             * the disk. Create `writer` with `captureChannels()`.
+             *
+             * @param writer The capture to append to. Must stay open until unsubscribed.
+             * @return The subscription id for `unsubscribe()`.
+             * @throws std::invalid_argument if `writer` does not have five channels.
+             */
+            size_t recordTo(CaptureWriter& writer);
+
+            /**
+             * @brief Returns the channels of a capture written by `recordTo()`.
+             */
+            static std::vector<CaptureChannel> captureChannels();
+
+            /**
+             * @brief Discards all buffered samples.
+             */
+            void clear();
+
+            /// @return The number of samples the ring holds.
+            size_t capacity() const { return m_capacity; }
+
+            /// @return The number of samples taken since construction.
+            uint64_t sampleCount() const;
+
+            /// @return The number of ticks whose query failed, plus the number of subscriber calls that threw.
+            uint64_t errorCount() const;
+
+            /// @return The message of the last failed query or subscriber, or an empty string.
+            std::string lastError() const;
+
+          private:
+            struct Subscription {
+                size_t     id;
+                Subscriber callback;
+            };
+
+            void run(unsigned int period_ms);
+            void store(const ThermalAirSample& sample);
+            void recordError(const char* message);
+
+            ThermalAirTA5000& m_chamber;
+            SCPIBatch         m_batch;    // The compound telemetry query; only used with `m_queryMutex` held.
+            std::mutex        m_queryMutex;
+
+            // Ring buffer, one column per channel. The oldest sample is at `m_head` once full.
+            mutable std::mutex                                 m_dataMutex;
+            const size_t                                       m_capacity;
+            std::vector<std::chrono::steady_clock::time_point> m_time;
+            std::vector<double>                                m_temperature;
+            std::vector<double>                                m_airTemperature;
+            std::vector<double>                                m_dutTemperature;
+            std::vector<int>                                   m_flowRate;
+            std::vector<int>                                   m_eventCondition;
+            size_t                                             m_head;     // Next slot to write.
+            size_t                                             m_count;    // Buffered samples.
+            uint64_t                                           m_sampleCount;
+            uint64_t                                           m_errorCount;
+            std::string                                        m_lastError;
+
+            std::mutex                m_subscriberMutex;
+            std::vector<Subscription> m_subscribers;
+            size_t                    m_nextSubscriberId;
+
+            // Sampler thread
+            mutable std::mutex      m_threadMutex;
+            std::condition_variable m_wakeup;
+            std::thread             m_thread;
+            bool                    m_stopping;
+        };
+
+    }    // namespace drivers
+}    // namespace cvisa
+
+#endif    // CVISA_DRIVER_THERMAL_AIR_TELEMETRY_HPP
@@ -1,6 +1,9 @@
 #ifndef CVISA_UTILS_HPP
 #define CVISA_UTILS_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <sstream>
 #include <string>
 
@@ -14,6 +17,34 @@ namespace cvisa {
             return os.str();
         }
 
+        // Locale-independent ASCII character classes for instrument messages.
+        inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+        inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; }
+
+        inline char toUpper(char c) { return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c; }
+
+        /**
+         * @brief Returns true if the host stores multi-byte values least significant byte first.
+         */
+        inline bool isLittleEndianHost() {
+            const uint16_t probe = 1;
+            return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+        }
+
+        /**
+         * @brief Reverses the byte order of every element of an array in place.
+         * @param data The elements to convert.
+         * @param count The number of elements.
+         */
+        template <typename T>
+        void swapByteOrder(T* data, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                unsigned char* bytes = reinterpret_cast<unsigned char*>(&data[i]);
+                std::reverse(bytes, bytes + sizeof(T));
+            }
+        }
+
     }    // namespace utils
 }    // namespace cvisa
 